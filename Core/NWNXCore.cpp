@@ -514,6 +514,7 @@ void NWNXCore::Shutdown()
 {
     UnloadPlugins();
     UnloadServices();
+    Log::StopAsyncWriter();
     g_core = nullptr;
 }
 
@@ -533,8 +534,12 @@ void NWNXCore::CreateServerHandler(CAppManager* app)
     Log::SetPrintSource(g_core->m_coreServices->m_config->Get<bool>("LOG_SOURCE", true));
     Log::SetColorOutput(g_core->m_coreServices->m_config->Get<bool>("LOG_COLOR", true));
     Log::SetForceColor(g_core->m_coreServices->m_config->Get<bool>("LOG_FORCE_COLOR", false));
+    Log::SetJsonOutput(g_core->m_coreServices->m_config->Get<bool>("LOG_JSON", false));
     if (g_core->m_coreServices->m_config->Get<bool>("LOG_ASYNC", false))
-        Log::SetAsync(g_core->m_services->m_tasks.get());
+    {
+        Log::StartAsyncWriter(g_core->m_coreServices->m_config->Get<size_t>("LOG_ASYNC_BUFFER_SIZE", 8192),
+                              g_core->m_coreServices->m_config->Get<bool>("LOG_ASYNC_BLOCK_WHEN_FULL", true));
+    }
 
     if (auto locale = g_core->m_coreServices->m_config->Get<std::string>("LOCALE"))
     {
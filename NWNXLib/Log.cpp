@@ -4,11 +4,19 @@
 #include "API/Globals.hpp"
 #include "API/CExoBase.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "External/rang/rang.hpp"
-#include "Services/Tasks/Tasks.hpp"
 
 namespace NWNXLib::Log {
 
@@ -18,7 +26,7 @@ static bool s_PrintPlugin;
 static bool s_PrintSource;
 static bool s_ColorOutput;
 static bool s_ForceColor;
-static NWNXLib::Services::Tasks* s_Tasks;
+static bool s_JsonOutput;
 void SetPrintTimestamp(bool value)
 {
     s_PrintTimestamp = value;
@@ -69,20 +77,229 @@ bool GetForceColor()
 {
     return s_ForceColor;
 }
-void SetAsync(NWNXLib::Services::Tasks* tasks)
+void SetJsonOutput(bool value)
 {
-    s_Tasks = tasks;
+    s_JsonOutput = value;
 }
+bool GetJsonOutput()
+{
+    return s_JsonOutput;
+}
+
+namespace {
 
-void InternalTrace(Channel::Enum channel, Channel::Enum allowedChannel, const char* message)
+struct Entry
 {
-    if (channel > allowedChannel)
+    uint64_t m_sequence;
+    Channel::Enum m_channel;
+    std::time_t m_time;
+    int m_line;
+    // Copied rather than pointed to, as the strings live in the plugin that logged them.
+    char m_plugin[32];
+    char m_file[64];
+    std::string m_message;
+};
+
+// Single producer (the owning thread), single consumer (the writer thread) ring of log entries.
+// Starts small and doubles up to its maximum size when it fills up, so threads that rarely log stay cheap.
+class ThreadBuffer
+{
+public:
+    ThreadBuffer(size_t size, size_t maxSize)
+        : m_slots(size), m_mask(size - 1), m_maxSize(maxSize)
     {
-        // No need to do anything. Our log level is lower.
-        return;
     }
 
-    switch (channel)
+    bool TryPush(Entry&& entry)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+            return false;
+
+        m_slots[tail & m_mask] = std::move(entry);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Size() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    size_t Capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    void Drain(std::vector<Entry>& out)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+
+        for (; head != tail; ++head)
+        {
+            out.push_back(std::move(m_slots[head & m_mask]));
+        }
+
+        m_head.store(head, std::memory_order_release);
+    }
+
+    // Called by the producer while the consumer is locked out.
+    bool Grow()
+    {
+        if (m_slots.size() >= m_maxSize)
+            return false;
+
+        std::vector<Entry> slots(m_slots.size() * 2);
+        size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        size_t count = 0;
+        for (; head != tail; ++head)
+        {
+            slots[count++] = std::move(m_slots[head & m_mask]);
+        }
+
+        m_slots.swap(slots);
+        m_mask = m_slots.size() - 1;
+        m_head.store(0, std::memory_order_release);
+        m_tail.store(count, std::memory_order_release);
+        return true;
+    }
+
+    std::atomic<bool> m_orphaned{false};
+
+private:
+    std::vector<Entry> m_slots;
+    size_t m_mask;
+    const size_t m_maxSize;
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+// Marks the buffer as orphaned when its thread exits, so the writer can release it once drained.
+struct ThreadBufferHandle
+{
+    std::shared_ptr<ThreadBuffer> m_buffer;
+    ~ThreadBufferHandle() { if (m_buffer) m_buffer->m_orphaned = true; }
+};
+
+}
+
+// Entries of one thread are always written in the order they were logged. Entries of different threads
+// are only sorted by when they were logged within one flush of the buffers, so an entry logged just before
+// a flush on one thread can be written after one logged just after it on another, in the next flush.
+static std::atomic<bool> s_AsyncRunning{false};
+static bool s_BlockWhenFull;
+static size_t s_BufferSize;
+static std::atomic<uint64_t> s_Sequence{0};
+static std::atomic<uint64_t> s_Dropped{0};
+
+static std::mutex s_BuffersLock;
+static std::vector<std::shared_ptr<ThreadBuffer>> s_Buffers;
+
+static std::thread s_WriterThread;
+static std::mutex s_WriterLock;
+static std::condition_variable s_WriterSignal;
+static bool s_WriterWake;
+static bool s_WriterStop;
+
+static constexpr std::chrono::milliseconds WRITER_INTERVAL(10);
+static constexpr size_t INITIAL_BUFFER_SIZE = 64;
+
+static FILE* GetLogFile()
+{
+    static std::string logPath = API::Globals::ExoBase()->m_sUserDirectory.CStr() + std::string("/logs.0/nwnx.txt");
+    static FILE* logFile = std::fopen(logPath.c_str(), "a+");
+    return logFile;
+}
+
+static void AppendText(std::string& out, const Entry& entry)
+{
+    static constexpr const char * SEVERITY_NAMES[] = { "", "", "F", "E", "W", "N", "I", "D" };
+
+    char buffer[128];
+    out += SEVERITY_NAMES[static_cast<size_t>(entry.m_channel)];
+    out += ' ';
+
+    if (GetPrintTimestamp())
+    {
+        std::tm timeinfo;
+        localtime_r(&entry.m_time, &timeinfo);
+
+        if (GetPrintDate())
+            std::snprintf(buffer, sizeof(buffer), "[%04d-%02d-%02d %02d:%02d:%02d] ", 1900 + timeinfo.tm_year,  1 + timeinfo.tm_mon,
+                    timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+        else
+            std::snprintf(buffer, sizeof(buffer), "[%02d:%02d:%02d] ", timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+        out += buffer;
+    }
+    if (GetPrintPlugin())
+    {
+        std::snprintf(buffer, sizeof(buffer), "[%s] ", entry.m_plugin);
+        out += buffer;
+    }
+    if (GetPrintSource())
+    {
+        std::snprintf(buffer, sizeof(buffer), "[%s:%d] ", entry.m_file, entry.m_line);
+        out += buffer;
+    }
+    out += entry.m_message;
+}
+
+static void AppendJsonString(std::string& out, const char* str)
+{
+    out += '"';
+    for (; *str; ++str)
+    {
+        const char c = *str;
+        switch (c)
+        {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                }
+                else
+                {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+static void AppendJson(std::string& out, const Entry& entry)
+{
+    std::tm timeinfo;
+    localtime_r(&entry.m_time, &timeinfo);
+
+    char buffer[64];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &timeinfo);
+
+    out += "{\"time\":\"";
+    out += buffer;
+    std::snprintf(buffer, sizeof(buffer), "\",\"severity\":%d,\"plugin\":", static_cast<int>(entry.m_channel));
+    out += buffer;
+    AppendJsonString(out, entry.m_plugin);
+    out += ",\"file\":";
+    AppendJsonString(out, entry.m_file);
+    std::snprintf(buffer, sizeof(buffer), ",\"line\":%d,\"message\":", entry.m_line);
+    out += buffer;
+    AppendJsonString(out, entry.m_message.c_str());
+    out += '}';
+}
+
+static void WriteToConsole(const Entry& entry, const std::string& text)
+{
+    switch (entry.m_channel)
     {
         case Channel::SEV_DEBUG:   std::cout << rang::fg::cyan << rang::style::dim;  break;
         case Channel::SEV_INFO:    std::cout << rang::fg::gray;                      break;
@@ -91,23 +308,260 @@ void InternalTrace(Channel::Enum channel, Channel::Enum allowedChannel, const ch
         case Channel::SEV_ERROR:   std::cout << rang::fg::red << rang::style::dim;   break;
         case Channel::SEV_FATAL:   std::cout << rang::fg::red << rang::style::bold;  break;
     }
-    std::cout << message << rang::style::reset << rang::fg::reset  << std::endl;
+    std::cout << text << rang::style::reset << rang::fg::reset << '\n';
+}
 
-    // Also write to a file - this could be done in a much nicer way but I just want to retain the old functionality
-    // for now. We can change this later if we want or need to.
+static void WriteEntries(const std::vector<Entry>& entries)
+{
+    FILE* logFile = GetLogFile();
+    std::string text;
+    std::string file;
 
-    static std::string logPath = API::Globals::ExoBase()->m_sUserDirectory.CStr() + std::string("/logs.0/nwnx.txt");
-    static FILE* logFile = std::fopen(logPath.c_str(), "a+");
+    for (auto& entry : entries)
+    {
+        text.clear();
+        AppendText(text, entry);
+        WriteToConsole(entry, text);
+
+        if (logFile)
+        {
+            if (GetJsonOutput())
+                AppendJson(file, entry);
+            else
+                file += text;
+            file += '\n';
+        }
+    }
+
+    std::cout.flush();
+
+    if (logFile && !file.empty())
+    {
+        std::fwrite(file.data(), 1, file.size(), logFile);
+        std::fflush(logFile);
+    }
+}
+
+static Entry MakeEntry(Channel::Enum channel, const char* plugin, const char* file, int line, std::string&& message)
+{
+    Entry entry;
+    entry.m_sequence = s_Sequence.fetch_add(1, std::memory_order_relaxed);
+    entry.m_channel = channel;
+    entry.m_time = std::time(nullptr);
+    entry.m_line = line;
+    std::snprintf(entry.m_plugin, sizeof(entry.m_plugin), "%s", plugin);
+    std::snprintf(entry.m_file, sizeof(entry.m_file), "%s", file);
+    entry.m_message = std::move(message);
+    return entry;
+}
+
+static void WakeWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_WriterLock);
+        s_WriterWake = true;
+    }
+    s_WriterSignal.notify_one();
+}
 
-    if (logFile)
+static bool DrainBuffers(std::vector<Entry>& batch)
+{
+    bool anyLeft = false;
+    std::lock_guard<std::mutex> lock(s_BuffersLock);
+
+    for (auto it = s_Buffers.begin(); it != s_Buffers.end();)
     {
-        std::fprintf(logFile, "%s\n", message);
-        if (s_Tasks)
+        ThreadBuffer& buffer = **it;
+        // Read the flag before draining, so entries pushed just before the thread exited are not lost.
+        const bool orphaned = buffer.m_orphaned;
+        buffer.Drain(batch);
+
+        if (orphaned && buffer.Size() == 0)
         {
-            s_Tasks->QueueOnAsyncThread([&]() { std::fflush(logFile); });
+            it = s_Buffers.erase(it);
         }
         else
         {
+            anyLeft = anyLeft || buffer.Size() != 0;
+            ++it;
+        }
+    }
+
+    return anyLeft;
+}
+
+static std::mutex s_FlushLock;
+
+// Writes out everything the threads have logged so far, in order. Returns whether more was logged meanwhile.
+static bool FlushBuffers()
+{
+    std::vector<Entry> batch;
+    std::lock_guard<std::mutex> lock(s_FlushLock);
+
+    const bool anyLeft = DrainBuffers(batch);
+
+    // Each thread's buffer is ordered, but threads interleave.
+    std::sort(batch.begin(), batch.end(),
+        [](const Entry& a, const Entry& b) { return a.m_sequence < b.m_sequence; });
+
+    if (const uint64_t dropped = s_Dropped.exchange(0))
+    {
+        batch.push_back(MakeEntry(Channel::SEV_WARNING, "NWNXLib", "Log.cpp", __LINE__,
+            tfm::format("Dropped %llu log messages because the log buffer was full.", dropped)));
+    }
+
+    WriteEntries(batch);
+    return anyLeft;
+}
+
+static void WriterThread()
+{
+    while (true)
+    {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(s_WriterLock);
+            s_WriterSignal.wait_for(lock, WRITER_INTERVAL, []{ return s_WriterWake || s_WriterStop; });
+            s_WriterWake = false;
+            stop = s_WriterStop;
+        }
+
+        while (FlushBuffers()) {}
+
+        if (stop)
+            break;
+    }
+}
+
+static ThreadBuffer* GetThreadBuffer()
+{
+    static thread_local ThreadBufferHandle s_handle;
+
+    if (!s_handle.m_buffer)
+    {
+        s_handle.m_buffer = std::make_shared<ThreadBuffer>(std::min(INITIAL_BUFFER_SIZE, s_BufferSize), s_BufferSize);
+        std::lock_guard<std::mutex> lock(s_BuffersLock);
+        s_Buffers.push_back(s_handle.m_buffer);
+    }
+
+    return s_handle.m_buffer.get();
+}
+
+static bool GrowThreadBuffer(ThreadBuffer* buffer)
+{
+    // The writer only drains while holding the lock.
+    std::lock_guard<std::mutex> lock(s_BuffersLock);
+    return buffer->Grow();
+}
+
+void StartAsyncWriter(size_t bufferSize, bool blockWhenFull)
+{
+    if (s_AsyncRunning)
+        return;
+
+    // Round up to a power of two so ring positions can be masked.
+    s_BufferSize = 1;
+    while (s_BufferSize < bufferSize)
+        s_BufferSize <<= 1;
+
+    s_BlockWhenFull = blockWhenFull;
+    s_WriterStop = false;
+    s_WriterThread = std::thread(&WriterThread);
+    s_AsyncRunning = true;
+}
+
+void StopAsyncWriter()
+{
+    if (!s_AsyncRunning.exchange(false))
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(s_WriterLock);
+        s_WriterStop = true;
+    }
+    s_WriterSignal.notify_one();
+
+    if (s_WriterThread.joinable())
+        s_WriterThread.join();
+
+    // Entries pushed while the writer was doing its last drain.
+    while (FlushBuffers()) {}
+}
+
+static void PushAsync(Entry&& entry)
+{
+    ThreadBuffer* buffer = GetThreadBuffer();
+    const bool urgent = entry.m_channel <= Channel::SEV_ERROR;
+
+    if (!buffer->TryPush(std::move(entry)) && !(GrowThreadBuffer(buffer) && buffer->TryPush(std::move(entry))))
+    {
+        if (!s_BlockWhenFull && entry.m_channel != Channel::SEV_FATAL && s_AsyncRunning)
+        {
+            s_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        do
+        {
+            // Once the writer has stopped, nothing else will make room in the buffer.
+            if (s_AsyncRunning)
+            {
+                WakeWriter();
+                std::this_thread::yield();
+            }
+            else
+            {
+                FlushBuffers();
+            }
+        } while (!buffer->TryPush(std::move(entry)));
+    }
+
+    // The writer may have stopped after it was checked, in which case its last drain could have missed the entry.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!s_AsyncRunning)
+    {
+        while (FlushBuffers()) {}
+        return;
+    }
+
+    // The writer wakes up by itself every few milliseconds; only hurry it along when it matters.
+    if (urgent || buffer->Size() > buffer->Capacity() / 2)
+    {
+        WakeWriter();
+    }
+}
+
+void InternalTrace(Channel::Enum channel, const char* plugin, const char* file, int line, std::string&& message)
+{
+    Entry entry = MakeEntry(channel, plugin, file, line, std::move(message));
+
+    if (s_AsyncRunning)
+    {
+        PushAsync(std::move(entry));
+
+        if (channel == Channel::SEV_FATAL)
+        {
+            // Write everything out before aborting, the writer keeps running for the other threads meanwhile.
+            while (FlushBuffers()) {}
+        }
+    }
+    else
+    {
+        std::string text;
+        AppendText(text, entry);
+        WriteToConsole(entry, text);
+        std::cout.flush();
+
+        // Also write to a file - this could be done in a much nicer way but I just want to retain the old functionality
+        // for now. We can change this later if we want or need to.
+        if (FILE* logFile = GetLogFile())
+        {
+            if (GetJsonOutput())
+            {
+                text.clear();
+                AppendJson(text, entry);
+            }
+            std::fprintf(logFile, "%s\n", text.c_str());
             std::fflush(logFile);
         }
     }
@@ -119,21 +573,35 @@ void InternalTrace(Channel::Enum channel, Channel::Enum allowedChannel, const ch
     }
 }
 
-// Unfortunately this needs to be backed by an std::string rather than a const char* because the C++ standard library
-// doesn't provide a hashing function for a const char* and I'm too lazy to write or copy/paste one.
-// Small perf hit when logging.
-static std::unordered_map<std::string, Channel::Enum> s_LogLevelMap;
+// Slots are never freed, so the pointers handed out by GetLogLevelSlot stay valid for the lifetime of the process.
+static std::unordered_map<std::string, std::unique_ptr<std::atomic<Channel::Enum>>>& GetLogLevelMap()
+{
+    static std::unordered_map<std::string, std::unique_ptr<std::atomic<Channel::Enum>>> s_LogLevelMap;
+    return s_LogLevelMap;
+}
+static std::mutex s_LogLevelLock;
+
+std::atomic<Channel::Enum>* GetLogLevelSlot(const char* plugin)
+{
+    std::lock_guard<std::mutex> lock(s_LogLevelLock);
+    auto& slot = GetLogLevelMap()[plugin];
+
+    if (!slot)
+    {
+        slot = std::make_unique<std::atomic<Channel::Enum>>(Channel::SEV_NOTICE);
+    }
+
+    return slot.get();
+}
 
 Channel::Enum GetLogLevel(const char* plugin)
 {
-    // TODO: Is this thread safe? I think so if we're just looking up but I don't know.
-    auto entry = s_LogLevelMap.find(plugin);
-    return entry == std::end(s_LogLevelMap) ? Channel::SEV_NOTICE : entry->second;
+    return GetLogLevelSlot(plugin)->load(std::memory_order_relaxed);
 }
 
 void SetLogLevel(const char* plugin, Channel::Enum logLevel)
 {
-    s_LogLevelMap[plugin] = logLevel;
+    GetLogLevelSlot(plugin)->store(logLevel, std::memory_order_relaxed);
 }
 
 }
@@ -1,32 +1,48 @@
 #pragma once
 
 #include "External/tinyformat/tinyformat.hpp"
+#include <atomic>
 #include <cstdio>
 #include <cstring>
-#include <sstream>
-#include <ctime>
-
-namespace NWNXLib::Services { class Tasks; }
+#include <string>
 
 namespace NWNXLib::Log {
 
+// Messages above this severity are compiled out entirely. Defaults to keeping everything.
+#ifndef NWNX_LOG_COMPILE_LEVEL
+#define NWNX_LOG_COMPILE_LEVEL 7
+#endif
+
+// The level check comes first, so the arguments of a suppressed message are never evaluated.
+#define NWNX_LOG_INTERNAL(channel, format, ...)                                                             \
+    do                                                                                                      \
+    {                                                                                                       \
+        if constexpr (channel <= NWNX_LOG_COMPILE_LEVEL || channel == ::NWNXLib::Log::Channel::SEV_FATAL)   \
+        {                                                                                                   \
+            if (channel <= ::NWNXLib::Log::s_PluginLogLevel->load(std::memory_order_relaxed))               \
+            {                                                                                               \
+                ::NWNXLib::Log::Trace(channel, PLUGIN_NAME, __FILE__, __LINE__, (format), ##__VA_ARGS__);   \
+            }                                                                                               \
+        }                                                                                                   \
+    } while (0)
+
 #define LOG_DEBUG(format, ...) \
-    ::NWNXLib::Log::Trace(::NWNXLib::Log::Channel::SEV_DEBUG, PLUGIN_NAME, __FILE__, __LINE__, (format), ##__VA_ARGS__)
+    NWNX_LOG_INTERNAL(::NWNXLib::Log::Channel::SEV_DEBUG, (format), ##__VA_ARGS__)
 
 #define LOG_INFO(format, ...) \
-    ::NWNXLib::Log::Trace((::NWNXLib::Log::Channel::SEV_INFO), PLUGIN_NAME, __FILE__, __LINE__, (format), ##__VA_ARGS__)
+    NWNX_LOG_INTERNAL(::NWNXLib::Log::Channel::SEV_INFO, (format), ##__VA_ARGS__)
 
 #define LOG_NOTICE(format, ...) \
-    ::NWNXLib::Log::Trace((::NWNXLib::Log::Channel::SEV_NOTICE), PLUGIN_NAME, __FILE__, __LINE__, (format), ##__VA_ARGS__)
+    NWNX_LOG_INTERNAL(::NWNXLib::Log::Channel::SEV_NOTICE, (format), ##__VA_ARGS__)
 
 #define LOG_WARNING(format, ...) \
-    ::NWNXLib::Log::Trace((::NWNXLib::Log::Channel::SEV_WARNING), PLUGIN_NAME, __FILE__, __LINE__, (format), ##__VA_ARGS__)
+    NWNX_LOG_INTERNAL(::NWNXLib::Log::Channel::SEV_WARNING, (format), ##__VA_ARGS__)
 
 #define LOG_ERROR(format, ...) \
-    ::NWNXLib::Log::Trace((::NWNXLib::Log::Channel::SEV_ERROR), PLUGIN_NAME, __FILE__, __LINE__, (format), ##__VA_ARGS__)
+    NWNX_LOG_INTERNAL(::NWNXLib::Log::Channel::SEV_ERROR, (format), ##__VA_ARGS__)
 
 #define LOG_FATAL(format, ...) \
-    ::NWNXLib::Log::Trace((::NWNXLib::Log::Channel::SEV_FATAL), PLUGIN_NAME, __FILE__, __LINE__, (format), ##__VA_ARGS__)
+    NWNX_LOG_INTERNAL(::NWNXLib::Log::Channel::SEV_FATAL, (format), ##__VA_ARGS__)
 
 struct Channel
 {
@@ -65,11 +81,15 @@ struct Channel
     };
 };
 
+// Writes the message unconditionally; the LOG_* macros do the level filtering.
 template <typename ... Args>
 void Trace(Channel::Enum channel, const char* plugin, const char* file, int line, const char* format, Args&& ... args);
 
 Channel::Enum GetLogLevel(const char* plugin);
 void SetLogLevel(const char* plugin, Channel::Enum logLevel);
+
+// Returns the level of the given plugin. The pointer stays valid and follows SetLogLevel.
+std::atomic<Channel::Enum>* GetLogLevelSlot(const char* plugin);
 void SetPrintTimestamp(bool value);
 bool GetPrintTimestamp();
 void SetPrintDate(bool value);
@@ -82,8 +102,22 @@ void SetColorOutput(bool value);
 bool GetColorOutput();
 void SetForceColor(bool value);
 bool GetForceColor();
-
-void SetAsync(NWNXLib::Services::Tasks* tasks);
+void SetJsonOutput(bool value);
+bool GetJsonOutput();
+
+// Hands formatted messages to a dedicated writer thread through per-thread ring buffers, which grow up to
+// bufferSize entries. When a buffer is full the message is either dropped (and counted) or the logging thread
+// waits for the writer, depending on blockWhenFull. Fatal messages are always written before returning.
+// Messages of one thread keep their order, messages of different threads are only ordered within a flush.
+void StartAsyncWriter(size_t bufferSize, bool blockWhenFull);
+void StopAsyncWriter();
+
+#ifdef PLUGIN_NAME
+namespace {
+// Looked up once per translation unit when the module is loaded, so checking the level is a single load.
+std::atomic<Channel::Enum>* const s_PluginLogLevel = GetLogLevelSlot(PLUGIN_NAME);
+}
+#endif
 
 #include "Log.inl"
 
@@ -90,20 +90,25 @@ std::vector<uint8_t> SerializeGameObject(CGameObject *pObject, bool bStripPCFlag
 
 CGameObject *DeserializeGameObject(const std::vector<uint8_t>& serialized)
 {
-    if (serialized.size() == 0)
+    return DeserializeGameObject(serialized.data(), serialized.size());
+}
+
+CGameObject *DeserializeGameObject(const uint8_t *serialized, size_t size)
+{
+    if (size == 0)
         return nullptr;
 
     CResGFF    resGff;
     CResStruct resStruct;
 
-    if (serialized.size() < 14*4) // GFF header size
+    if (size < 14*4) // GFF header size
         return nullptr;
 
     // resGff/resman will claim ownership of this pointer and free it in resGff destructor,
-    // so need a copy for them to play with since the vector can't relinquish its own.
-    uint8_t *data = new uint8_t[serialized.size()];
-    memcpy(data, serialized.data(), serialized.size());
-    if (!resGff.GetDataFromPointer((void*)data, (int32_t)serialized.size()))
+    // so need a copy for them to play with since the caller keeps its own.
+    uint8_t *data = new uint8_t[size];
+    memcpy(data, serialized, size);
+    if (!resGff.GetDataFromPointer((void*)data, (int32_t)size))
         return nullptr;
 
     resGff.InitializeForWriting();
@@ -22,6 +22,7 @@ std::string SerializeGameObjectB64(CGameObject *pObject, bool bStripPCFlags = tr
 // afterwards. The new object has a unique ObjectID
 //
 CGameObject *DeserializeGameObject(const std::vector<uint8_t>& serialized);
+CGameObject *DeserializeGameObject(const uint8_t *serialized, size_t size);
 CGameObject *DeserializeGameObjectB64(const std::string& serializedB64);
 
 } // NWNXLib
@@ -45,6 +45,7 @@ void Hooks::ClearHook(Hooks::RegistrationToken&& token)
                     throw std::runtime_error("Invalid or duplicate hook registration token.");
                 }
 
+                storage->m_orders.erase(storage->m_orders.begin() + (addrInSubscribers - subscribers.begin()));
                 subscribers.erase(addrInSubscribers);
 
                 if (subscribers.size() == 0)
@@ -5,6 +5,7 @@
 #include "Services/Services.hpp"
 
 #include <algorithm>
+#include <limits>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -29,11 +30,24 @@ public: // Structures
         EXCLUSIVE
     };
 
+    // Shared hook subscribers are called in ascending order, and in the order they were
+    // registered when their orders are the same.
+    enum Order : int32_t
+    {
+        EARLIEST = std::numeric_limits<int32_t>::min(),
+        EARLY = -1000,
+        DEFAULT = 0,
+        LATE = 1000,
+        LATEST = std::numeric_limits<int32_t>::max()
+    };
+
     struct HookStorage
     {
         std::unique_ptr<Hooking::FunctionHook> m_hook;
         Type m_type;
         std::vector<uintptr_t> m_subscribers;
+        // The order of each subscriber, kept sorted along with them.
+        std::vector<int32_t> m_orders;
     };
 
     struct RegistrationToken
@@ -50,7 +64,7 @@ public:
     ~Hooks();
 
     template <uintptr_t Address, typename Ret, typename ... Params>
-    RegistrationToken RequestSharedHook(void(*funcPtr)(bool, Params ...));
+    RegistrationToken RequestSharedHook(void(*funcPtr)(bool, Params ...), int32_t order = Order::DEFAULT);
 
     template <uintptr_t Address, typename Ret, typename ... Params>
     RegistrationToken RequestExclusiveHook(Ret(*funcPtr)(Params ...));
@@ -71,7 +85,7 @@ public:
     ~HooksProxy();
 
     template <uintptr_t Address, typename Ret, typename ... Params>
-    void RequestSharedHook(void(*funcPtr)(bool, Params ...));
+    void RequestSharedHook(void(*funcPtr)(bool, Params ...), int32_t order = Hooks::Order::DEFAULT);
 
     template <uintptr_t Address, typename Ret, typename ... Params>
     void RequestExclusiveHook(Ret(*funcPtr)(Params ...));
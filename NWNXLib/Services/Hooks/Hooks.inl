@@ -1,7 +1,7 @@
 #include "Services/Hooks/HooksImpl.hpp"
 
 template <uintptr_t Address, typename Ret, typename ... Params>
-Hooks::RegistrationToken Hooks::RequestSharedHook(void(*funcPtr)(bool, Params ...))
+Hooks::RegistrationToken Hooks::RequestSharedHook(void(*funcPtr)(bool, Params ...), int32_t order)
 {
     const uintptr_t funcPtrAddr = reinterpret_cast<uintptr_t>(funcPtr);
     auto hookStorage = m_hooks.find(Address);
@@ -14,13 +14,16 @@ Hooks::RegistrationToken Hooks::RequestSharedHook(void(*funcPtr)(bool, Params ..
         }
 
         auto& subscribers = hookStorage->second->m_subscribers;
+        auto& orders = hookStorage->second->m_orders;
 
         if (std::find(subscribers.begin(), subscribers.end(), funcPtrAddr) != subscribers.end())
         {
             throw std::runtime_error("This handler has already been registered with this shared hook.");
         }
 
-        subscribers.push_back(funcPtrAddr);
+        const auto position = std::upper_bound(orders.begin(), orders.end(), order) - orders.begin();
+        subscribers.insert(subscribers.begin() + position, funcPtrAddr);
+        orders.insert(orders.begin() + position, order);
     }
     else
     {
@@ -36,6 +39,7 @@ Hooks::RegistrationToken Hooks::RequestSharedHook(void(*funcPtr)(bool, Params ..
         newHookStorage->m_type = Type::SHARED;
         newHookStorage->m_hook = std::make_unique<Hooking::FunctionHook>(aslrAddress, sharedHandlerAddress);
         newHookStorage->m_subscribers.push_back(funcPtrAddr);
+        newHookStorage->m_orders.push_back(order);
 
         HooksImpl::template HookLandingHolderDataShared<Address>::s_hook = newHookStorage->m_hook.get();
         HooksImpl::template HookLandingHolderDataShared<Address>::s_subs = &newHookStorage->m_subscribers;
@@ -80,9 +84,9 @@ Hooks::RegistrationToken Hooks::RequestExclusiveHook(Ret(*funcPtr)(Params ...))
 }
 
 template <uintptr_t Address, typename Ret, typename ... Params>
-void HooksProxy::RequestSharedHook(void(*funcPtr)(bool, Params ...))
+void HooksProxy::RequestSharedHook(void(*funcPtr)(bool, Params ...), int32_t order)
 {
-    m_registrationTokens.push_back(m_proxyBase.RequestSharedHook<Address, Ret>(funcPtr));
+    m_registrationTokens.push_back(m_proxyBase.RequestSharedHook<Address, Ret>(funcPtr, order));
 }
 
 template <uintptr_t Address, typename Ret, typename ... Params>
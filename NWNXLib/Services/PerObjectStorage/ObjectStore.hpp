@@ -0,0 +1,77 @@
+#pragma once
+
+#include "API/CNWSCreature.hpp"
+#include "API/Types.hpp"
+#include "Services/PerObjectStorage/PerObjectStorage.hpp"
+#include "Utils.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace NWNXLib {
+
+namespace Services {
+
+// Keeps a T for game objects in their per object storage, so it is freed together with the object
+// and moves with a player's TURD when they log out. Lookups go through an index by object id
+// instead of the storage's string keys.
+template <typename T>
+class ObjectStore
+{
+public:
+    // Called before the data of a destroyed object is freed.
+    using ReleaseFunc = void(*)(T&);
+
+    // Fills in new data from what was saved with the object, returns false if nothing was.
+    using LoadFunc = bool(*)(CGameObject*, T&);
+
+    ObjectStore() = default;
+    ObjectStore(const ObjectStore&) = delete;
+    ObjectStore& operator=(const ObjectStore&) = delete;
+    ~ObjectStore();
+
+    void Initialize(PerObjectStorageProxy& perObjectStorage, std::string key, ReleaseFunc release = nullptr, LoadFunc load = nullptr);
+
+    // The data of the object, or nullptr if it has none. Only creates data that was saved with a
+    // player character, the first time it is looked up.
+    T* Get(const API::Types::ObjectID oid);
+    T* Get(CGameObject* pObject);
+
+    // The data of the object, created if needed. nullptr if the object doesn't exist.
+    T* GetOrCreate(const API::Types::ObjectID oid);
+    T* GetOrCreate(CGameObject* pObject);
+
+private:
+    struct Entry
+    {
+        T m_data;
+        ObjectStore* m_store;
+        // More than one after the entry moved with a player's TURD.
+        std::vector<API::Types::ObjectID> m_owners;
+    };
+
+    T* Lookup(CGameObject* pObject);
+    Entry* Create(CGameObject* pObject, bool bOnlyIfLoaded);
+    Entry* Adopt(const API::Types::ObjectID oid, Entry* entry);
+    static void Destroy(void* ptr);
+
+    PerObjectStorageProxy* m_perObjectStorage = nullptr;
+    std::string m_key;
+    ReleaseFunc m_release = nullptr;
+    LoadFunc m_load = nullptr;
+
+    // Marks player characters whose storage was already checked for data saved or carried on their TURD.
+    // Kept in their own storage, so it is gone with them when they log out.
+    std::string m_checkedKey;
+
+    std::unordered_map<API::Types::ObjectID, Entry*> m_index;
+    std::unordered_set<Entry*> m_entries;
+};
+
+#include "Services/PerObjectStorage/ObjectStore.inl"
+
+}
+
+}
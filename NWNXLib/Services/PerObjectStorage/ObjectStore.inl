@@ -0,0 +1,143 @@
+template <typename T>
+ObjectStore<T>::~ObjectStore()
+{
+    // Entries still held by objects are freed with them, without calling back into this store.
+    for (auto* entry : m_entries)
+        entry->m_store = nullptr;
+}
+
+template <typename T>
+void ObjectStore<T>::Initialize(PerObjectStorageProxy& perObjectStorage, std::string key, ReleaseFunc release, LoadFunc load)
+{
+    m_perObjectStorage = &perObjectStorage;
+    m_key = std::move(key);
+    m_checkedKey = m_key + "_CHECKED";
+    m_release = release;
+    m_load = load;
+}
+
+template <typename T>
+T* ObjectStore<T>::Get(const API::Types::ObjectID oid)
+{
+    auto entry = m_index.find(oid);
+    if (entry != std::end(m_index))
+        return &entry->second->m_data;
+
+    auto* pObject = Utils::GetGameObject(oid);
+    return pObject ? Lookup(pObject) : nullptr;
+}
+
+template <typename T>
+T* ObjectStore<T>::Get(CGameObject* pObject)
+{
+    if (!pObject)
+        return nullptr;
+
+    auto entry = m_index.find(pObject->m_idSelf);
+    if (entry != std::end(m_index))
+        return &entry->second->m_data;
+
+    return Lookup(pObject);
+}
+
+template <typename T>
+T* ObjectStore<T>::Lookup(CGameObject* pObject)
+{
+    auto* pCreature = Utils::AsNWSCreature(pObject);
+    if (!pCreature || !pCreature->m_bPlayerCharacter || !m_perObjectStorage)
+        return nullptr;
+
+    // The mark is copied along with the TURD, holding the id tells whether it was made for this object.
+    const auto checked = static_cast<int32_t>(pObject->m_idSelf);
+    if (m_perObjectStorage->Get<int>(pObject, m_checkedKey) == checked)
+        return nullptr;
+    m_perObjectStorage->Set(pObject, m_checkedKey, checked);
+
+    if (auto stored = m_perObjectStorage->Get<void*>(pObject, m_key))
+        return &Adopt(pObject->m_idSelf, static_cast<Entry*>(*stored))->m_data;
+
+    auto* entry = m_load ? Create(pObject, true) : nullptr;
+    return entry ? &entry->m_data : nullptr;
+}
+
+template <typename T>
+T* ObjectStore<T>::GetOrCreate(const API::Types::ObjectID oid)
+{
+    auto entry = m_index.find(oid);
+    if (entry != std::end(m_index))
+        return &entry->second->m_data;
+
+    auto* pObject = Utils::GetGameObject(oid);
+    if (!pObject)
+    {
+        LOG_WARNING("Object 0x%08x does not exist, its %s can not be changed.", oid, m_key);
+        return nullptr;
+    }
+
+    return GetOrCreate(pObject);
+}
+
+template <typename T>
+T* ObjectStore<T>::GetOrCreate(CGameObject* pObject)
+{
+    if (!pObject || !m_perObjectStorage)
+        return nullptr;
+
+    auto entry = m_index.find(pObject->m_idSelf);
+    if (entry != std::end(m_index))
+        return &entry->second->m_data;
+
+    // Whatever the object already holds wins over new data, so nothing it carried is replaced.
+    if (auto stored = m_perObjectStorage->Get<void*>(pObject, m_key))
+        return &Adopt(pObject->m_idSelf, static_cast<Entry*>(*stored))->m_data;
+
+    return &Create(pObject, false)->m_data;
+}
+
+template <typename T>
+typename ObjectStore<T>::Entry* ObjectStore<T>::Create(CGameObject* pObject, bool bOnlyIfLoaded)
+{
+    auto* entry = new Entry();
+    entry->m_store = this;
+
+    const bool bLoaded = m_load && m_load(pObject, entry->m_data);
+    if (bOnlyIfLoaded && !bLoaded)
+    {
+        delete entry;
+        return nullptr;
+    }
+
+    m_perObjectStorage->Set(pObject, m_key, entry, &Destroy);
+    m_entries.insert(entry);
+    return Adopt(pObject->m_idSelf, entry);
+}
+
+template <typename T>
+typename ObjectStore<T>::Entry* ObjectStore<T>::Adopt(const API::Types::ObjectID oid, Entry* entry)
+{
+    entry->m_owners.push_back(oid);
+    m_index.emplace(oid, entry);
+    return entry;
+}
+
+template <typename T>
+void ObjectStore<T>::Destroy(void* ptr)
+{
+    auto* entry = static_cast<Entry*>(ptr);
+
+    if (auto* store = entry->m_store)
+    {
+        for (auto oid : entry->m_owners)
+        {
+            auto owner = store->m_index.find(oid);
+            if (owner != std::end(store->m_index) && owner->second == entry)
+                store->m_index.erase(owner);
+        }
+        store->m_entries.erase(entry);
+
+        if (store->m_release)
+            store->m_release(entry->m_data);
+    }
+
+    delete entry;
+}
@@ -9,6 +9,7 @@
 #include "API/CExoLinkedListInternal.hpp"
 #include "API/CExoLinkedListNode.hpp"
 #include "API/Constants.hpp"
+#include "Utils/Regex.hpp"
 
 #include <sstream>
 #include <regex>
@@ -84,14 +85,14 @@ void PerObjectStorage::RemoveRegex(CGameObject *pGameObject, const std::string&
 {
     if (auto *pOS = GetObjectStorage(pGameObject))
     {
-        std::regex rgx(regex);
+        const auto rgx = Utils::GetRegex(regex);
 
         auto Remove = [&](auto &map) -> void {
             std::vector<std::string> erase;
 
             for (const auto& it: *map)
             {
-                if (std::regex_match(it.first, rgx))
+                if (std::regex_match(it.first, *rgx))
                     erase.push_back(it.first);
             }
 
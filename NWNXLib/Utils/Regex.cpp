@@ -0,0 +1,75 @@
+#include "Regex.hpp"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace NWNXLib {
+namespace Utils {
+
+namespace {
+
+struct RegexCache
+{
+    using Entry = std::pair<std::string, std::shared_ptr<const std::regex>>;
+
+    std::mutex mutex;
+    size_t size = 64;
+    // Most recently used first.
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    void Trim()
+    {
+        while (entries.size() > size)
+        {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+    }
+};
+
+RegexCache& GetCache()
+{
+    static RegexCache cache;
+    return cache;
+}
+
+}
+
+std::shared_ptr<const std::regex> GetRegex(const std::string& pattern)
+{
+    auto& cache = GetCache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.index.find(pattern);
+        if (it != cache.index.end())
+        {
+            cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+            return it->second->second;
+        }
+    }
+
+    // Compiled outside the lock, a pattern that doesn't compile throws without being cached.
+    auto regex = std::make_shared<const std::regex>(pattern);
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (cache.size == 0 || cache.index.count(pattern))
+        return regex;
+
+    cache.entries.emplace_front(pattern, regex);
+    cache.index.emplace(pattern, cache.entries.begin());
+    cache.Trim();
+
+    return regex;
+}
+
+void SetRegexCacheSize(size_t size)
+{
+    auto& cache = GetCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.size = size;
+    cache.Trim();
+}
+
+}
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <memory>
+#include <regex>
+#include <string>
+
+namespace NWNXLib::Utils {
+
+// Compiled regular expressions, shared by everything in the process. The most recently used
+// patterns are kept compiled, so matching the same pattern again doesn't rebuild it.
+// Throws std::regex_error if the pattern doesn't compile.
+std::shared_ptr<const std::regex> GetRegex(const std::string& pattern);
+
+// How many compiled patterns to keep, 0 disables the cache.
+void SetRegexCacheSize(size_t size);
+
+}
@@ -19,6 +19,7 @@
 #include "Services/Config/Config.hpp"
 #include "Services/Hooks/Hooks.hpp"
 #include "Services/PerObjectStorage/PerObjectStorage.hpp"
+#include "Services/Tasks/Tasks.hpp"
 
 using namespace NWNXLib;
 
@@ -49,7 +50,7 @@ using namespace NWNXLib::Services;
 namespace Chat {
 
 Chat::Chat(const Plugin::CreateParams& params)
-    : Plugin(params), m_skipMessage(false), m_depth(0)
+    : Plugin(params), m_skipMessage(false), m_depth(0), m_hearingGridValid(false)
 {
 #define REGISTER(func) \
     GetServices()->m_events->RegisterEvent(#func, \
@@ -68,11 +69,14 @@ Chat::Chat(const Plugin::CreateParams& params)
 #undef REGISTER
 
     m_chatScript = GetServices()->m_config->Get<std::string>("CHAT_SCRIPT", "");
+    m_hearingDistances.fill(0.0f);
     m_hearingDistances[Constants::ChatChannel::DmTalk]        = 20.0f;
     m_hearingDistances[Constants::ChatChannel::PlayerTalk]    = 20.0f;
     m_hearingDistances[Constants::ChatChannel::DmWhisper]     = 3.0f;
     m_hearingDistances[Constants::ChatChannel::PlayerWhisper] = 3.0f;
+    m_maxHearingDistances = m_hearingDistances;
     m_customHearingDistances = false;
+    m_playerHearingDistances.Initialize(*GetServices()->m_perObjectStorage, "HEARING_DISTANCES", nullptr, &LoadPlayerHearingDistances);
 
     GetServices()->m_hooks->RequestExclusiveHook<Functions::_ZN11CNWSMessage29SendServerToPlayerChatMessageEhj10CExoStringjRKS0_>(&Chat::SendServerToPlayerChatMessage);
     m_hook = GetServices()->m_hooks->FindHookByAddress(Functions::_ZN11CNWSMessage29SendServerToPlayerChatMessageEhj10CExoStringjRKS0_);
@@ -131,57 +135,54 @@ void Chat::SendServerToPlayerChatMessage(CNWSMessage* thisPtr, Constants::ChatCh
                     channel == Constants::ChatChannel::DmTalk ||
                     channel == Constants::ChatChannel::DmWhisper)
                 {
-                    auto *pPOS = g_plugin->GetServices()->m_perObjectStorage.get();
                     auto pSpeaker = Utils::AsNWSObject(server->GetGameObject(sender));
-                    auto distance = g_plugin->m_hearingDistances[channel];
+                    const auto defaultDistance = plugin.m_hearingDistances[channel];
                     auto speakerPos = Vector{0.0f, 0.0f, 0.0f};
-                    CNWSArea *speakerArea = nullptr;
+                    auto speakerArea = Constants::OBJECT_INVALID;
                     if (pSpeaker != nullptr)
                     {
-                        speakerArea = pSpeaker->GetArea();
+                        speakerArea = pSpeaker->m_oidArea;
                         speakerPos = pSpeaker->m_vPosition;
-                        pSpeaker->BroadcastDialog(*tellName, distance);
+                        pSpeaker->BroadcastDialog(*tellName, defaultDistance);
                     }
 
-                    for (auto *head = playerList->pHead; head; head = head->pNext)
-                    {
-                        auto *pClient = static_cast<CNWSClient*>(head->pObject);
-                        auto *listenerClient =  server->GetClientObjectByPlayerId(pClient->m_nPlayerID, 0);
-                        auto *listener = static_cast<CNWSPlayer*>(listenerClient);
-                        auto *listenerObj = Utils::AsNWSObject(listener->GetGameObject());
-
-                        auto pDistance = *pPOS->Get<float>(listenerObj->m_idSelf, "HEARING_DISTANCE:" + std::to_string(channel));
-                        if (pDistance >= 0)
+                    const auto& grid = plugin.GetHearingGrid();
+                    grid.ForEachNear(speakerArea, speakerPos, plugin.m_maxHearingDistances[channel],
+                        [&](const HearingGrid::Listener& listener)
                         {
-                            distance = pDistance;
+                            auto distance = defaultDistance;
+                            if (auto* pDistances = plugin.m_playerHearingDistances.Get(listener.m_oid))
+                            {
+                                if ((*pDistances)[channel] >= 0)
+                                    distance = (*pDistances)[channel];
+                            }
 
-                            auto v = listenerObj->m_vPosition;
+                            auto v = listener.m_position;
                             v.x -= speakerPos.x;
                             v.y -= speakerPos.y;
                             v.z -= speakerPos.z;
                             float vSquared = v.x*v.x + v.y*v.y + v.z*v.z;
-                            if (speakerArea == listenerObj->GetArea() && vSquared <= distance*distance)
+                            if (vSquared > distance*distance)
+                                return;
+
+                            switch (channel)
                             {
-                                switch (channel)
-                                {
-                                    case Constants::ChatChannel::PlayerTalk:
-                                        thisPtr->SendServerToPlayerChat_Talk(listener->m_nPlayerID, sender, message);
-                                        break;
-                                    case Constants::ChatChannel::DmTalk:
-                                        thisPtr->SendServerToPlayerChat_DM_Talk(listener->m_nPlayerID, sender, message);
-                                        break;
-                                    case Constants::ChatChannel::PlayerWhisper:
-                                        thisPtr->SendServerToPlayerChat_Whisper(listener->m_nPlayerID, sender, message);
-                                        break;
-                                    case Constants::ChatChannel::DmWhisper:
-                                        thisPtr->SendServerToPlayerChat_DM_Whisper(listener->m_nPlayerID, sender, message);
-                                        break;
-                                    default:
-                                        break;
-                                }
+                                case Constants::ChatChannel::PlayerTalk:
+                                    thisPtr->SendServerToPlayerChat_Talk(listener.m_playerId, sender, message);
+                                    break;
+                                case Constants::ChatChannel::DmTalk:
+                                    thisPtr->SendServerToPlayerChat_DM_Talk(listener.m_playerId, sender, message);
+                                    break;
+                                case Constants::ChatChannel::PlayerWhisper:
+                                    thisPtr->SendServerToPlayerChat_Whisper(listener.m_playerId, sender, message);
+                                    break;
+                                case Constants::ChatChannel::DmWhisper:
+                                    thisPtr->SendServerToPlayerChat_DM_Whisper(listener.m_playerId, sender, message);
+                                    break;
+                                default:
+                                    break;
                             }
-                        }
-                    }
+                        });
                 }
                 else
                 {
@@ -201,6 +202,56 @@ void Chat::SendServerToPlayerChatMessage(CNWSMessage* thisPtr, Constants::ChatCh
     }
 }
 
+const HearingGrid& Chat::GetHearingGrid()
+{
+    if (m_hearingGridValid)
+        return m_hearingGrid;
+
+    m_hearingGrid.Clear();
+
+    auto server = Globals::AppManager()->m_pServerExoApp;
+    if (auto *playerList = server->m_pcExoAppInternal->m_pNWSPlayerList->m_pcExoLinkedListInternal)
+    {
+        for (auto *head = playerList->pHead; head; head = head->pNext)
+        {
+            auto *pPlayer = static_cast<CNWSPlayer*>(head->pObject);
+            auto *pObject = pPlayer ? Utils::AsNWSObject(pPlayer->GetGameObject()) : nullptr;
+            if (!pObject)
+                continue;
+
+            // Reads the player's saved distances the first time, so they count towards the search bounds.
+            m_playerHearingDistances.Get(pObject);
+
+            m_hearingGrid.Add(pObject->m_oidArea, { pPlayer->m_nPlayerID, pObject->m_idSelf, pObject->m_vPosition });
+        }
+    }
+
+    // Players keep moving, the tasks of this tick run once it's done.
+    m_hearingGridValid = true;
+    GetServices()->m_tasks->QueueOnMainThread([this]() { m_hearingGridValid = false; });
+
+    return m_hearingGrid;
+}
+
+bool Chat::LoadPlayerHearingDistances(CGameObject* pObject, HearingDistances& distances)
+{
+    auto *pPOS = g_plugin->GetServices()->m_perObjectStorage.get();
+    bool bLoaded = false;
+
+    distances.fill(-1.0f);
+    for (int32_t channel = Constants::ChatChannel::MIN; channel <= Constants::ChatChannel::MAX; channel++)
+    {
+        if (auto distance = pPOS->Get<float>(pObject, "HEARING_DISTANCE:" + std::to_string(channel)))
+        {
+            distances[channel] = *distance;
+            g_plugin->m_maxHearingDistances[channel] = std::max(g_plugin->m_maxHearingDistances[channel], *distance);
+            bLoaded = true;
+        }
+    }
+
+    return bLoaded;
+}
+
 Events::ArgumentStack Chat::SendMessage(Events::ArgumentStack&& args)
 {
     int32_t retVal = false;
@@ -300,11 +351,14 @@ Events::ArgumentStack Chat::SetChatHearingDistance(Events::ArgumentStack&& args)
     const auto distance = Services::Events::ExtractArgument<float>(args);
     const auto playerOid = Services::Events::ExtractArgument<Types::ObjectID>(args);
     const auto channel = (Constants::ChatChannel::TYPE)Services::Events::ExtractArgument<int32_t>(args);
+    ASSERT_OR_THROW(channel >= Constants::ChatChannel::MIN);
+    ASSERT_OR_THROW(channel <= Constants::ChatChannel::MAX);
 
     if (playerOid == Constants::OBJECT_INVALID)
     {
         m_customHearingDistances = true;
         m_hearingDistances[channel] = distance;
+        m_maxHearingDistances[channel] = std::max(m_maxHearingDistances[channel], distance);
     }
     else
     {
@@ -315,9 +369,11 @@ Events::ArgumentStack Chat::SetChatHearingDistance(Events::ArgumentStack&& args)
         }
         else
         {
-            auto *pPOS = g_plugin->GetServices()->m_perObjectStorage.get();
             m_customHearingDistances = true;
-            pPOS->Set(playerOid, "HEARING_DISTANCE:" + std::to_string(channel), distance, true);
+            GetServices()->m_perObjectStorage->Set(playerOid, "HEARING_DISTANCE:" + std::to_string(channel), distance, true);
+            if (auto *pDistances = m_playerHearingDistances.GetOrCreate(playerOid))
+                (*pDistances)[channel] = distance;
+            m_maxHearingDistances[channel] = std::max(m_maxHearingDistances[channel], distance);
         }
     }
 
@@ -328,13 +384,15 @@ Events::ArgumentStack Chat::GetChatHearingDistance(Events::ArgumentStack&& args)
 {
     const auto playerOid = Services::Events::ExtractArgument<Types::ObjectID>(args);
     const auto channel = (Constants::ChatChannel::TYPE)Services::Events::ExtractArgument<int32_t>(args);
+    ASSERT_OR_THROW(channel >= Constants::ChatChannel::MIN);
+    ASSERT_OR_THROW(channel <= Constants::ChatChannel::MAX);
     float retVal = m_hearingDistances[channel];
 
     if (playerOid != Constants::OBJECT_INVALID)
     {
-        auto *pPOS = g_plugin->GetServices()->m_perObjectStorage.get();
-        auto playerHearingDistance = *pPOS->Get<float>(playerOid, "HEARING_DISTANCE:" + std::to_string(channel));
-        retVal = playerHearingDistance > 0 ? playerHearingDistance : m_hearingDistances[channel];
+        auto *pDistances = m_playerHearingDistances.Get(playerOid);
+        if (pDistances && (*pDistances)[channel] > 0)
+            retVal = (*pDistances)[channel];
     }
     return Events::Arguments(retVal);
 }
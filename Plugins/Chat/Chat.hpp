@@ -5,6 +5,9 @@
 #include "Plugin.hpp"
 #include "API/Constants/Misc.hpp"
 #include "Services/Events/Events.hpp"
+#include "Services/PerObjectStorage/ObjectStore.hpp"
+#include "HearingGrid.hpp"
+#include <array>
 
 using ArgumentStack = NWNXLib::Services::Events::ArgumentStack;
 
@@ -28,10 +31,25 @@ private:
 
     std::string m_chatScript;
     bool m_skipMessage;
-    bool m_customHearingDistances;
-    std::unordered_map<NWNXLib::API::Constants::ChatChannel::TYPE, float> m_hearingDistances;
     uint32_t m_depth;
 
+    // Hearing distance per channel. Negative for a player means the channel's default is used.
+    using HearingDistances = std::array<float, NWNXLib::API::Constants::ChatChannel::MAX + 1>;
+
+    bool m_customHearingDistances;
+    HearingDistances m_hearingDistances;
+    // The largest distance any player hears each channel from, which bounds the search for listeners.
+    HearingDistances m_maxHearingDistances;
+    // Saved with the character as one float per channel, these are read back on first use.
+    NWNXLib::Services::ObjectStore<HearingDistances> m_playerHearingDistances;
+
+    // Rebuilt at most once a tick, when a message needs it.
+    HearingGrid m_hearingGrid;
+    bool m_hearingGridValid;
+
+    const HearingGrid& GetHearingGrid();
+    static bool LoadPlayerHearingDistances(CGameObject* pObject, HearingDistances& distances);
+
     static void SendServerToPlayerChatMessage(CNWSMessage* thisPtr, NWNXLib::API::Constants::ChatChannel::TYPE channel, NWNXLib::API::Types::ObjectID sender,
         CExoString message, NWNXLib::API::Types::ObjectID target, CExoString* tellName);
 
@@ -0,0 +1,33 @@
+#include "HearingGrid.hpp"
+
+namespace Chat {
+
+void HearingGrid::Clear()
+{
+    // Keeps the areas and their cells around, players mostly stay where they were.
+    for (auto& area : m_areas)
+    {
+        for (auto& cell : area.second)
+        {
+            cell.second.clear();
+        }
+    }
+}
+
+void HearingGrid::Add(NWNXLib::API::Types::ObjectID area, const Listener& listener)
+{
+    const auto key = CellKey(CellCoordinate(listener.m_position.x), CellCoordinate(listener.m_position.y));
+    m_areas[area][key].push_back(listener);
+}
+
+int32_t HearingGrid::CellCoordinate(float value)
+{
+    return static_cast<int32_t>(std::floor(value / CELL_SIZE));
+}
+
+uint64_t HearingGrid::CellKey(int32_t x, int32_t y)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+}
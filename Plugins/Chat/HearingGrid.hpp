@@ -0,0 +1,83 @@
+#pragma once
+
+#include "API/Types.hpp"
+#include "API/Vector.hpp"
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Chat {
+
+// Players by area and position, so a message only has to visit the players close to its speaker.
+class HearingGrid
+{
+public:
+    struct Listener
+    {
+        NWNXLib::API::Types::PlayerID m_playerId;
+        NWNXLib::API::Types::ObjectID m_oid;
+        Vector m_position;
+    };
+
+    void Clear();
+    void Add(NWNXLib::API::Types::ObjectID area, const Listener& listener);
+
+    // Calls func for every listener in the area within radius of position. Distances are checked
+    // in the plane only, the caller checks the exact distance.
+    template <typename Func>
+    void ForEachNear(NWNXLib::API::Types::ObjectID area, const Vector& position, float radius, Func&& func) const;
+
+private:
+    // Large enough that a talk message only spans a few cells.
+    static constexpr float CELL_SIZE = 10.0f;
+
+    using Cells = std::unordered_map<uint64_t, std::vector<Listener>>;
+
+    static int32_t CellCoordinate(float value);
+    static uint64_t CellKey(int32_t x, int32_t y);
+
+    std::unordered_map<NWNXLib::API::Types::ObjectID, Cells> m_areas;
+};
+
+template <typename Func>
+void HearingGrid::ForEachNear(NWNXLib::API::Types::ObjectID area, const Vector& position, float radius, Func&& func) const
+{
+    auto cells = m_areas.find(area);
+    if (cells == std::end(m_areas))
+        return;
+
+    // Past as many cells as the area has, it's cheaper to go over all of them.
+    const float span = 2.0f * radius / CELL_SIZE + 2.0f;
+    if (span * span >= static_cast<float>(cells->second.size()))
+    {
+        for (const auto& cell : cells->second)
+        {
+            for (const auto& listener : cell.second)
+            {
+                func(listener);
+            }
+        }
+        return;
+    }
+
+    const int32_t minX = CellCoordinate(position.x - radius), maxX = CellCoordinate(position.x + radius);
+    const int32_t minY = CellCoordinate(position.y - radius), maxY = CellCoordinate(position.y + radius);
+
+    for (int32_t x = minX; x <= maxX; x++)
+    {
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            auto cell = cells->second.find(CellKey(x, y));
+            if (cell == std::end(cells->second))
+                continue;
+
+            for (const auto& listener : cell->second)
+            {
+                func(listener);
+            }
+        }
+    }
+}
+
+}
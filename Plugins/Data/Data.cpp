@@ -1,6 +1,8 @@
 #include "Data.hpp"
 #include "API/Version.hpp"
 #include "Providers/Array.hpp"
+#include "Providers/Map.hpp"
+#include "Providers/Set.hpp"
 
 using namespace NWNXLib;
 
@@ -30,7 +32,10 @@ namespace Data {
 Data::Data(const Plugin::CreateParams& params)
     : Plugin(params)
 {
-    m_arrayProvider = std::make_unique<Array>(*GetServices()->m_events);
+    m_arrayProvider = std::make_unique<Array>(*GetServices()->m_events, *GetServices()->m_perObjectStorage,
+                                              *GetServices()->m_metrics, *GetServices()->m_tasks);
+    m_mapProvider = std::make_unique<Map>(*GetServices()->m_events, *GetServices()->m_perObjectStorage);
+    m_setProvider = std::make_unique<Set>(*GetServices()->m_events, *GetServices()->m_perObjectStorage);
 }
 
 Data::~Data()
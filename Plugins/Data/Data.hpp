@@ -6,6 +6,8 @@
 namespace Data {
 
 class Array;
+class Map;
+class Set;
 
 class Data : public NWNXLib::Plugin
 {
@@ -15,6 +17,8 @@ public:
 
 private:
     std::unique_ptr<Array> m_arrayProvider;
+    std::unique_ptr<Map> m_mapProvider;
+    std::unique_ptr<Set> m_setProvider;
 };
 
 }
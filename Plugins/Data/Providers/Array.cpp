@@ -30,8 +30,20 @@ CommonArgs ExtractCommonArgs(Events::ArgumentStack& args)
     return { std::move(type), std::move(oid), std::move(tag) };
 }
 
-Array::Array(EventsProxy& events)
+MetricsProxy* Array::s_metrics;
+TasksProxy* Array::s_tasks;
+
+static bool s_usageMetricsQueued = false;
+static std::chrono::steady_clock::time_point s_lastUsageMetrics;
+
+ObjectStore<ObjectArrays> ObjectArrays::s_store;
+
+Array::Array(EventsProxy& events, PerObjectStorageProxy& perObjectStorage, MetricsProxy& metrics, TasksProxy& tasks)
 {
+    ObjectArrays::s_store.Initialize(perObjectStorage, "ARRAYS", &ReleaseObjectArrays);
+    s_metrics = &metrics;
+    s_tasks = &tasks;
+
     events.RegisterEvent("ArrayAt", &Array::ArrayAt);
     events.RegisterEvent("ArrayClear", &Array::ArrayClear);
     events.RegisterEvent("ArrayContains", &Array::ArrayContains);
@@ -48,6 +60,62 @@ Array::Array(EventsProxy& events)
     events.RegisterEvent("ArraySet", &Array::ArraySet);
 }
 
+Array::~Array()
+{
+    s_metrics = nullptr;
+    s_tasks = nullptr;
+}
+
+void Array::ReleaseObjectArrays(ObjectArrays& objectArrays)
+{
+    ArrayImpl<float>::Release(std::get<ArrayMap<float>>(objectArrays.m_arrays));
+    ArrayImpl<int32_t>::Release(std::get<ArrayMap<int32_t>>(objectArrays.m_arrays));
+    ArrayImpl<ObjectID>::Release(std::get<ArrayMap<ObjectID>>(objectArrays.m_arrays));
+    ArrayImpl<std::string>::Release(std::get<ArrayMap<std::string>>(objectArrays.m_arrays));
+}
+
+void Array::UsageChanged()
+{
+    if (s_usageMetricsQueued || !s_tasks)
+        return;
+
+    s_usageMetricsQueued = true;
+    s_tasks->QueueOnMainThread(&PushUsageMetrics);
+}
+
+void Array::PushUsageMetrics()
+{
+    if (!s_metrics)
+        return;
+
+    // Tasks queued while tasks run wait for the next tick, so this checks once a tick.
+    const auto now = std::chrono::steady_clock::now();
+    if (now - s_lastUsageMetrics < std::chrono::seconds(1))
+    {
+        s_tasks->QueueOnMainThread(&PushUsageMetrics);
+        return;
+    }
+
+    s_usageMetricsQueued = false;
+    s_lastUsageMetrics = now;
+
+    auto push = [](const char* type, const ArrayUsage& usage)
+    {
+        s_metrics->Push("DataArrays",
+            {
+                { "arrays", std::to_string(usage.m_arrays) },
+                { "elements", std::to_string(usage.m_elements) },
+                { "bytes", std::to_string(usage.m_bytes) },
+            },
+            { { "type", type } });
+    };
+
+    push("float", ArrayImpl<float>::GetUsage());
+    push("int", ArrayImpl<int32_t>::GetUsage());
+    push("object", ArrayImpl<ObjectID>::GetUsage());
+    push("string", ArrayImpl<std::string>::GetUsage());
+}
+
 Events::ArgumentStack Array::ArrayAt(Events::ArgumentStack&& rawArgs)
 {
     const CommonArgs args = ExtractCommonArgs(rawArgs);
@@ -3,14 +3,38 @@
 #include "API/Types.hpp"
 #include "Common.hpp"
 #include "Services/Events/Events.hpp"
+#include "Services/Metrics/Metrics.hpp"
+#include "Services/PerObjectStorage/ObjectStore.hpp"
+#include "Services/PerObjectStorage/PerObjectStorage.hpp"
+#include "Services/Tasks/Tasks.hpp"
 #include <algorithm>
 #include <string>
 #include <random>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
 namespace Data {
 
+template <typename T>
+using ArrayMap = std::unordered_map<std::string, std::vector<T>>;
+
+// All arrays of one object, kept in an ObjectStore.
+struct ObjectArrays
+{
+    std::tuple<ArrayMap<float>, ArrayMap<int32_t>, ArrayMap<NWNXLib::API::Types::ObjectID>, ArrayMap<std::string>> m_arrays;
+
+    static NWNXLib::Services::ObjectStore<ObjectArrays> s_store;
+};
+
+// What the arrays of one element type hold, over all objects.
+struct ArrayUsage
+{
+    int64_t m_arrays = 0;
+    int64_t m_elements = 0;
+    int64_t m_bytes = 0;
+};
+
 template <typename T>
 class ArrayImpl
 {
@@ -30,17 +54,49 @@ public:
     static void SortDescending(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
     static void Set(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, int32_t index, T&& element);
 
+    // Replaces the array with the elements, for the other providers to hand out bulk results.
+    static void Assign(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, std::vector<T>&& elements);
+
+    // Takes the arrays of a destroyed object out of the usage.
+    static void Release(ArrayMap<T>& arrays);
+
+    static const ArrayUsage& GetUsage();
+
 private:
-    // Maps from object -> { array tag, vector }.
-    static std::unordered_map<NWNXLib::API::Types::ObjectID, std::unordered_map<std::string, std::vector<T>>> m_store;
+    // Looks up an array for reading. Never creates anything, nullptr if there is no such array.
+    static std::vector<T>* Lookup(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+
+    // Looks up an array for writing, creating it if needed. nullptr if the object doesn't exist.
+    static std::vector<T>* Modify(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+
+    // Bytes held by the elements beyond the vector itself.
+    static int64_t ElementBytes(const T& element);
+    static int64_t ElementBytes(const std::vector<T>& collection, size_t first = 0);
+
+    static void AccountCapacity(const std::vector<T>& collection, size_t previousCapacity);
+
+    static ArrayUsage s_usage;
 };
 
 class Array
 {
 public:
-    Array(NWNXLib::Services::EventsProxy& events);
+    Array(NWNXLib::Services::EventsProxy& events,
+          NWNXLib::Services::PerObjectStorageProxy& perObjectStorage,
+          NWNXLib::Services::MetricsProxy& metrics,
+          NWNXLib::Services::TasksProxy& tasks);
+    ~Array();
 
 private:
+    static void ReleaseObjectArrays(ObjectArrays& objectArrays);
+
+    // Pushes the usage metrics, at most once a second.
+    static void UsageChanged();
+    static void PushUsageMetrics();
+
+    static NWNXLib::Services::MetricsProxy* s_metrics;
+    static NWNXLib::Services::TasksProxy* s_tasks;
+
     static NWNXLib::Services::Events::ArgumentStack ArrayAt(NWNXLib::Services::Events::ArgumentStack&& args);
     static NWNXLib::Services::Events::ArgumentStack ArrayClear(NWNXLib::Services::Events::ArgumentStack&& args);
     static NWNXLib::Services::Events::ArgumentStack ArrayContains(NWNXLib::Services::Events::ArgumentStack&& args);
@@ -1,108 +1,294 @@
 template <typename T>
-std::unordered_map<NWNXLib::API::Types::ObjectID, std::unordered_map<std::string, std::vector<T>>> ArrayImpl<T>::m_store;
+ArrayUsage ArrayImpl<T>::s_usage;
+
+template <typename T>
+std::vector<T>* ArrayImpl<T>::Lookup(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    auto* objectArrays = ObjectArrays::s_store.Get(oid);
+    if (!objectArrays)
+        return nullptr;
+
+    ArrayMap<T>& arrays = std::get<ArrayMap<T>>(objectArrays->m_arrays);
+    auto array = arrays.find(tag);
+    return array != std::end(arrays) ? &array->second : nullptr;
+}
+
+template <typename T>
+std::vector<T>* ArrayImpl<T>::Modify(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    auto* objectArrays = ObjectArrays::s_store.GetOrCreate(oid);
+    if (!objectArrays)
+        return nullptr;
+
+    auto array = std::get<ArrayMap<T>>(objectArrays->m_arrays).try_emplace(tag);
+    if (array.second)
+    {
+        s_usage.m_arrays++;
+        Array::UsageChanged();
+    }
+    return &array.first->second;
+}
+
+template <typename T>
+int64_t ArrayImpl<T>::ElementBytes(const T& element)
+{
+    if constexpr (std::is_same_v<T, std::string>)
+        return static_cast<int64_t>(element.size());
+    else
+        return 0;
+}
+
+template <typename T>
+int64_t ArrayImpl<T>::ElementBytes(const std::vector<T>& collection, size_t first)
+{
+    int64_t bytes = 0;
+    if constexpr (std::is_same_v<T, std::string>)
+    {
+        for (size_t i = first; i < collection.size(); i++)
+            bytes += ElementBytes(collection[i]);
+    }
+    return bytes;
+}
+
+template <typename T>
+void ArrayImpl<T>::AccountCapacity(const std::vector<T>& collection, size_t previousCapacity)
+{
+    s_usage.m_bytes += (static_cast<int64_t>(collection.capacity()) - static_cast<int64_t>(previousCapacity)) * sizeof(T);
+    Array::UsageChanged();
+}
+
+template <typename T>
+void ArrayImpl<T>::Assign(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, std::vector<T>&& elements)
+{
+    if (elements.empty())
+    {
+        Clear(oid, tag);
+        return;
+    }
+
+    std::vector<T>* collection = Modify(oid, tag);
+    if (!collection)
+        return;
+
+    const size_t previousCapacity = collection->capacity();
+    s_usage.m_elements -= collection->size();
+    s_usage.m_bytes -= ElementBytes(*collection);
+
+    *collection = std::move(elements);
+
+    s_usage.m_elements += collection->size();
+    s_usage.m_bytes += ElementBytes(*collection);
+    AccountCapacity(*collection, previousCapacity);
+}
+
+template <typename T>
+void ArrayImpl<T>::Release(ArrayMap<T>& arrays)
+{
+    for (auto& array : arrays)
+    {
+        s_usage.m_arrays--;
+        s_usage.m_elements -= array.second.size();
+        s_usage.m_bytes -= ElementBytes(array.second) + array.second.capacity() * sizeof(T);
+    }
+    arrays.clear();
+    Array::UsageChanged();
+}
+
+template <typename T>
+const ArrayUsage& ArrayImpl<T>::GetUsage()
+{
+    return s_usage;
+}
 
 template <typename T>
 T ArrayImpl<T>::At(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const int32_t index)
 {
-    std::vector<T>& collection = m_store[oid][tag];
+    const std::vector<T>* collection = Lookup(oid, tag);
 
-    const int32_t size = static_cast<int32_t>(collection.size());
+    const int32_t size = collection ? static_cast<int32_t>(collection->size()) : 0;
       ASSERT_OR_THROW(index < size);
       ASSERT_OR_THROW(index >= 0);
 
-    return collection[static_cast<size_t>(index)];
+    return (*collection)[static_cast<size_t>(index)];
 }
 
 template <typename T>
 void ArrayImpl<T>::Clear(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
 {
-    m_store[oid][tag].clear();
+    auto* objectArrays = ObjectArrays::s_store.Get(oid);
+    if (!objectArrays)
+        return;
+
+    ArrayMap<T>& arrays = std::get<ArrayMap<T>>(objectArrays->m_arrays);
+    auto array = arrays.find(tag);
+    if (array == std::end(arrays))
+        return;
+
+    // An empty array reads the same as one that doesn't exist, so give its memory back.
+    s_usage.m_arrays--;
+    s_usage.m_elements -= array->second.size();
+    s_usage.m_bytes -= ElementBytes(array->second) + array->second.capacity() * sizeof(T);
+    arrays.erase(array);
+    Array::UsageChanged();
 }
 
 template <typename T>
 int32_t ArrayImpl<T>::Contains(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const T& element)
 {
-    std::vector<T>& collection = m_store[oid][tag];
-    return std::find(std::begin(collection), std::end(collection), element) != std::end(collection) ? 1 : 0;
+    const std::vector<T>* collection = Lookup(oid, tag);
+    if (!collection)
+        return 0;
+
+    return std::find(std::begin(*collection), std::end(*collection), element) != std::end(*collection) ? 1 : 0;
 }
 
 template <typename T>
 void ArrayImpl<T>::Copy(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& otherTag)
 {
-    m_store[oid][tag] = m_store[oid][otherTag];
+    const std::vector<T>* source = Lookup(oid, otherTag);
+    if (!source)
+    {
+        Clear(oid, tag);
+        return;
+    }
+
+    std::vector<T>* collection = Modify(oid, tag);
+    if (!collection || collection == source)
+        return;
+
+    const size_t previousCapacity = collection->capacity();
+    s_usage.m_elements -= collection->size();
+    s_usage.m_bytes -= ElementBytes(*collection);
+
+    *collection = *source;
+
+    s_usage.m_elements += collection->size();
+    s_usage.m_bytes += ElementBytes(*collection);
+    AccountCapacity(*collection, previousCapacity);
 }
 
 template <typename T>
 void ArrayImpl<T>::Erase(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, int32_t index)
 {
-    std::vector<T>& collection = m_store[oid][tag];
-      ASSERT_OR_THROW(index < static_cast<int32_t>(collection.size()));
-    collection.erase(std::begin(collection) + index);
+    std::vector<T>* collection = Lookup(oid, tag);
+
+    const int32_t size = collection ? static_cast<int32_t>(collection->size()) : 0;
+      ASSERT_OR_THROW(index < size);
+      ASSERT_OR_THROW(index >= 0);
+
+    s_usage.m_elements--;
+    s_usage.m_bytes -= ElementBytes((*collection)[static_cast<size_t>(index)]);
+    collection->erase(std::begin(*collection) + index);
+    Array::UsageChanged();
 }
 
 template <typename T>
 int32_t ArrayImpl<T>::Find(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, T&& element)
 {
-    std::vector<T>& collection = m_store[oid][tag];
-    auto elem = std::find(std::begin(collection), std::end(collection), element);
-    return elem != std::end(collection) ? elem - std::begin(collection) : -1;
+    const std::vector<T>* collection = Lookup(oid, tag);
+    if (!collection)
+        return -1;
+
+    auto elem = std::find(std::begin(*collection), std::end(*collection), element);
+    return elem != std::end(*collection) ? elem - std::begin(*collection) : -1;
 }
 
 template <typename T>
 void ArrayImpl<T>::Insert(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, int32_t index, T&& element)
 {
-    std::vector<T>& collection = m_store[oid][tag];
+    std::vector<T>* collection = Modify(oid, tag);
+    if (!collection)
+        return;
+
       ASSERT_OR_THROW(index >= 0);
-      ASSERT_OR_THROW(index <= static_cast<int32_t>(collection.size()));
-    collection.insert(std::begin(collection) + index, std::forward<T>(element));
+      ASSERT_OR_THROW(index <= static_cast<int32_t>(collection->size()));
+
+    const size_t previousCapacity = collection->capacity();
+    s_usage.m_elements++;
+    s_usage.m_bytes += ElementBytes(element);
+
+    collection->insert(std::begin(*collection) + index, std::forward<T>(element));
+    AccountCapacity(*collection, previousCapacity);
 }
 
 template <typename T>
 void ArrayImpl<T>::PushBack(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, T&& element)
 {
-    m_store[oid][tag].push_back(std::forward<T>(element));
+    std::vector<T>* collection = Modify(oid, tag);
+    if (!collection)
+        return;
+
+    const size_t previousCapacity = collection->capacity();
+    s_usage.m_elements++;
+    s_usage.m_bytes += ElementBytes(element);
+
+    collection->push_back(std::forward<T>(element));
+    AccountCapacity(*collection, previousCapacity);
 }
 
 template <typename T>
 void ArrayImpl<T>::Resize(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, int32_t size)
 {
       ASSERT_OR_THROW(size >= 0);
-    m_store[oid][tag].resize(static_cast<size_t>(size));
+
+    std::vector<T>* collection = Modify(oid, tag);
+    if (!collection)
+        return;
+
+    const size_t previousCapacity = collection->capacity();
+    s_usage.m_elements += static_cast<int64_t>(size) - static_cast<int64_t>(collection->size());
+    s_usage.m_bytes -= ElementBytes(*collection, static_cast<size_t>(size));
+
+    collection->resize(static_cast<size_t>(size));
+    AccountCapacity(*collection, previousCapacity);
 }
 
 template <typename T>
 void ArrayImpl<T>::Shuffle(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
 {
     static auto rng = std::default_random_engine(std::random_device{}());
-    std::vector<T>& collection = m_store[oid][tag];
-    std::shuffle(std::begin(collection), std::end(collection), rng);
+    if (auto* collection = Lookup(oid, tag))
+    {
+        std::shuffle(std::begin(*collection), std::end(*collection), rng);
+    }
 }
 
 template <typename T>
 int32_t ArrayImpl<T>::Size(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
 {
-    return static_cast<int32_t>(m_store[oid][tag].size());
+    const std::vector<T>* collection = Lookup(oid, tag);
+    return collection ? static_cast<int32_t>(collection->size()) : 0;
 }
 
 template <typename T>
 void ArrayImpl<T>::SortAscending(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
 {
-    std::vector<T>& collection = m_store[oid][tag];
-    std::sort(std::begin(collection), std::end(collection));
+    if (auto* collection = Lookup(oid, tag))
+    {
+        std::sort(std::begin(*collection), std::end(*collection));
+    }
 }
 
 template <typename T>
 void ArrayImpl<T>::SortDescending(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
 {
-    std::vector<T>& collection = m_store[oid][tag];
-    std::sort(std::rbegin(collection), std::rend(collection));
+    if (auto* collection = Lookup(oid, tag))
+    {
+        std::sort(std::rbegin(*collection), std::rend(*collection));
+    }
 }
 
 template <typename T>
 void ArrayImpl<T>::Set(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, int32_t index, T&& element)
 {
-    std::vector<T>& collection = m_store[oid][tag];
+    std::vector<T>* collection = Lookup(oid, tag);
+
+    const int32_t size = collection ? static_cast<int32_t>(collection->size()) : 0;
       ASSERT_OR_THROW(index >= 0);
-      ASSERT_OR_THROW(index < static_cast<int32_t>(collection.size()));
-    collection[static_cast<size_t>(index)] = std::forward<T>(element);
+      ASSERT_OR_THROW(index < size);
+
+    T& current = (*collection)[static_cast<size_t>(index)];
+    s_usage.m_bytes += ElementBytes(element) - ElementBytes(current);
+    current = std::forward<T>(element);
+    Array::UsageChanged();
 }
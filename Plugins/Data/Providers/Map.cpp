@@ -0,0 +1,171 @@
+#include "Providers/Map.hpp"
+
+using namespace NWNXLib;
+using namespace NWNXLib::API;
+using namespace NWNXLib::API::Types;
+using namespace NWNXLib::Services;
+
+namespace Data {
+
+enum class MapType
+{
+    FLOAT = 0,
+    INTEGER,
+    OBJECT,
+    STRING
+};
+
+struct MapArgs
+{
+    MapType type;
+    ObjectID oid;
+    std::string tag;
+};
+
+static MapArgs ExtractMapArgs(Events::ArgumentStack& args)
+{
+    MapType type = static_cast<MapType>(Events::ExtractArgument<int32_t>(args));
+    ObjectID oid = Events::ExtractArgument<ObjectID>(args);
+    std::string tag = Events::ExtractArgument<std::string>(args);
+    return { std::move(type), std::move(oid), std::move(tag) };
+}
+
+ObjectStore<ObjectMaps> ObjectMaps::s_store;
+
+Map::Map(EventsProxy& events, PerObjectStorageProxy& perObjectStorage)
+{
+    ObjectMaps::s_store.Initialize(perObjectStorage, "MAPS");
+
+    events.RegisterEvent("MapClear", &Map::MapClear);
+    events.RegisterEvent("MapErase", &Map::MapErase);
+    events.RegisterEvent("MapGet", &Map::MapGet);
+    events.RegisterEvent("MapHas", &Map::MapHas);
+    events.RegisterEvent("MapKeysToArray", &Map::MapKeysToArray);
+    events.RegisterEvent("MapSet", &Map::MapSet);
+    events.RegisterEvent("MapSize", &Map::MapSize);
+}
+
+Map::~Map()
+{
+}
+
+Events::ArgumentStack Map::MapClear(Events::ArgumentStack&& rawArgs)
+{
+    const MapArgs args = ExtractMapArgs(rawArgs);
+
+    switch (args.type)
+    {
+        case MapType::FLOAT: MapImpl<float>::Clear(args.oid, args.tag); break;
+        case MapType::INTEGER: MapImpl<int32_t>::Clear(args.oid, args.tag); break;
+        case MapType::OBJECT: MapImpl<ObjectID>::Clear(args.oid, args.tag); break;
+        case MapType::STRING: MapImpl<std::string>::Clear(args.oid, args.tag); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments();
+}
+
+Events::ArgumentStack Map::MapErase(Events::ArgumentStack&& rawArgs)
+{
+    const MapArgs args = ExtractMapArgs(rawArgs);
+    const auto key = Events::ExtractArgument<std::string>(rawArgs);
+    int32_t erased = 0;
+
+    switch (args.type)
+    {
+        case MapType::FLOAT: erased = MapImpl<float>::Erase(args.oid, args.tag, key); break;
+        case MapType::INTEGER: erased = MapImpl<int32_t>::Erase(args.oid, args.tag, key); break;
+        case MapType::OBJECT: erased = MapImpl<ObjectID>::Erase(args.oid, args.tag, key); break;
+        case MapType::STRING: erased = MapImpl<std::string>::Erase(args.oid, args.tag, key); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(erased);
+}
+
+Events::ArgumentStack Map::MapGet(Events::ArgumentStack&& rawArgs)
+{
+    const MapArgs args = ExtractMapArgs(rawArgs);
+    const auto key = Events::ExtractArgument<std::string>(rawArgs);
+
+    switch (args.type)
+    {
+        case MapType::FLOAT:   return Events::Arguments(MapImpl<float>::Get(args.oid, args.tag, key));
+        case MapType::INTEGER: return Events::Arguments(MapImpl<int32_t>::Get(args.oid, args.tag, key));
+        case MapType::OBJECT:  return Events::Arguments(MapImpl<ObjectID>::Get(args.oid, args.tag, key));
+        case MapType::STRING:  return Events::Arguments(MapImpl<std::string>::Get(args.oid, args.tag, key));
+        default: ASSERT_FAIL();  return Events::Arguments();
+    }
+}
+
+Events::ArgumentStack Map::MapHas(Events::ArgumentStack&& rawArgs)
+{
+    const MapArgs args = ExtractMapArgs(rawArgs);
+    const auto key = Events::ExtractArgument<std::string>(rawArgs);
+    int32_t has = 0;
+
+    switch (args.type)
+    {
+        case MapType::FLOAT: has = MapImpl<float>::Has(args.oid, args.tag, key); break;
+        case MapType::INTEGER: has = MapImpl<int32_t>::Has(args.oid, args.tag, key); break;
+        case MapType::OBJECT: has = MapImpl<ObjectID>::Has(args.oid, args.tag, key); break;
+        case MapType::STRING: has = MapImpl<std::string>::Has(args.oid, args.tag, key); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(has);
+}
+
+Events::ArgumentStack Map::MapKeysToArray(Events::ArgumentStack&& rawArgs)
+{
+    const MapArgs args = ExtractMapArgs(rawArgs);
+    const auto arrayTag = Events::ExtractArgument<std::string>(rawArgs);
+    int32_t count = 0;
+
+    switch (args.type)
+    {
+        case MapType::FLOAT: count = MapImpl<float>::KeysToArray(args.oid, args.tag, arrayTag); break;
+        case MapType::INTEGER: count = MapImpl<int32_t>::KeysToArray(args.oid, args.tag, arrayTag); break;
+        case MapType::OBJECT: count = MapImpl<ObjectID>::KeysToArray(args.oid, args.tag, arrayTag); break;
+        case MapType::STRING: count = MapImpl<std::string>::KeysToArray(args.oid, args.tag, arrayTag); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(count);
+}
+
+Events::ArgumentStack Map::MapSet(Events::ArgumentStack&& rawArgs)
+{
+    const MapArgs args = ExtractMapArgs(rawArgs);
+    auto key = Events::ExtractArgument<std::string>(rawArgs);
+
+    switch (args.type)
+    {
+        case MapType::FLOAT: MapImpl<float>::Set(args.oid, args.tag, std::move(key), Events::ExtractArgument<float>(rawArgs)); break;
+        case MapType::INTEGER: MapImpl<int32_t>::Set(args.oid, args.tag, std::move(key), Events::ExtractArgument<int32_t>(rawArgs)); break;
+        case MapType::OBJECT: MapImpl<ObjectID>::Set(args.oid, args.tag, std::move(key), Events::ExtractArgument<ObjectID>(rawArgs)); break;
+        case MapType::STRING: MapImpl<std::string>::Set(args.oid, args.tag, std::move(key), Events::ExtractArgument<std::string>(rawArgs)); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments();
+}
+
+Events::ArgumentStack Map::MapSize(Events::ArgumentStack&& rawArgs)
+{
+    const MapArgs args = ExtractMapArgs(rawArgs);
+    int32_t size = 0;
+
+    switch (args.type)
+    {
+        case MapType::FLOAT: size = MapImpl<float>::Size(args.oid, args.tag); break;
+        case MapType::INTEGER: size = MapImpl<int32_t>::Size(args.oid, args.tag); break;
+        case MapType::OBJECT: size = MapImpl<ObjectID>::Size(args.oid, args.tag); break;
+        case MapType::STRING: size = MapImpl<std::string>::Size(args.oid, args.tag); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(size);
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "API/Types.hpp"
+#include "Common.hpp"
+#include "Providers/Array.hpp"
+#include "Services/Events/Events.hpp"
+#include "Services/PerObjectStorage/ObjectStore.hpp"
+#include "Services/PerObjectStorage/PerObjectStorage.hpp"
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace Data {
+
+template <typename T>
+using MapMap = std::unordered_map<std::string, std::unordered_map<std::string, T>>;
+
+// All maps of one object, kept in an ObjectStore.
+struct ObjectMaps
+{
+    std::tuple<MapMap<float>, MapMap<int32_t>, MapMap<NWNXLib::API::Types::ObjectID>, MapMap<std::string>> m_maps;
+
+    static NWNXLib::Services::ObjectStore<ObjectMaps> s_store;
+};
+
+template <typename T>
+class MapImpl
+{
+public:
+    static T Get(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& key);
+    static int32_t Has(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& key);
+    static void Set(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, std::string&& key, T&& value);
+    static int32_t Erase(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& key);
+    static void Clear(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+    static int32_t Size(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+    static int32_t KeysToArray(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& arrayTag);
+
+private:
+    // Looks up a map for reading. Never creates anything, nullptr if there is no such map.
+    static std::unordered_map<std::string, T>* Lookup(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+
+    // Looks up a map for writing, creating it if needed. nullptr if the object doesn't exist.
+    static std::unordered_map<std::string, T>* Modify(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+
+    // What Get returns for keys that aren't set.
+    static T Default();
+};
+
+class Map
+{
+public:
+    Map(NWNXLib::Services::EventsProxy& events, NWNXLib::Services::PerObjectStorageProxy& perObjectStorage);
+    ~Map();
+
+private:
+    static NWNXLib::Services::Events::ArgumentStack MapClear(NWNXLib::Services::Events::ArgumentStack&& args);
+    static NWNXLib::Services::Events::ArgumentStack MapErase(NWNXLib::Services::Events::ArgumentStack&& args);
+    static NWNXLib::Services::Events::ArgumentStack MapGet(NWNXLib::Services::Events::ArgumentStack&& args);
+    static NWNXLib::Services::Events::ArgumentStack MapHas(NWNXLib::Services::Events::ArgumentStack&& args);
+    static NWNXLib::Services::Events::ArgumentStack MapKeysToArray(NWNXLib::Services::Events::ArgumentStack&& args);
+    static NWNXLib::Services::Events::ArgumentStack MapSet(NWNXLib::Services::Events::ArgumentStack&& args);
+    static NWNXLib::Services::Events::ArgumentStack MapSize(NWNXLib::Services::Events::ArgumentStack&& args);
+};
+
+#include "Providers/Map.inl"
+
+}
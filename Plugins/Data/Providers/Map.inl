@@ -0,0 +1,107 @@
+template <typename T>
+std::unordered_map<std::string, T>* MapImpl<T>::Lookup(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    auto* objectMaps = ObjectMaps::s_store.Get(oid);
+    if (!objectMaps)
+        return nullptr;
+
+    MapMap<T>& maps = std::get<MapMap<T>>(objectMaps->m_maps);
+    auto map = maps.find(tag);
+    return map != std::end(maps) ? &map->second : nullptr;
+}
+
+template <typename T>
+std::unordered_map<std::string, T>* MapImpl<T>::Modify(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    auto* objectMaps = ObjectMaps::s_store.GetOrCreate(oid);
+    if (!objectMaps)
+        return nullptr;
+
+    return &std::get<MapMap<T>>(objectMaps->m_maps)[tag];
+}
+
+template <typename T>
+T MapImpl<T>::Default()
+{
+    if constexpr (std::is_same_v<T, NWNXLib::API::Types::ObjectID>)
+        return NWNXLib::API::Constants::OBJECT_INVALID;
+    else
+        return T();
+}
+
+template <typename T>
+T MapImpl<T>::Get(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& key)
+{
+    if (auto* map = Lookup(oid, tag))
+    {
+        auto value = map->find(key);
+        if (value != std::end(*map))
+            return value->second;
+    }
+
+    return Default();
+}
+
+template <typename T>
+int32_t MapImpl<T>::Has(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& key)
+{
+    const auto* map = Lookup(oid, tag);
+    return map && map->find(key) != std::end(*map) ? 1 : 0;
+}
+
+template <typename T>
+void MapImpl<T>::Set(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, std::string&& key, T&& value)
+{
+    if (auto* map = Modify(oid, tag))
+    {
+        map->insert_or_assign(std::move(key), std::forward<T>(value));
+    }
+}
+
+template <typename T>
+int32_t MapImpl<T>::Erase(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& key)
+{
+    auto* map = Lookup(oid, tag);
+    if (!map || !map->erase(key))
+        return 0;
+
+    // An empty map reads the same as one that doesn't exist, so give its memory back.
+    if (map->empty())
+        Clear(oid, tag);
+
+    return 1;
+}
+
+template <typename T>
+void MapImpl<T>::Clear(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    if (auto* objectMaps = ObjectMaps::s_store.Get(oid))
+    {
+        std::get<MapMap<T>>(objectMaps->m_maps).erase(tag);
+    }
+}
+
+template <typename T>
+int32_t MapImpl<T>::Size(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    const auto* map = Lookup(oid, tag);
+    return map ? static_cast<int32_t>(map->size()) : 0;
+}
+
+template <typename T>
+int32_t MapImpl<T>::KeysToArray(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& arrayTag)
+{
+    std::vector<std::string> keys;
+    if (const auto* map = Lookup(oid, tag))
+    {
+        keys.reserve(map->size());
+        for (const auto& value : *map)
+        {
+            keys.push_back(value.first);
+        }
+    }
+
+    const auto count = static_cast<int32_t>(keys.size());
+    ArrayImpl<std::string>::Assign(oid, arrayTag, std::move(keys));
+    return count;
+}
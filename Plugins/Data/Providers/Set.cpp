@@ -0,0 +1,209 @@
+#include "Providers/Set.hpp"
+
+using namespace NWNXLib;
+using namespace NWNXLib::API;
+using namespace NWNXLib::API::Types;
+using namespace NWNXLib::Services;
+
+namespace Data {
+
+enum class SetType
+{
+    FLOAT = 0,
+    INTEGER,
+    OBJECT,
+    STRING
+};
+
+struct SetArgs
+{
+    SetType type;
+    ObjectID oid;
+    std::string tag;
+};
+
+static SetArgs ExtractSetArgs(Events::ArgumentStack& args)
+{
+    SetType type = static_cast<SetType>(Events::ExtractArgument<int32_t>(args));
+    ObjectID oid = Events::ExtractArgument<ObjectID>(args);
+    std::string tag = Events::ExtractArgument<std::string>(args);
+    return { std::move(type), std::move(oid), std::move(tag) };
+}
+
+ObjectStore<ObjectSets> ObjectSets::s_store;
+
+Set::Set(EventsProxy& events, PerObjectStorageProxy& perObjectStorage)
+{
+    ObjectSets::s_store.Initialize(perObjectStorage, "SETS");
+
+    events.RegisterEvent("SetClear", &Set::SetClear<false>);
+    events.RegisterEvent("SetContains", &Set::SetContains<false>);
+    events.RegisterEvent("SetErase", &Set::SetErase<false>);
+    events.RegisterEvent("SetInsert", &Set::SetInsert<false>);
+    events.RegisterEvent("SetSize", &Set::SetSize<false>);
+    events.RegisterEvent("SetToArray", &Set::SetToArray<false>);
+
+    events.RegisterEvent("SortedSetClear", &Set::SetClear<true>);
+    events.RegisterEvent("SortedSetContains", &Set::SetContains<true>);
+    events.RegisterEvent("SortedSetErase", &Set::SetErase<true>);
+    events.RegisterEvent("SortedSetInsert", &Set::SetInsert<true>);
+    events.RegisterEvent("SortedSetSize", &Set::SetSize<true>);
+    events.RegisterEvent("SortedSetToArray", &Set::SetToArray<true>);
+    events.RegisterEvent("SortedSetRangeToArray", &Set::SortedSetRangeToArray);
+}
+
+Set::~Set()
+{
+}
+
+template <bool Sorted>
+Events::ArgumentStack Set::SetClear(Events::ArgumentStack&& rawArgs)
+{
+    const SetArgs args = ExtractSetArgs(rawArgs);
+
+    switch (args.type)
+    {
+        case SetType::FLOAT: SetImpl<Sorted, float>::Clear(args.oid, args.tag); break;
+        case SetType::INTEGER: SetImpl<Sorted, int32_t>::Clear(args.oid, args.tag); break;
+        case SetType::OBJECT: SetImpl<Sorted, ObjectID>::Clear(args.oid, args.tag); break;
+        case SetType::STRING: SetImpl<Sorted, std::string>::Clear(args.oid, args.tag); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments();
+}
+
+template <bool Sorted>
+Events::ArgumentStack Set::SetContains(Events::ArgumentStack&& rawArgs)
+{
+    const SetArgs args = ExtractSetArgs(rawArgs);
+    int32_t contains = 0;
+
+    switch (args.type)
+    {
+        case SetType::FLOAT: contains = SetImpl<Sorted, float>::Contains(args.oid, args.tag, Events::ExtractArgument<float>(rawArgs)); break;
+        case SetType::INTEGER: contains = SetImpl<Sorted, int32_t>::Contains(args.oid, args.tag, Events::ExtractArgument<int32_t>(rawArgs)); break;
+        case SetType::OBJECT: contains = SetImpl<Sorted, ObjectID>::Contains(args.oid, args.tag, Events::ExtractArgument<ObjectID>(rawArgs)); break;
+        case SetType::STRING: contains = SetImpl<Sorted, std::string>::Contains(args.oid, args.tag, Events::ExtractArgument<std::string>(rawArgs)); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(contains);
+}
+
+template <bool Sorted>
+Events::ArgumentStack Set::SetErase(Events::ArgumentStack&& rawArgs)
+{
+    const SetArgs args = ExtractSetArgs(rawArgs);
+    int32_t erased = 0;
+
+    switch (args.type)
+    {
+        case SetType::FLOAT: erased = SetImpl<Sorted, float>::Erase(args.oid, args.tag, Events::ExtractArgument<float>(rawArgs)); break;
+        case SetType::INTEGER: erased = SetImpl<Sorted, int32_t>::Erase(args.oid, args.tag, Events::ExtractArgument<int32_t>(rawArgs)); break;
+        case SetType::OBJECT: erased = SetImpl<Sorted, ObjectID>::Erase(args.oid, args.tag, Events::ExtractArgument<ObjectID>(rawArgs)); break;
+        case SetType::STRING: erased = SetImpl<Sorted, std::string>::Erase(args.oid, args.tag, Events::ExtractArgument<std::string>(rawArgs)); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(erased);
+}
+
+template <bool Sorted>
+Events::ArgumentStack Set::SetInsert(Events::ArgumentStack&& rawArgs)
+{
+    const SetArgs args = ExtractSetArgs(rawArgs);
+    int32_t inserted = 0;
+
+    switch (args.type)
+    {
+        case SetType::FLOAT: inserted = SetImpl<Sorted, float>::Insert(args.oid, args.tag, Events::ExtractArgument<float>(rawArgs)); break;
+        case SetType::INTEGER: inserted = SetImpl<Sorted, int32_t>::Insert(args.oid, args.tag, Events::ExtractArgument<int32_t>(rawArgs)); break;
+        case SetType::OBJECT: inserted = SetImpl<Sorted, ObjectID>::Insert(args.oid, args.tag, Events::ExtractArgument<ObjectID>(rawArgs)); break;
+        case SetType::STRING: inserted = SetImpl<Sorted, std::string>::Insert(args.oid, args.tag, Events::ExtractArgument<std::string>(rawArgs)); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(inserted);
+}
+
+template <bool Sorted>
+Events::ArgumentStack Set::SetSize(Events::ArgumentStack&& rawArgs)
+{
+    const SetArgs args = ExtractSetArgs(rawArgs);
+    int32_t size = 0;
+
+    switch (args.type)
+    {
+        case SetType::FLOAT: size = SetImpl<Sorted, float>::Size(args.oid, args.tag); break;
+        case SetType::INTEGER: size = SetImpl<Sorted, int32_t>::Size(args.oid, args.tag); break;
+        case SetType::OBJECT: size = SetImpl<Sorted, ObjectID>::Size(args.oid, args.tag); break;
+        case SetType::STRING: size = SetImpl<Sorted, std::string>::Size(args.oid, args.tag); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(size);
+}
+
+template <bool Sorted>
+Events::ArgumentStack Set::SetToArray(Events::ArgumentStack&& rawArgs)
+{
+    const SetArgs args = ExtractSetArgs(rawArgs);
+    const auto arrayTag = Events::ExtractArgument<std::string>(rawArgs);
+    int32_t count = 0;
+
+    switch (args.type)
+    {
+        case SetType::FLOAT: count = SetImpl<Sorted, float>::ToArray(args.oid, args.tag, arrayTag); break;
+        case SetType::INTEGER: count = SetImpl<Sorted, int32_t>::ToArray(args.oid, args.tag, arrayTag); break;
+        case SetType::OBJECT: count = SetImpl<Sorted, ObjectID>::ToArray(args.oid, args.tag, arrayTag); break;
+        case SetType::STRING: count = SetImpl<Sorted, std::string>::ToArray(args.oid, args.tag, arrayTag); break;
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(count);
+}
+
+Events::ArgumentStack Set::SortedSetRangeToArray(Events::ArgumentStack&& rawArgs)
+{
+    const SetArgs args = ExtractSetArgs(rawArgs);
+    const auto arrayTag = Events::ExtractArgument<std::string>(rawArgs);
+    int32_t count = 0;
+
+    switch (args.type)
+    {
+        case SetType::FLOAT:
+        {
+            const auto min = Events::ExtractArgument<float>(rawArgs);
+            const auto max = Events::ExtractArgument<float>(rawArgs);
+            count = SetImpl<true, float>::RangeToArray(args.oid, args.tag, min, max, arrayTag);
+            break;
+        }
+        case SetType::INTEGER:
+        {
+            const auto min = Events::ExtractArgument<int32_t>(rawArgs);
+            const auto max = Events::ExtractArgument<int32_t>(rawArgs);
+            count = SetImpl<true, int32_t>::RangeToArray(args.oid, args.tag, min, max, arrayTag);
+            break;
+        }
+        case SetType::OBJECT:
+        {
+            const auto min = Events::ExtractArgument<ObjectID>(rawArgs);
+            const auto max = Events::ExtractArgument<ObjectID>(rawArgs);
+            count = SetImpl<true, ObjectID>::RangeToArray(args.oid, args.tag, min, max, arrayTag);
+            break;
+        }
+        case SetType::STRING:
+        {
+            const auto min = Events::ExtractArgument<std::string>(rawArgs);
+            const auto max = Events::ExtractArgument<std::string>(rawArgs);
+            count = SetImpl<true, std::string>::RangeToArray(args.oid, args.tag, min, max, arrayTag);
+            break;
+        }
+        default: ASSERT_FAIL(); break;
+    }
+
+    return Events::Arguments(count);
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "API/Types.hpp"
+#include "Common.hpp"
+#include "Providers/Array.hpp"
+#include "Services/Events/Events.hpp"
+#include "Services/PerObjectStorage/ObjectStore.hpp"
+#include "Services/PerObjectStorage/PerObjectStorage.hpp"
+#include <set>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Data {
+
+// Sets are hashed, sorted sets are ordered for range queries.
+template <bool Sorted, typename T>
+using SetCollection = std::conditional_t<Sorted, std::set<T>, std::unordered_set<T>>;
+
+template <bool Sorted, typename T>
+using SetMap = std::unordered_map<std::string, SetCollection<Sorted, T>>;
+
+// All sets of one object, kept in an ObjectStore.
+struct ObjectSets
+{
+    std::tuple<SetMap<false, float>, SetMap<false, int32_t>, SetMap<false, NWNXLib::API::Types::ObjectID>, SetMap<false, std::string>,
+               SetMap<true, float>, SetMap<true, int32_t>, SetMap<true, NWNXLib::API::Types::ObjectID>, SetMap<true, std::string>> m_sets;
+
+    static NWNXLib::Services::ObjectStore<ObjectSets> s_store;
+};
+
+template <bool Sorted, typename T>
+class SetImpl
+{
+public:
+    static int32_t Insert(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, T&& element);
+    static int32_t Contains(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const T& element);
+    static int32_t Erase(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const T& element);
+    static void Clear(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+    static int32_t Size(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+    static int32_t ToArray(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& arrayTag);
+
+    // Sorted sets only. Copies the elements from min up to and including max.
+    static int32_t RangeToArray(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const T& min, const T& max, const std::string& arrayTag);
+
+private:
+    // Looks up a set for reading. Never creates anything, nullptr if there is no such set.
+    static SetCollection<Sorted, T>* Lookup(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+
+    // Looks up a set for writing, creating it if needed. nullptr if the object doesn't exist.
+    static SetCollection<Sorted, T>* Modify(const NWNXLib::API::Types::ObjectID oid, const std::string& tag);
+};
+
+class Set
+{
+public:
+    Set(NWNXLib::Services::EventsProxy& events, NWNXLib::Services::PerObjectStorageProxy& perObjectStorage);
+    ~Set();
+
+private:
+    template <bool Sorted>
+    static NWNXLib::Services::Events::ArgumentStack SetClear(NWNXLib::Services::Events::ArgumentStack&& args);
+    template <bool Sorted>
+    static NWNXLib::Services::Events::ArgumentStack SetContains(NWNXLib::Services::Events::ArgumentStack&& args);
+    template <bool Sorted>
+    static NWNXLib::Services::Events::ArgumentStack SetErase(NWNXLib::Services::Events::ArgumentStack&& args);
+    template <bool Sorted>
+    static NWNXLib::Services::Events::ArgumentStack SetInsert(NWNXLib::Services::Events::ArgumentStack&& args);
+    template <bool Sorted>
+    static NWNXLib::Services::Events::ArgumentStack SetSize(NWNXLib::Services::Events::ArgumentStack&& args);
+    template <bool Sorted>
+    static NWNXLib::Services::Events::ArgumentStack SetToArray(NWNXLib::Services::Events::ArgumentStack&& args);
+    static NWNXLib::Services::Events::ArgumentStack SortedSetRangeToArray(NWNXLib::Services::Events::ArgumentStack&& args);
+};
+
+#include "Providers/Set.inl"
+
+}
@@ -0,0 +1,96 @@
+template <bool Sorted, typename T>
+SetCollection<Sorted, T>* SetImpl<Sorted, T>::Lookup(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    auto* objectSets = ObjectSets::s_store.Get(oid);
+    if (!objectSets)
+        return nullptr;
+
+    SetMap<Sorted, T>& sets = std::get<SetMap<Sorted, T>>(objectSets->m_sets);
+    auto set = sets.find(tag);
+    return set != std::end(sets) ? &set->second : nullptr;
+}
+
+template <bool Sorted, typename T>
+SetCollection<Sorted, T>* SetImpl<Sorted, T>::Modify(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    auto* objectSets = ObjectSets::s_store.GetOrCreate(oid);
+    if (!objectSets)
+        return nullptr;
+
+    return &std::get<SetMap<Sorted, T>>(objectSets->m_sets)[tag];
+}
+
+template <bool Sorted, typename T>
+int32_t SetImpl<Sorted, T>::Insert(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, T&& element)
+{
+    auto* set = Modify(oid, tag);
+    return set && set->insert(std::forward<T>(element)).second ? 1 : 0;
+}
+
+template <bool Sorted, typename T>
+int32_t SetImpl<Sorted, T>::Contains(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const T& element)
+{
+    const auto* set = Lookup(oid, tag);
+    return set && set->find(element) != std::end(*set) ? 1 : 0;
+}
+
+template <bool Sorted, typename T>
+int32_t SetImpl<Sorted, T>::Erase(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const T& element)
+{
+    auto* set = Lookup(oid, tag);
+    if (!set || !set->erase(element))
+        return 0;
+
+    // An empty set reads the same as one that doesn't exist, so give its memory back.
+    if (set->empty())
+        Clear(oid, tag);
+
+    return 1;
+}
+
+template <bool Sorted, typename T>
+void SetImpl<Sorted, T>::Clear(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    if (auto* objectSets = ObjectSets::s_store.Get(oid))
+    {
+        std::get<SetMap<Sorted, T>>(objectSets->m_sets).erase(tag);
+    }
+}
+
+template <bool Sorted, typename T>
+int32_t SetImpl<Sorted, T>::Size(const NWNXLib::API::Types::ObjectID oid, const std::string& tag)
+{
+    const auto* set = Lookup(oid, tag);
+    return set ? static_cast<int32_t>(set->size()) : 0;
+}
+
+template <bool Sorted, typename T>
+int32_t SetImpl<Sorted, T>::ToArray(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const std::string& arrayTag)
+{
+    std::vector<T> elements;
+    if (const auto* set = Lookup(oid, tag))
+    {
+        elements.assign(std::begin(*set), std::end(*set));
+    }
+
+    const auto count = static_cast<int32_t>(elements.size());
+    ArrayImpl<T>::Assign(oid, arrayTag, std::move(elements));
+    return count;
+}
+
+template <bool Sorted, typename T>
+int32_t SetImpl<Sorted, T>::RangeToArray(const NWNXLib::API::Types::ObjectID oid, const std::string& tag, const T& min, const T& max, const std::string& arrayTag)
+{
+    static_assert(Sorted, "Only sorted sets have ranges.");
+
+    std::vector<T> elements;
+    const auto* set = Lookup(oid, tag);
+    if (set && !(max < min))
+    {
+        elements.assign(set->lower_bound(min), set->upper_bound(max));
+    }
+
+    const auto count = static_cast<int32_t>(elements.size());
+    ArrayImpl<T>::Assign(oid, arrayTag, std::move(elements));
+    return count;
+}
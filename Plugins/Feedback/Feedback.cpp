@@ -9,6 +9,7 @@
 #include "API/CNWSPlayer.hpp"
 #include "Services/Events/Events.hpp"
 #include "Services/PerObjectStorage/PerObjectStorage.hpp"
+#include <sstream>
 
 
 using namespace NWNXLib;
@@ -67,6 +68,8 @@ Feedback::Feedback(const Plugin::CreateParams& params)
 
     GetServices()->m_hooks->RequestExclusiveHook<API::Functions::_ZN11CNWSMessage32SendServerToPlayerJournalUpdatedEP10CNWSPlayerii13CExoLocString>(&SendServerToPlayerJournalUpdatedHook);
     m_SendServerToPlayerJournalUpdatedHook = GetServices()->m_hooks->FindHookByAddress(API::Functions::_ZN11CNWSMessage32SendServerToPlayerJournalUpdatedEP10CNWSPlayerii13CExoLocString);
+
+    m_PersonalStates.Initialize(*GetServices()->m_perObjectStorage, "STATES", nullptr, &LoadPersonalStates);
 }
 
 Feedback::~Feedback()
@@ -120,23 +123,93 @@ int32_t Feedback::SendServerToPlayerJournalUpdatedHook(
 
 bool Feedback::GetGlobalState(int32_t messageType, int32_t messageId)
 {
-    int32_t realMessageId = messageType * 10000 + messageId;
+    if (messageId < 0 || messageId >= MAX_MESSAGE_ID)
+        return false;
 
-    return g_plugin->m_GlobalHiddenMessageSet.find(realMessageId) != g_plugin->m_GlobalHiddenMessageSet.end();
+    return g_plugin->m_GlobalHiddenMessages[messageType][messageId];
 }
 
 int32_t Feedback::GetPersonalState(Types::ObjectID playerId, int32_t messageType, int32_t messageId)
 {
-    int32_t value = -1;
+    if (messageId < 0 || messageId >= MAX_MESSAGE_ID)
+        return -1;
+
+    auto *pStates = g_plugin->m_PersonalStates.Get(playerId);
+    if (!pStates || !pStates->m_set[messageType][messageId])
+        return -1;
+
+    return pStates->m_hidden[messageType][messageId];
+}
+
+bool Feedback::LoadPersonalStates(CGameObject *pObject, PersonalStates& states)
+{
+    auto *pPOS = g_plugin->GetServices()->m_perObjectStorage.get();
+    bool bLoaded = false;
 
-    std::string varName = std::to_string(messageType) + ":" + std::to_string(messageId);
+    // Saved as "type:id=state;" for every message with a personal state.
+    if (auto saved = pPOS->Get<std::string>(pObject, "SAVED_STATES"))
+    {
+        std::istringstream stream(*saved);
+        int32_t messageType, messageId, state;
+        char sep1, sep2, sep3;
+        while (stream >> messageType >> sep1 >> messageId >> sep2 >> state >> sep3)
+        {
+            if (messageType < 0 || messageType >= MESSAGE_TYPE_COUNT || messageId < 0 || messageId >= MAX_MESSAGE_ID)
+                continue;
+
+            states.m_set[messageType][messageId] = true;
+            states.m_hidden[messageType][messageId] = !!state;
+            bLoaded = true;
+        }
+    }
+    else
+    {
+        // Characters saved by older versions have an int for every message with a personal state.
+        const int32_t maxMessageIds[MESSAGE_TYPE_COUNT] = { MAX_MESSAGE_ID, 256, 1 };
+        for (int32_t messageType = 0; messageType < MESSAGE_TYPE_COUNT; messageType++)
+        {
+            for (int32_t messageId = 0; messageId < maxMessageIds[messageType]; messageId++)
+            {
+                std::string varName = std::to_string(messageType) + ":" + std::to_string(messageId);
+                if (auto state = pPOS->Get<int>(pObject, varName))
+                {
+                    states.m_set[messageType][messageId] = true;
+                    states.m_hidden[messageType][messageId] = !!*state;
+                    pPOS->Remove(pObject, varName);
+                    bLoaded = true;
+                }
+            }
+        }
+
+        if (bLoaded)
+            g_plugin->SavePersonalStates(pObject->m_idSelf, states);
+    }
+
+    return bLoaded;
+}
 
-    if (auto personalState = g_plugin->GetServices()->m_perObjectStorage->Get<int>(playerId, varName))
+void Feedback::SavePersonalStates(Types::ObjectID playerId, const PersonalStates& states)
+{
+    std::string saved;
+    for (int32_t messageType = 0; messageType < MESSAGE_TYPE_COUNT; messageType++)
     {
-        value = !!*personalState;
+        if (states.m_set[messageType].none())
+            continue;
+
+        for (int32_t messageId = 0; messageId < MAX_MESSAGE_ID; messageId++)
+        {
+            if (states.m_set[messageType][messageId])
+            {
+                saved += std::to_string(messageType) + ":" + std::to_string(messageId) + "=" +
+                         (states.m_hidden[messageType][messageId] ? "1" : "0") + ";";
+            }
+        }
     }
 
-    return value;
+    if (saved.empty())
+        GetServices()->m_perObjectStorage->Remove(playerId, "SAVED_STATES");
+    else
+        GetServices()->m_perObjectStorage->Set(playerId, "SAVED_STATES", saved, true);
 }
 
 ArgumentStack Feedback::GetMessageHidden(ArgumentStack&& args)
@@ -145,6 +218,9 @@ ArgumentStack Feedback::GetMessageHidden(ArgumentStack&& args)
     const auto messageType = Services::Events::ExtractArgument<int32_t>(args);
     const auto messageId = Services::Events::ExtractArgument<int32_t>(args);
 
+    ASSERT_OR_THROW(messageType >= 0);
+    ASSERT_OR_THROW(messageType < MESSAGE_TYPE_COUNT);
+
     int32_t retVal = (playerId == Constants::OBJECT_INVALID) ? GetGlobalState(messageType, messageId) :
                                                                GetPersonalState(playerId, messageType, messageId);
 
@@ -158,38 +234,30 @@ ArgumentStack Feedback::SetMessageHidden(ArgumentStack&& args)
     const auto messageId = Services::Events::ExtractArgument<int32_t>(args);
     const auto state = Services::Events::ExtractArgument<int32_t>(args);
 
+    ASSERT_OR_THROW(messageType >= 0);
+    ASSERT_OR_THROW(messageType < MESSAGE_TYPE_COUNT);
     ASSERT_OR_THROW(messageId >= 0);
+    ASSERT_OR_THROW(messageId < MAX_MESSAGE_ID);
 
     if (playerId == Constants::OBJECT_INVALID)
     {
-        int32_t realMessageId = messageType * 10000 + messageId;
-
-        if (!!state)
-        {
-            g_plugin->m_GlobalHiddenMessageSet.insert(realMessageId);
-        }
-        else
-        {
-            auto index = g_plugin->m_GlobalHiddenMessageSet.find(messageId);
-            if (index != g_plugin->m_GlobalHiddenMessageSet.end())
-            {
-                g_plugin->m_GlobalHiddenMessageSet.erase(index);
-            }
-        }
+        g_plugin->m_GlobalHiddenMessages[messageType][messageId] = !!state;
     }
-    else
+    else if (state == -1)
     {
-        std::string varName = std::to_string(messageType) + ":" + std::to_string(messageId);
-
-        if (state == -1)
-        {
-            g_plugin->GetServices()->m_perObjectStorage->Remove(playerId, varName);
-        }
-        else
+        if (auto *pStates = g_plugin->m_PersonalStates.Get(playerId))
         {
-            g_plugin->GetServices()->m_perObjectStorage->Set(playerId, varName, !!state, true);
+            pStates->m_set[messageType][messageId] = false;
+            pStates->m_hidden[messageType][messageId] = false;
+            g_plugin->SavePersonalStates(playerId, *pStates);
         }
     }
+    else if (auto *pStates = g_plugin->m_PersonalStates.GetOrCreate(playerId))
+    {
+        pStates->m_set[messageType][messageId] = true;
+        pStates->m_hidden[messageType][messageId] = !!state;
+        g_plugin->SavePersonalStates(playerId, *pStates);
+    }
     return Services::Events::Arguments();
 }
 
@@ -3,7 +3,10 @@
 #include "Plugin.hpp"
 #include "Services/Events/Events.hpp"
 #include "Services/Hooks/Hooks.hpp"
-#include <set>
+#include "Services/PerObjectStorage/ObjectStore.hpp"
+#include <array>
+#include <bitset>
+#include <string>
 
 using ArgumentStack = NWNXLib::Services::Events::ArgumentStack;
 
@@ -16,6 +19,19 @@ public:
     virtual ~Feedback();
 
 private:
+    static constexpr int32_t MESSAGE_TYPE_COUNT = 3;
+    static constexpr int32_t MAX_MESSAGE_ID = 512;
+
+    // One bit per message id, for each message type.
+    using MessageBits = std::array<std::bitset<MAX_MESSAGE_ID>, MESSAGE_TYPE_COUNT>;
+
+    // The messages a player has a personal state for, and which of those are hidden.
+    struct PersonalStates
+    {
+        MessageBits m_set;
+        MessageBits m_hidden;
+    };
+
     ArgumentStack GetMessageHidden          (ArgumentStack&& args);
     ArgumentStack SetMessageHidden          (ArgumentStack&& args);
     ArgumentStack SetFeedbackMode           (ArgumentStack&& args);
@@ -43,7 +59,12 @@ private:
     static bool GetGlobalState(int32_t messageType, int32_t messageId);
     static int32_t GetPersonalState(NWNXLib::API::Types::ObjectID playerId, int32_t messageType, int32_t messageId);
 
-    std::set<int32_t> m_GlobalHiddenMessageSet;
+    static bool LoadPersonalStates(CGameObject *pObject, PersonalStates& states);
+    void SavePersonalStates(NWNXLib::API::Types::ObjectID playerId, const PersonalStates& states);
+
+    MessageBits m_GlobalHiddenMessages;
+    // Saved with the character as one string, these are read back on first use.
+    NWNXLib::Services::ObjectStore<PersonalStates> m_PersonalStates;
     bool m_FeedbackMessageWhitelist = false;
     bool m_CombatMessageWhitelist = false;
 };
@@ -42,7 +42,9 @@ Optimizations::Optimizations(const Plugin::CreateParams& params)
     if (GetServices()->m_config->Get<bool>("GAME_OBJECT_LOOKUP", false))
     {
         LOG_INFO("Using optimial CGameObjectArray implementation");
-        m_GameObjectLookup = std::make_unique<GameObjectLookup>(GetServices()->m_hooks.get());
+        m_GameObjectLookup = std::make_unique<GameObjectLookup>(GetServices()->m_hooks.get(), GetServices()->m_metrics.get(),
+            GetServices()->m_config->Get<uint32_t>("GAME_OBJECT_LOOKUP_TABLE_BITS", 0),
+            GetServices()->m_config->Get<bool>("GAME_OBJECT_LOOKUP_STATS", false));
     }
 
     if (GetServices()->m_config->Get<bool>("OBJECT_TAG_LOOKUP", false))
@@ -1,7 +1,8 @@
 #include "Optimizations/GameObjectLookup.hpp"
 
 #include "Services/Hooks/Hooks.hpp"
-#include "Services/Tasks/Tasks.hpp"
+#include "Services/Metrics/Metrics.hpp"
+#include "Services/Metrics/Resamplers.hpp"
 #include "API/Functions.hpp"
 #include "API/Constants.hpp"
 #include "API/CAppManager.hpp"
@@ -9,13 +10,23 @@
 #include "API/CGameObject.hpp"
 #include "API/CGameObjectArray.hpp"
 
+#include <chrono>
+#include <emmintrin.h>
+
 namespace Optimizations {
 
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 
-GameObjectLookup::GameObjectLookup(Services::HooksProxy* hooker)
+static Services::MetricsProxy* g_metrics;
+
+GameObjectLookup::GameObjectLookup(Services::HooksProxy* hooker, Services::MetricsProxy* metrics,
+                                   uint32_t tableBits, bool stats)
 {
+    m_nTableBits = tableBits;
+    m_bStats = stats;
+    g_metrics = metrics;
+
     hooker->RequestSharedHook<API::Functions::_ZN16CGameObjectArrayC1Ei, void>(
     +[](bool before, CGameObjectArray* pThis)
     {
@@ -48,54 +59,68 @@ GameObjectLookup::GameObjectLookup(Services::HooksProxy* hooker)
         (+[](void* p, uint32_t id) -> uint8_t { return GameObjectLookup::Delete(p, id, nullptr); });
     hooker->RequestExclusiveHook<API::Functions::_ZN16CGameObjectArray13GetGameObjectEjPP11CGameObject>
         (GameObjectLookup::GetGameObject);
+
+    if (m_bStats)
+    {
+        Services::Resamplers::ResamplerFuncPtr resampler = &Services::Resamplers::template Sum<uint64_t>;
+        metrics->SetResampler("GameObjectLookup", resampler, std::chrono::seconds(1));
+
+        hooker->RequestSharedHook<API::Functions::_ZN21CServerExoAppInternal8MainLoopEv, int32_t>(
+        +[](bool before, CServerExoAppInternal*)
+        {
+            if (before)
+                GameObjectLookup::PushStatistics();
+        });
+    }
 }
 
 // DO NOT REARRANGE
-CGameObject*              GameObjectLookup::m_pCacheObjects[L0CacheSize];
-uint32_t                  GameObjectLookup::m_nCacheIds[L0CacheSize];
-uint32_t                  GameObjectLookup::m_nArraySize;
-uint32_t                  GameObjectLookup::m_nNextObjectArrayID[2];
-uint32_t                  GameObjectLookup::m_nNextCharArrayID[2];
-GameObjectLookup::ObjectNode*  GameObjectLookup::m_pArray;
-uint8_t*                  GameObjectLookup::m_pArrayUnaligned;
+GameObjectLookup::Bucket*       GameObjectLookup::m_pArray;
+uint32_t                        GameObjectLookup::m_nArrayMask;
+bool                            GameObjectLookup::m_bStats;
+uint32_t                        GameObjectLookup::m_nNextObjectArrayID[2];
+uint32_t                        GameObjectLookup::m_nNextCharArrayID[2];
+uint32_t                        GameObjectLookup::m_nTableBits;
+GameObjectLookup::Statistics    GameObjectLookup::m_stats;
+
 
 enum { InternalObject = 0, ExternalObject = 1};
 enum { Success = 0, BadId = 1, NullGameObject = 4 };
 
 void GameObjectLookup::Initialize(uint32_t nLogGameObjectCache)
 {
-    m_nArraySize = (1 << nLogGameObjectCache);
+    const uint32_t bits = m_nTableBits ? m_nTableBits : nLogGameObjectCache;
+    const uint32_t arraySize = 1u << bits;
+    m_nArrayMask = arraySize - 1;
 
-    // Make sure the allocation is properly aligned on a 4k page boundary
-    const size_t array_size = m_nArraySize * sizeof(ObjectNode);
-    m_pArrayUnaligned = new uint8_t[array_size + 0x1000];
-    m_pArray = (ObjectNode*)(((uintptr_t)m_pArrayUnaligned + 0xFFF) & ~(0xFFFull));
-
-    memset(m_pArray, 0, array_size);
-    for (uint32_t i = 0; i < m_nArraySize; i++)
+    m_pArray = new Bucket[arraySize];
+    for (uint32_t i = 0; i < arraySize; i++)
     {
-        for (uint32_t j = 0; j < ObjectsInNode; j++)
+        memset(&m_pArray[i], 0, sizeof(Bucket));
+        for (uint32_t j = 0; j < ObjectsInBucket; j++)
             m_pArray[i].m_objectId[j] = Constants::OBJECT_INVALID;
     }
 
-    for (uint32_t i = 0; i < L0CacheSize; i++)
-        m_nCacheIds[i] = Constants::OBJECT_INVALID;
+    m_stats = {};
 
     m_nNextObjectArrayID[InternalObject] = 0x00000000;
     m_nNextCharArrayID[InternalObject]   = 0x7FFFFFFF;
     m_nNextObjectArrayID[ExternalObject] = 0x80000000;
     m_nNextCharArrayID[ExternalObject]   = 0xFFFFFFFF;
+
+    LOG_INFO("Object lookup table has %u buckets of %u objects", arraySize, ObjectsInBucket);
 }
 
 
 void GameObjectLookup::Finalize()
 {
-    for (uint32_t index = 0; index < m_nArraySize; index++)
+    for (uint32_t index = 0; index <= m_nArrayMask; index++)
     {
-        while (m_pArray[index].m_objectPtr[0])
+        while (m_pArray[index].m_count)
             delete m_pArray[index].m_objectPtr[0];
     }
-    delete[] m_pArrayUnaligned;
+    delete[] m_pArray;
+    m_pArray = nullptr;
 }
 
 uint32_t GameObjectLookup::GetNextID(void*, BOOL bInternal, BOOL bCharacter)
@@ -118,35 +143,55 @@ void GameObjectLookup::SetNextCharArrayID(void*, int32_t nList, uint32_t nVal)
     SyncWithGameGOA();
 }
 
+GameObjectLookup::Bucket* GameObjectLookup::NewBucket()
+{
+    auto* bucket = new Bucket();
+    for (uint32_t i = 0; i < ObjectsInBucket; i++)
+        bucket->m_objectId[i] = Constants::OBJECT_INVALID;
+    m_stats.m_overflowBuckets++;
+    return bucket;
+}
+
+int32_t GameObjectLookup::FindInBucket(const Bucket* bucket, uint32_t id)
+{
+    // Empty slots hold OBJECT_INVALID, which is never looked up, so all eight IDs can be compared blindly.
+    const __m128i needle = _mm_set1_epi32(static_cast<int32_t>(id));
+    const __m128i low    = _mm_load_si128(reinterpret_cast<const __m128i*>(&bucket->m_objectId[0]));
+    const __m128i high   = _mm_load_si128(reinterpret_cast<const __m128i*>(&bucket->m_objectId[4]));
+
+    const int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(low, needle))) |
+                    (_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(high, needle))) << 4);
+
+    return mask ? __builtin_ctz(mask) : -1;
+}
+
 uint8_t GameObjectLookup::AddObjectAtPos(void*, uint32_t id, CGameObject *ptr)
 {
     if (!ptr)
         return NullGameObject;
 
-    ObjectNode *node = &m_pArray[id & (m_nArraySize-1)];
+    Bucket *bucket = &m_pArray[id & m_nArrayMask];
     while (true)
     {
-        for (uint32_t i = 0; i < ObjectsInNode; i++)
-        {
-            if (node->m_objectId[i] == id)
-                return BadId;
+        if (FindInBucket(bucket, id) >= 0)
+            return BadId;
 
-            if (node->m_objectPtr[i] == nullptr)
+        // Buckets are kept packed, so only the last one in the chain can have room.
+        if (bucket->m_overflow == nullptr)
+        {
+            if (bucket->m_count == ObjectsInBucket)
             {
-                node->m_objectPtr[i] = ptr;
-                node->m_objectId[i] = id;
-                node->m_count++;
-                return Success;
+                bucket->m_overflow = NewBucket();
+                bucket = bucket->m_overflow;
             }
+
+            bucket->m_objectPtr[bucket->m_count] = ptr;
+            bucket->m_objectId[bucket->m_count] = id;
+            bucket->m_count++;
+            m_stats.m_objects++;
+            return Success;
         }
-        if (node->m_nextNode == nullptr)
-        {
-            node->m_nextNode = new ObjectNode();
-            memset(node->m_nextNode, 0, sizeof(*node->m_nextNode));
-            for (uint32_t i = 0; i < ObjectsInNode; i++)
-                node->m_nextNode->m_objectId[i] = Constants::OBJECT_INVALID;
-        }
-        node = node->m_nextNode;
+        bucket = bucket->m_overflow;
     }
 }
 
@@ -183,72 +228,45 @@ uint8_t GameObjectLookup::Delete(void*, uint32_t id, CGameObject** ptr)
     if (id == Constants::OBJECT_INVALID)
         return BadId;
 
-    // Clear the cache first
-    for (uint32_t i = 0; i < L0CacheSize; i++)
+    Bucket *bucket = &m_pArray[id & m_nArrayMask];
+    int32_t index;
+    while ((index = FindInBucket(bucket, id)) < 0)
     {
-        if (m_nCacheIds[i] == id)
-            m_nCacheIds[i] = Constants::OBJECT_INVALID;
+        bucket = bucket->m_overflow;
+        if (bucket == nullptr)
+            return BadId;
     }
 
-    ObjectNode *node = &m_pArray[id & (m_nArraySize-1)], *prev = nullptr;
-    while (node != nullptr)
+    if (ptr) *ptr = bucket->m_objectPtr[index];
+
+    //
+    // Fill the hole with the very last entry of the chain to keep every bucket packed
+    //
+    Bucket *last = bucket, *secondlast = nullptr;
+    while (last->m_overflow)
     {
-        for (uint32_t i = 0; i < ObjectsInNode; i++)
-        {
-            if (node->m_objectId[i] == id)
-            {
-                if (ptr) *ptr = node->m_objectPtr[i];
-                //
-                // Pack up the index every time we delete a node to keep optimal lookup perf
-                //
-                // 1. Removed last entry in a node
-                if (node->m_count == 1 && prev != nullptr) // never delete root node
-                {
-                    prev->m_nextNode = node->m_nextNode;
-                    delete node;
-                }
-                // 2. We have another node in the chain. Take the last node's last entry
-                else if (node->m_nextNode != nullptr)
-                {
-                    ObjectNode *last = node->m_nextNode, *secondlast = node;
-                    while (last->m_nextNode)
-                    {
-                        secondlast = last;
-                        last = last->m_nextNode;
-                    }
-                    last->m_count--;
-                    node->m_objectPtr[i] = last->m_objectPtr[last->m_count];
-                    node->m_objectId[i]  = last->m_objectId[last->m_count];
-                    if (last->m_count == 0)
-                    {
-                        secondlast->m_nextNode = nullptr;
-                        delete last;
-                    }
-                    else
-                    {
-                        last->m_objectPtr[last->m_count] = nullptr;
-                        last->m_objectId[last->m_count]  = Constants::OBJECT_INVALID;
-                    }
-                }
-                // 3. Removed an in the last chain link
-                else
-                {
-                    node->m_count--;
-                    node->m_objectPtr[i] = node->m_objectPtr[node->m_count];
-                    node->m_objectId[i]  = node->m_objectId[node->m_count];
-                    node->m_objectPtr[node->m_count] = nullptr;
-                    node->m_objectId[node->m_count] = Constants::OBJECT_INVALID;
-                }
-                return Success;
-            }
-        }
-        prev = node;
-        node = node->m_nextNode;
+        secondlast = last;
+        last = last->m_overflow;
     }
-    return BadId;
+
+    last->m_count--;
+    bucket->m_objectPtr[index] = last->m_objectPtr[last->m_count];
+    bucket->m_objectId[index]  = last->m_objectId[last->m_count];
+    last->m_objectPtr[last->m_count] = nullptr;
+    last->m_objectId[last->m_count]  = Constants::OBJECT_INVALID;
+
+    // Never delete the root bucket
+    if (last->m_count == 0 && secondlast != nullptr)
+    {
+        secondlast->m_overflow = nullptr;
+        delete last;
+        m_stats.m_overflowBuckets--;
+    }
+
+    m_stats.m_objects--;
+    return Success;
 }
 
-#pragma GCC optimize ("unroll-loops")
 #define PREFETCH(a) __builtin_prefetch(a, 0, 0)
 uint8_t GameObjectLookup::GetGameObject(void*, uint32_t id, CGameObject** ptr)
 {
@@ -256,61 +274,68 @@ uint8_t GameObjectLookup::GetGameObject(void*, uint32_t id, CGameObject** ptr)
     // The optimization should target the average case where the object does exist.
     if (id != Constants::OBJECT_INVALID)
     {
-        // We first check our first level cache for the mappings. However, while
-        // we're checking the logic there, we can fetch the required node from
-        // the main memory into the CPU L1 cache. If our own cache does not contain
-        // the mapping, we won't have to wait on a CPU cache miss later.
-        ObjectNode *node = &m_pArray[id & (m_nArraySize-1)];
-        PREFETCH(node);
-
-        // Check our first level cache first
-        for (uint32_t i = 0; i < L0CacheSize; i++)
+        const Bucket *bucket = &m_pArray[id & m_nArrayMask];
+        // The pointers live on the second cache line of the bucket, get it on its way while the IDs are compared.
+        PREFETCH(&bucket->m_objectPtr[0]);
+
+        uint32_t probes = 0;
+        do
         {
-            if (m_nCacheIds[i] == id)
+            probes++;
+            const int32_t index = FindInBucket(bucket, id);
+            if (index >= 0)
             {
-                *ptr = m_pCacheObjects[i];
+                *ptr = bucket->m_objectPtr[index];
                 PREFETCH(*ptr);
 
-                // Shift both arrays to the right to make the 0th entry available
-                if (i != 0)
+                if (m_bStats)
                 {
-                    memmove(&m_nCacheIds[1],     &m_nCacheIds[0],     i * sizeof(m_nCacheIds[0]));
-                    memmove(&m_pCacheObjects[1], &m_pCacheObjects[0], i * sizeof(m_pCacheObjects[0]));
-                    m_nCacheIds[0] = id;
-                    m_pCacheObjects[0] = *ptr;
+                    m_stats.m_hits++;
+                    m_stats.m_probes += probes;
                 }
                 return Success;
             }
-        }
+            bucket = bucket->m_overflow;
+        } while (bucket != nullptr);
 
-        do
-        {
-            // Another PREFETCH(node->m_nextNode) here could help in cases where we're likely to have
-            // multiple chained nodes for this index. However, that's an edge case (just increase cache size!)
-            // and we're trying to optimize for the average case when the cache size is adequate.
-            for (uint32_t i = 0; i < ObjectsInNode; i++)
-            {
-                if (node->m_objectId[i] == id)
-                {
-                    *ptr = node->m_objectPtr[i];
-                    PREFETCH(*ptr);
-
-                    const uint32_t moveelems = L0CacheSize - 1;
-                    memmove(&m_nCacheIds[1],     &m_nCacheIds[0],     moveelems * sizeof(m_nCacheIds[0]));
-                    memmove(&m_pCacheObjects[1], &m_pCacheObjects[0], moveelems * sizeof(m_pCacheObjects[0]));
-                    m_nCacheIds[0] = id;
-                    m_pCacheObjects[0] = *ptr;
-                    return Success;
-                }
-            }
-            node = node->m_nextNode;
-        } while (node != nullptr);
+        if (m_bStats)
+            m_stats.m_probes += probes;
     }
 
+    if (m_bStats)
+        m_stats.m_misses++;
+
     *ptr = NULL;
     return BadId;
 }
 
+void GameObjectLookup::PushStatistics()
+{
+    using namespace std::chrono;
+    static time_point<steady_clock> s_lastUpdate;
+    static Statistics s_lastStats;
+
+    const auto now = steady_clock::now();
+    if (now - s_lastUpdate < seconds(1))
+        return;
+    s_lastUpdate = now;
+
+    g_metrics->Push("GameObjectLookup",
+    {
+        { "Hits", std::to_string(m_stats.m_hits - s_lastStats.m_hits) },
+        { "Misses", std::to_string(m_stats.m_misses - s_lastStats.m_misses) },
+        { "Probes", std::to_string(m_stats.m_probes - s_lastStats.m_probes) },
+    });
+
+    g_metrics->Push("GameObjectLookupSize",
+    {
+        { "Objects", std::to_string(m_stats.m_objects) },
+        { "OverflowBuckets", std::to_string(m_stats.m_overflowBuckets) },
+    });
+
+    s_lastStats = m_stats;
+}
+
 void GameObjectLookup::SyncWithGameGOA()
 {
     if (auto* pGameObjectArray = Globals::AppManager()->m_pServerExoApp->GetObjectArray())
@@ -8,28 +8,42 @@ namespace Optimizations {
 class GameObjectLookup
 {
 public:
-    GameObjectLookup(NWNXLib::Services::HooksProxy* hooker);
+    GameObjectLookup(NWNXLib::Services::HooksProxy* hooker, NWNXLib::Services::MetricsProxy* metrics,
+                     uint32_t tableBits, bool stats);
 
-    static constexpr uint32_t ObjectsInNode = 4;
-    static constexpr uint32_t L0CacheSize = 5;
+    static constexpr uint32_t ObjectsInBucket = 8;
 private:
 
-    struct ObjectNode
+    // Object IDs are handed out sequentially, so the low bits pick the bucket directly and the
+    // remaining high bits act as a generation tag telling apart the IDs that share a bucket.
+    // The IDs are scanned with SIMD compares; the pointers sit on the adjacent cache line.
+    struct alignas(64) Bucket
     {
-        CGameObject* m_objectPtr[ObjectsInNode];
-        uint32_t     m_objectId[ObjectsInNode];
-        ObjectNode*  m_nextNode;
+        uint32_t     m_objectId[ObjectsInBucket];
+        Bucket*      m_overflow;
         uint32_t     m_count;
-        uint8_t      m_padding[4]; // For cache line alignment
+        uint8_t      m_padding[20]; // For cache line alignment
+        CGameObject* m_objectPtr[ObjectsInBucket];
     };
+    static_assert(sizeof(Bucket) == 128, "Bucket must span exactly two cache lines");
 
-    static CGameObject* m_pCacheObjects[L0CacheSize];
-    static uint32_t     m_nCacheIds[L0CacheSize];
-    static uint32_t     m_nArraySize;
+    struct Statistics
+    {
+        uint64_t m_hits;
+        uint64_t m_misses;
+        uint64_t m_probes;
+        uint64_t m_overflowBuckets;
+        uint64_t m_objects;
+    };
+
+    // DO NOT REARRANGE
+    static Bucket*      m_pArray;
+    static uint32_t     m_nArrayMask;
+    static bool         m_bStats;
     static uint32_t     m_nNextObjectArrayID[2];
     static uint32_t     m_nNextCharArrayID[2];
-    static ObjectNode*  m_pArray;
-    static uint8_t*     m_pArrayUnaligned;
+    static uint32_t     m_nTableBits;
+    static Statistics   m_stats;
 
     static void Initialize(uint32_t nLogGameObjectCache);
     static void Finalize();
@@ -42,6 +56,9 @@ private:
     static uint8_t Delete(void*, uint32_t id, CGameObject** ptr);
     static uint8_t GetGameObject(void*, uint32_t id, CGameObject** ptr);
 
+    static Bucket* NewBucket();
+    static int32_t FindInBucket(const Bucket* bucket, uint32_t id);
+    static void PushStatistics();
     static void SyncWithGameGOA();
 };
 
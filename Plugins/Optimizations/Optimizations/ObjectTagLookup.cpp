@@ -1,19 +1,24 @@
 #include "Optimizations/ObjectTagLookup.hpp"
 
 #include "Services/Hooks/Hooks.hpp"
-#include "Services/Tasks/Tasks.hpp"
 #include "API/Functions.hpp"
 #include "API/Constants.hpp"
 #include "API/CGameObject.hpp"
 #include "API/CGameObjectArray.hpp"
 #include "Utils.hpp"
 
+#include <cstring>
+
 namespace Optimizations {
 
 using namespace NWNXLib;
 using namespace NWNXLib::API;
 
-std::unordered_map<std::string, std::vector<uint32_t>> ObjectTagLookup::m_TagLookupMap;
+std::unordered_map<std::string_view, std::unique_ptr<ObjectTagLookup::TagEntry>> ObjectTagLookup::m_TagLookupMap;
+std::unordered_map<uint32_t, ObjectTagLookup::ObjectPosition> ObjectTagLookup::m_ObjectPositions;
+
+static constexpr size_t MaxTagLength = 64;
+static constexpr uint32_t NoTypeIndex = 0xFFFFFFFF;
 
 ObjectTagLookup::ObjectTagLookup(Services::HooksProxy* hooker)
 {
@@ -30,25 +35,111 @@ ObjectTagLookup::ObjectTagLookup(Services::HooksProxy* hooker)
         (ObjectTagLookup::FindTagPositionInTable);
 }
 
+ObjectTagLookup::ObjectList* ObjectTagLookup::TagEntry::GetTypeList(int32_t nObjectType)
+{
+    for (auto& typeList : m_objectsByType)
+    {
+        if (typeList.first == nObjectType)
+            return &typeList.second;
+    }
+    return nullptr;
+}
+
+std::string_view ObjectTagLookup::GetTagKey(const CExoString& sTag)
+{
+    // Same as sTag.Left(64), without the copy.
+    if (!sTag.m_sString)
+        return {};
+    return std::string_view(sTag.m_sString, strnlen(sTag.m_sString, MaxTagLength));
+}
+
+ObjectTagLookup::TagEntry* ObjectTagLookup::FindTagEntry(const CExoString& sTag)
+{
+    auto it = m_TagLookupMap.find(GetTagKey(sTag));
+    return it != m_TagLookupMap.end() ? it->second.get() : nullptr;
+}
+
+void ObjectTagLookup::RemoveObject(uint32_t oidObject, const ObjectPosition& position)
+{
+    // Swap the last entry into the hole and fix up its back-index.
+    auto swapOut = [oidObject](ObjectList& list, uint32_t index, uint32_t ObjectPosition::*field)
+    {
+        const uint32_t oidLast = list.back();
+        list[index] = oidLast;
+        list.pop_back();
+        if (oidLast != oidObject)
+            m_ObjectPositions[oidLast].*field = index;
+    };
+
+    TagEntry* entry = position.m_entry;
+    swapOut(entry->m_objects, position.m_index, &ObjectPosition::m_index);
+
+    if (position.m_typeIndex != NoTypeIndex)
+    {
+        if (auto* typeList = entry->GetTypeList(position.m_objectType))
+            swapOut(*typeList, position.m_typeIndex, &ObjectPosition::m_typeIndex);
+    }
+    else
+    {
+        entry->m_untypedCount--;
+    }
+
+    m_ObjectPositions.erase(oidObject);
+
+    if (entry->m_objects.empty())
+        m_TagLookupMap.erase(std::string_view(entry->m_tag));
+}
+
 int32_t  ObjectTagLookup::AddObjectToLookupTable(void*, CExoString sTag, uint32_t oidObject)
 {
-    m_TagLookupMap[sTag.Left(64).CStr()].push_back(oidObject);
+    // An object is only ever listed under one tag.
+    auto existing = m_ObjectPositions.find(oidObject);
+    if (existing != m_ObjectPositions.end())
+        RemoveObject(oidObject, existing->second);
+
+    TagEntry* entry = FindTagEntry(sTag);
+    if (!entry)
+    {
+        auto newEntry = std::make_unique<TagEntry>();
+        newEntry->m_tag = std::string(GetTagKey(sTag));
+        entry = newEntry.get();
+        m_TagLookupMap.emplace(std::string_view(entry->m_tag), std::move(newEntry));
+    }
+
+    ObjectPosition position = { entry, static_cast<uint32_t>(entry->m_objects.size()), NoTypeIndex, -1 };
+    entry->m_objects.push_back(oidObject);
+
+    if (auto* go = Utils::GetGameObject(oidObject))
+    {
+        position.m_objectType = go->m_nObjectType;
+
+        auto* typeList = entry->GetTypeList(position.m_objectType);
+        if (!typeList)
+        {
+            entry->m_objectsByType.emplace_back(position.m_objectType, ObjectList());
+            typeList = &entry->m_objectsByType.back().second;
+        }
+        position.m_typeIndex = static_cast<uint32_t>(typeList->size());
+        typeList->push_back(oidObject);
+    }
+    else
+    {
+        LOG_DEBUG("Object 0x%08x was tagged '%s' before it existed, typed lookups of the tag will scan all objects.",
+                  oidObject, entry->m_tag);
+        entry->m_untypedCount++;
+    }
+
+    m_ObjectPositions[oidObject] = position;
     return true;
 }
 int32_t  ObjectTagLookup::RemoveObjectFromLookupTable(void*, CExoString sTag, uint32_t oidObject)
 {
-    try {
-        auto& vec = m_TagLookupMap.at(sTag.Left(64).CStr());
-        for (auto it = vec.begin(); it != vec.end(); ++it)
-        {
-            if (*it == oidObject)
-            {
-                vec.erase(it);
-                return true;
-            }
-        }
-    } catch (const std::out_of_range& oor) {}
-    return false;
+    auto it = m_ObjectPositions.find(oidObject);
+    if (it == m_ObjectPositions.end() || it->second.m_entry->m_tag != GetTagKey(sTag))
+        return false;
+
+    RemoveObject(oidObject, it->second);
+    return true;
 }
 
 uint32_t ObjectTagLookup::FindObjectByTagOrdinal(void*, CExoString & sTag, uint32_t nNth)
@@ -56,29 +147,36 @@ uint32_t ObjectTagLookup::FindObjectByTagOrdinal(void*, CExoString & sTag, uint3
     if (sTag.IsEmpty())
         return Constants::OBJECT_INVALID;
 
-    try {
-        return m_TagLookupMap.at(sTag.Left(64).CStr()).at(nNth);
-    } catch (const std::out_of_range& oor) {}
-    return Constants::OBJECT_INVALID;
+    auto* entry = FindTagEntry(sTag);
+    if (!entry || nNth >= entry->m_objects.size())
+        return Constants::OBJECT_INVALID;
+
+    return entry->m_objects[nNth];
 }
 
 uint32_t ObjectTagLookup::FindObjectByTagTypeOrdinal(void*, CExoString & sTag, int32_t nObjectType, uint32_t nNth)
 {
-    try {
-        auto& vec = m_TagLookupMap.at(sTag.Left(64).CStr());
-        for (auto it: vec)
+    auto* entry = FindTagEntry(sTag);
+    if (!entry)
+        return Constants::OBJECT_INVALID;
+
+    if (entry->m_untypedCount)
+    {
+        // Resolve the types now, as the game does.
+        for (auto oidObject : entry->m_objects)
         {
-            if (auto* go = Utils::GetGameObject(it))
-            {
-                if (go->m_nObjectType == nObjectType)
-                {
-                    if (nNth-- == 0)
-                        return it;
-                }
-            }
+            auto* go = Utils::GetGameObject(oidObject);
+            if (go && go->m_nObjectType == nObjectType && nNth-- == 0)
+                return oidObject;
         }
-    } catch (const std::out_of_range& oor) {}
-    return Constants::OBJECT_INVALID;
+        return Constants::OBJECT_INVALID;
+    }
+
+    auto* typeList = entry->GetTypeList(nObjectType);
+    if (!typeList || nNth >= typeList->size())
+        return Constants::OBJECT_INVALID;
+
+    return (*typeList)[nNth];
 }
 
 int32_t  ObjectTagLookup::FindTagPositionInTable(void*, char *)
@@ -3,9 +3,11 @@
 #include "API/Types.hpp"
 #include "Common.hpp"
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 #include <string>
+#include <string_view>
 
 namespace Optimizations {
 
@@ -16,7 +18,36 @@ public:
 
 private:
 
-    static std::unordered_map<std::string, std::vector<uint32_t>> m_TagLookupMap;
+    using ObjectList = std::vector<uint32_t>;
+
+    struct TagEntry
+    {
+        std::string m_tag;
+        ObjectList  m_objects;
+        // Only a handful of object types ever share a tag, so a flat list beats a map here.
+        std::vector<std::pair<int32_t, ObjectList>> m_objectsByType;
+        // Objects whose type wasn't known when they were added, typed lookups scan m_objects while there are any.
+        uint32_t m_untypedCount = 0;
+
+        ObjectList* GetTypeList(int32_t nObjectType);
+    };
+
+    // Where an object sits in its tag entry, so it can be swapped out in constant time.
+    struct ObjectPosition
+    {
+        TagEntry* m_entry;
+        uint32_t  m_index;
+        uint32_t  m_typeIndex;
+        int32_t   m_objectType;
+    };
+
+    // Keys are views into TagEntry::m_tag, so lookups can hash the CExoString buffer in place.
+    static std::unordered_map<std::string_view, std::unique_ptr<TagEntry>> m_TagLookupMap;
+    static std::unordered_map<uint32_t, ObjectPosition> m_ObjectPositions;
+
+    static std::string_view GetTagKey(const CExoString& sTag);
+    static TagEntry* FindTagEntry(const CExoString& sTag);
+    static void RemoveObject(uint32_t oidObject, const ObjectPosition& position);
 
     static int32_t  AddObjectToLookupTable(void*, CExoString, uint32_t);
     static int32_t  RemoveObjectFromLookupTable(void*, CExoString, uint32_t);
@@ -3,6 +3,7 @@
 #include "API/Functions.hpp"
 #include "Common.hpp"
 #include "ProfilerMacros.hpp"
+#include "Services/Commands/Commands.hpp"
 #include "Services/Config/Config.hpp"
 #include "Services/Events/Events.hpp"
 #include "Services/Hooks/Hooks.hpp"
@@ -16,6 +17,7 @@
 #include "Targets/ObjectEventHandlers.hpp"
 #include "Targets/Pathing.hpp"
 #include "Targets/Scripts.hpp"
+#include "Targets/TickPhases.hpp"
 #include "Timing.hpp"
 
 #include <queue>
@@ -129,6 +131,12 @@ Profiler::Profiler(const Plugin::CreateParams& params)
         m_scripts = std::make_unique<Scripts>(areaTimings, typeTimings, g_hooks, g_metrics);
     }
 
+    if (config->Get<bool>("ENABLE_TICK_PHASES", false))
+    {
+        const size_t historySize = config->Get<size_t>("TICK_PHASES_HISTORY", 16);
+        m_tickPhases = std::make_unique<TickPhases>(historySize, g_hooks, GetServices()->m_commands.get());
+    }
+
     g_tickrate = config->Get<bool>("ENABLE_TICKRATE", true);
 
     if (g_tickrate)
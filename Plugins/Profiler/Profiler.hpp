@@ -16,6 +16,7 @@ class ObjectAIUpdates;
 class ObjectEventHandlers;
 class Pathing;
 class Scripts;
+class TickPhases;
 
 class Profiler : public NWNXLib::Plugin
 {
@@ -32,6 +33,7 @@ private:
     std::unique_ptr<ObjectEventHandlers> m_objectEventHandlers;
     std::unique_ptr<Pathing> m_pathing;
     std::unique_ptr<Scripts> m_scripts;
+    std::unique_ptr<TickPhases> m_tickPhases;
 
     static void HandleTickrateReporting(const std::chrono::time_point<std::chrono::high_resolution_clock>& now);
     static void HandleRecalibration(const std::chrono::time_point<std::chrono::high_resolution_clock>& now);
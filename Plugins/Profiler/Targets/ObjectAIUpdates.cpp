@@ -11,7 +11,8 @@ using namespace NWNXLib;
 
 static Services::MetricsProxy* g_metrics;
 
-DECLARE_PROFILE_TARGET_FAST_SIMPLE(*g_metrics, AIUpdateArea, int32_t, CNWSArea*);
+// Shared, so the tick phases can hook area updates as well.
+DECLARE_PROFILE_TARGET_SIMPLE(*g_metrics, AIUpdateArea, int32_t, CNWSArea*);
 DECLARE_PROFILE_TARGET_FAST_SIMPLE(*g_metrics, AIUpdateAreaOfEffect, void, CNWSAreaOfEffectObject*);
 DECLARE_PROFILE_TARGET_FAST_SIMPLE(*g_metrics, AIUpdateCreature, void, CNWSCreature*);
 DECLARE_PROFILE_TARGET_FAST_SIMPLE(*g_metrics, AIUpdateDoor, void, CNWSDoor*);
@@ -28,7 +29,7 @@ ObjectAIUpdates::ObjectAIUpdates(NWNXLib::Services::HooksProxy* hooker,
 {
     g_metrics = metrics;
 
-    DEFINE_PROFILER_TARGET_FAST(hooker,
+    DEFINE_PROFILER_TARGET(hooker,
         AIUpdateArea, API::Functions::_ZN8CNWSArea8AIUpdateEv,
         int32_t, CNWSArea*);
 
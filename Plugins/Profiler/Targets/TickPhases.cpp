@@ -0,0 +1,298 @@
+#include "Targets/TickPhases.hpp"
+
+#include "API/Functions.hpp"
+#include "Services/Commands/Commands.hpp"
+#include "Services/Hooks/Hooks.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <vector>
+
+namespace Profiler {
+
+using namespace NWNXLib;
+using namespace NWNXLib::Services;
+
+namespace {
+
+using Clock = std::chrono::high_resolution_clock;
+
+enum Phase : uint8_t
+{
+    Other,
+    NWNX,
+    Network,
+    AIMaster,
+    Areas,
+    Scripts,
+    ClientUpdates,
+    PhaseCount
+};
+
+constexpr const char* PHASE_NAMES[PhaseCount] =
+{
+    "Other",
+    "NWNX",
+    "Network",
+    "AIMaster",
+    "Areas",
+    "Scripts",
+    "ClientUpdates"
+};
+
+struct TickRecord
+{
+    uint64_t m_tick;
+    std::time_t m_wallTime;
+    std::chrono::nanoseconds m_total;
+    std::array<std::chrono::nanoseconds, PhaseCount> m_phases;
+};
+
+constexpr uint8_t MAX_DEPTH = 32;
+
+}
+
+static bool s_inTick = false;
+static uint64_t s_tickCount = 0;
+static Clock::time_point s_tickStart;
+static Clock::time_point s_lastSwitch;
+static TickRecord s_current;
+
+// Phases nest (scripts run from inside area updates, etc.), so time is always charged to the
+// innermost phase only. The bottom of the stack is the phase the tick itself is in.
+static std::array<Phase, MAX_DEPTH> s_stack;
+static uint8_t s_depth = 0;
+static uint32_t s_overflow = 0;
+
+// The slowest ticks seen so far. Once full, a slower tick overwrites the fastest entry.
+static std::vector<TickRecord> s_slowest;
+static size_t s_capacity;
+static size_t s_fastestIndex = 0;
+
+static void ChargeCurrentPhase(const Clock::time_point now)
+{
+    s_current.m_phases[s_stack[s_depth - 1]] += now - s_lastSwitch;
+    s_lastSwitch = now;
+}
+
+static void EnterPhase(const Phase phase)
+{
+    if (!s_inTick)
+        return;
+
+    if (s_depth >= MAX_DEPTH)
+    {
+        ++s_overflow;
+        return;
+    }
+
+    ChargeCurrentPhase(Clock::now());
+    s_stack[s_depth++] = phase;
+}
+
+static void LeavePhase()
+{
+    if (!s_inTick)
+        return;
+
+    if (s_overflow)
+    {
+        --s_overflow;
+        return;
+    }
+
+    if (s_depth > 1)
+    {
+        ChargeCurrentPhase(Clock::now());
+        --s_depth;
+    }
+}
+
+static void RecordTick(const TickRecord& record)
+{
+    if (s_capacity == 0)
+        return;
+
+    if (s_slowest.size() < s_capacity)
+    {
+        s_slowest.push_back(record);
+    }
+    else if (record.m_total > s_slowest[s_fastestIndex].m_total)
+    {
+        s_slowest[s_fastestIndex] = record;
+    }
+    else
+    {
+        return;
+    }
+
+    s_fastestIndex = 0;
+    for (size_t i = 1; i < s_slowest.size(); ++i)
+    {
+        if (s_slowest[i].m_total < s_slowest[s_fastestIndex].m_total)
+            s_fastestIndex = i;
+    }
+}
+
+static double ToMilliseconds(const std::chrono::nanoseconds ns)
+{
+    return std::chrono::duration<double, std::milli>(ns).count();
+}
+
+static void DumpSlowestTicks()
+{
+    if (s_slowest.empty())
+    {
+        LOG_INFO("No ticks recorded yet.");
+        return;
+    }
+
+    std::vector<const TickRecord*> sorted;
+    sorted.reserve(s_slowest.size());
+    for (auto& record : s_slowest)
+    {
+        sorted.push_back(&record);
+    }
+
+    std::sort(sorted.begin(), sorted.end(),
+        [](const TickRecord* a, const TickRecord* b) { return a->m_total > b->m_total; });
+
+    LOG_INFO("Slowest %u of %llu ticks:", sorted.size(), s_tickCount);
+
+    for (auto* record : sorted)
+    {
+        char timeBuffer[32];
+        std::tm tm;
+        std::strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M:%S", localtime_r(&record->m_wallTime, &tm));
+
+        std::string phases;
+        for (uint8_t i = 0; i < PhaseCount; ++i)
+        {
+            phases += tfm::format(" | %s: %.3f ms", PHASE_NAMES[i], ToMilliseconds(record->m_phases[i]));
+        }
+
+        LOG_INFO("Tick %llu at %s: %.3f ms%s", record->m_tick, timeBuffer, ToMilliseconds(record->m_total), phases);
+    }
+}
+
+template <Phase P, typename ... Params>
+static void PhaseLanding(bool before, Params ...)
+{
+    if (before)
+    {
+        EnterPhase(P);
+    }
+    else
+    {
+        LeavePhase();
+    }
+}
+
+// Phases share their hooks with the other profiler targets. A function another plugin hooks
+// exclusively can't be shared, its time is then counted in the phase it is called from.
+template <uintptr_t Address, typename Ret, Phase P, typename ... Params>
+static void HookPhase(HooksProxy* hooker, const char* function)
+{
+    auto* storage = hooker->FindHookStorageByAddress(Address);
+    if (storage && storage->m_type == Hooks::Type::EXCLUSIVE)
+    {
+        LOG_WARNING("%s is hooked exclusively elsewhere, its time is not counted as %s.", function, PHASE_NAMES[P]);
+        return;
+    }
+
+    hooker->RequestSharedHook<Address, Ret>(&PhaseLanding<P, Params ...>);
+}
+
+TickPhases::TickPhases(const size_t historySize,
+    HooksProxy* hooker,
+    CommandsProxy* commands)
+{
+    s_capacity = historySize;
+    s_slowest.reserve(historySize);
+
+    // TickBegin runs before and TickNWNXEnd after every other MainLoop handler, so the NWNX phase
+    // covers the work all plugins do around the game's own tick.
+    hooker->RequestSharedHook<API::Functions::_ZN21CServerExoAppInternal8MainLoopEv, int32_t>(&TickBegin, Hooks::Order::EARLIEST);
+    hooker->RequestSharedHook<API::Functions::_ZN21CServerExoAppInternal8MainLoopEv, int32_t>(&TickNWNXEnd, Hooks::Order::LATEST);
+
+    HookPhase<API::Functions::_ZN21CServerExoAppInternal21ConnectionLibMainLoopEv, void, Network,
+        CServerExoAppInternal*>(hooker, "CServerExoAppInternal::ConnectionLibMainLoop");
+    HookPhase<API::Functions::_ZN9CNetLayer21ProcessReceivedFramesEi, void, Network,
+        CNetLayer*, int32_t>(hooker, "CNetLayer::ProcessReceivedFrames");
+    HookPhase<API::Functions::_ZN15CServerAIMaster11UpdateStateEv, void, AIMaster,
+        CServerAIMaster*>(hooker, "CServerAIMaster::UpdateState");
+    HookPhase<API::Functions::_ZN8CNWSArea8AIUpdateEv, int32_t, Areas,
+        CNWSArea*>(hooker, "CNWSArea::AIUpdate");
+    HookPhase<API::Functions::_ZN15CVirtualMachine11ExecuteCodeEPiPciP31CVirtualMachineDebuggingContext, int32_t, Scripts,
+        CVirtualMachine*, int32_t*, char*, int32_t, CVirtualMachineDebuggingContext*>(hooker, "CVirtualMachine::ExecuteCode");
+    HookPhase<API::Functions::_ZN21CServerExoAppInternal23UpdateClientGameObjectsEi, void, ClientUpdates,
+        CServerExoAppInternal*, int32_t>(hooker, "CServerExoAppInternal::UpdateClientGameObjects");
+
+    commands->RegisterCommand("tickphases", [](std::string&, std::string& args)
+    {
+        if (args == "reset")
+        {
+            s_slowest.clear();
+            s_fastestIndex = 0;
+            LOG_INFO("Cleared the slowest tick history.");
+            return;
+        }
+
+        DumpSlowestTicks();
+    });
+}
+
+void TickPhases::TickBegin(bool before, CServerExoAppInternal*)
+{
+    const auto now = Clock::now();
+
+    if (!before)
+    {
+        if (!s_inTick)
+            return;
+
+        // The game's part of the tick is done, the handlers after it are NWNX again.
+        ChargeCurrentPhase(now);
+        s_stack[0] = NWNX;
+        s_depth = 1;
+        return;
+    }
+
+
+    s_current = {};
+    s_current.m_tick = ++s_tickCount;
+    s_current.m_wallTime = std::time(nullptr);
+    s_tickStart = now;
+    s_lastSwitch = now;
+
+    s_stack[0] = NWNX;
+    s_depth = 1;
+    s_overflow = 0;
+    s_inTick = true;
+}
+
+void TickPhases::TickNWNXEnd(bool before, CServerExoAppInternal*)
+{
+    if (!s_inTick)
+        return;
+
+    const auto now = Clock::now();
+    ChargeCurrentPhase(now);
+
+    if (before)
+    {
+        // Everything NWNX does up front is done, the rest of the tick until TickBegin runs again belongs to the game.
+        s_stack[0] = Other;
+        s_depth = 1;
+    }
+    else
+    {
+        s_inTick = false;
+        s_current.m_total = now - s_tickStart;
+        RecordTick(s_current);
+    }
+}
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Common.hpp"
+#include "Services/Hooks/Hooks.hpp"
+
+namespace Profiler {
+
+// Attributes the wall time of each server tick to the phases it is spent in, and keeps
+// the breakdown of the slowest ticks around so they can be dumped with the 'tickphases'
+// server console command.
+class TickPhases
+{
+public:
+    TickPhases(const size_t historySize,
+        NWNXLib::Services::HooksProxy* hooker,
+        NWNXLib::Services::CommandsProxy* commands);
+
+private:
+    static void TickBegin(bool, CServerExoAppInternal*);
+    static void TickNWNXEnd(bool, CServerExoAppInternal*);
+};
+
+}
@@ -417,18 +417,20 @@ void Race::SavingThrowRollHook(
     if (before)
     {
         savingThrowBonusLimit = Globals::AppManager()->m_pServerExoApp->GetSavingThrowBonusLimit();
-        auto nRace = pCreature->m_pStats->m_nRace;
-        auto sRace = std::to_string(nRace);
-        auto tgtCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(oidSaveVersus);
-        auto modSaveBonus = g_plugin->m_RaceSave[nRace][nSaveType] + g_plugin->m_RaceSave[nRace][SavingThrow::All];
+        auto *pMods = GetCombatModifiers(pCreature->m_pStats->m_nRace);
+        if (!pMods || nSaveType > SavingThrow::MAX)
+            return;
+
+        auto modSaveBonus = pMods->m_Save[nSaveType] + pMods->m_Save[SavingThrow::All];
         uint8_t modSaveVSRaceBonus = 0;
-        if (tgtCreature)
+        auto tgtCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(oidSaveVersus);
+        if (tgtCreature && tgtCreature->m_pStats->m_nRace < pMods->m_SaveVsRace[nSaveType].size())
         {
-            modSaveVSRaceBonus = g_plugin->m_RaceSaveVsRace[nRace][nSaveType][tgtCreature->m_pStats->m_nRace] +
-                                 g_plugin->m_RaceSaveVsRace[nRace][SavingThrow::All][tgtCreature->m_pStats->m_nRace];
+            modSaveVSRaceBonus = pMods->m_SaveVsRace[nSaveType][tgtCreature->m_pStats->m_nRace] +
+                                 pMods->m_SaveVsRace[SavingThrow::All][tgtCreature->m_pStats->m_nRace];
         }
-        auto modSaveVSTypeBonus = g_plugin->m_RaceSaveVsType[nRace][nSaveType][nSpecificType] +
-                                  g_plugin->m_RaceSaveVsType[nRace][SavingThrow::All][nSpecificType];
+        auto modSaveVSTypeBonus = pMods->m_SaveVsType[nSaveType][nSpecificType] +
+                                  pMods->m_SaveVsType[SavingThrow::All][nSpecificType];
         server->SetSavingThrowBonusLimit(
                 server->GetSavingThrowBonusLimit() + modSaveBonus + modSaveVSRaceBonus + modSaveVSTypeBonus);
     }
@@ -445,12 +447,15 @@ void Race::GetWeaponPowerHook(bool before, CNWSCreature *pCreature, CNWSObject *
     if (before)
     {
         attackBonusLimit = Globals::AppManager()->m_pServerExoApp->GetAttackBonusLimit();
-        auto nRace = pCreature->m_pStats->m_nRace;
-        auto modABBonus = g_plugin->m_RaceAB[nRace];
+        auto *pMods = GetCombatModifiers(pCreature->m_pStats->m_nRace);
+        if (!pMods)
+            return;
+
+        auto modABBonus = pMods->m_AB;
         uint8_t modABVSRaceBonus = 0;
         auto tgtCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(pObject->m_idSelf);
-        if (tgtCreature)
-            modABVSRaceBonus = g_plugin->m_RaceABVsRace[nRace][tgtCreature->m_pStats->m_nRace];
+        if (tgtCreature && tgtCreature->m_pStats->m_nRace < pMods->m_ABVsRace.size())
+            modABVSRaceBonus = pMods->m_ABVsRace[tgtCreature->m_pStats->m_nRace];
         server->SetAttackBonusLimit(server->GetAttackBonusLimit() + modABBonus + modABVSRaceBonus);
     }
     else
@@ -480,10 +485,13 @@ void Race::ApplyEffectHook(bool before, CNWSEffectListHandler*, CNWSObject *pObj
             //AC, AB, Skill, Dmg increases and decreases
             default: nRaceParam = 2; break;
         }
-        std::vector<uint16_t> vChild = g_plugin->m_ChildRaces[eff->m_nParamInteger[nRaceParam]];
+        auto nParentRace = eff->m_nParamInteger[nRaceParam];
+        if (nParentRace < 0 || nParentRace >= (int32_t)g_plugin->m_ChildRaces.size())
+            return;
+        const auto& vChild = g_plugin->m_ChildRaces[nParentRace];
         CGameEffect *effNew;
         int32_t i;
-        for(uint16_t & nChild : vChild)
+        for(const uint16_t & nChild : vChild)
         {
             effNew = new CGameEffect(true);
             effNew->m_nNumIntegers = eff->m_nNumIntegers;
@@ -540,21 +548,25 @@ void Race::GetTotalEffectBonusHook(
 
     if (before)
     {
-        auto nRace = pCreature->m_pStats->m_nRace;
-        auto sRace = std::to_string(nRace);
         if (nEffectBonusType == 1)
         {
                 attackBonusLimit = Globals::AppManager()->m_pServerExoApp->GetAttackBonusLimit();
-                auto modABBonus = g_plugin->m_RaceAB[nRace];
+                auto *pMods = GetCombatModifiers(pCreature->m_pStats->m_nRace);
+                if (!pMods)
+                    return;
+                auto modABBonus = pMods->m_AB;
                 uint8_t modABVSRaceBonus = 0;
-                if (tgtCreature)
-                    modABVSRaceBonus = g_plugin->m_RaceABVsRace[nRace][tgtCreature->m_pStats->m_nRace];
+                if (tgtCreature && tgtCreature->m_pStats->m_nRace < pMods->m_ABVsRace.size())
+                    modABVSRaceBonus = pMods->m_ABVsRace[tgtCreature->m_pStats->m_nRace];
                 server->SetAttackBonusLimit(server->GetAttackBonusLimit() + modABBonus + modABVSRaceBonus);
         }
         else if (nEffectBonusType == 5)
         {
             skillBonusLimit = Globals::AppManager()->m_pServerExoApp->GetSkillBonusLimit();
-            auto modSkillBonus = g_plugin->m_RaceSkill[nRace][nSkill];
+            auto *pMods = GetCombatModifiers(pCreature->m_pStats->m_nRace);
+            if (!pMods)
+                return;
+            auto modSkillBonus = pMods->m_Skill[nSkill];
             server->SetSkillBonusLimit(server->GetSkillBonusLimit() + modSkillBonus);
         }
     }
@@ -577,7 +589,11 @@ void Race::ResetFeatRemainingUsesHook(bool before, CNWSCreatureStats *pCreatureS
     auto nRace = pCreatureStats->m_nRace;
 
     // Check for any feat usage calcs
-    for (auto &raceFeatUsage : g_plugin->m_RaceFeatUsage[nRace])
+    auto raceFeatUsages = g_plugin->m_RaceFeatUsage.find(nRace);
+    if (raceFeatUsages == g_plugin->m_RaceFeatUsage.end())
+        return;
+
+    for (auto &raceFeatUsage : raceFeatUsages->second)
     {
         auto featId = raceFeatUsage.first;
         auto fuCharGen = raceFeatUsage.second.first;
@@ -607,9 +623,8 @@ void Race::ResolveInitiativeHook(CNWSCreature *pCreature)
             mod += Globals::Rules()->GetRulesetIntEntry("THUG_INITIATIVE_BONUS", 2);
 
         // Add racial bonus
-        auto nRace = pCreature->m_pStats->m_nRace;
-        auto sRace = std::to_string(nRace);
-        mod += g_plugin->m_RaceInitiative[nRace];
+        if (auto *pMods = GetCombatModifiers(pCreature->m_pStats->m_nRace))
+            mod += pMods->m_Initiative;
 
         pCreature->m_nInitiativeRoll = diceRoll + mod;
         auto *pPlayer = Globals::AppManager()->m_pServerExoApp->GetClientObjectByObjectId(pCreature->m_idSelf);
@@ -712,14 +727,14 @@ void Race::SetOrRestoreRace(bool before, CNWSCreatureStats *pCreatureStats, CNWS
     {
         if (pCreatureStats != nullptr)
         {
-            auto parentRace = g_plugin->m_RaceParent[pCreatureStats->m_nRace];
+            auto parentRace = GetParentRaceId(pCreatureStats->m_nRace);
             originalRace = pCreatureStats->m_nRace;
             if (parentRace != RacialType::Invalid)
                 pCreatureStats->m_nRace = parentRace;
         }
         if (pTgtCreatureStats != nullptr)
         {
-            auto versusParentRace = g_plugin->m_RaceParent[pTgtCreatureStats->m_nRace];
+            auto versusParentRace = GetParentRaceId(pTgtCreatureStats->m_nRace);
             originalTgtRace = pTgtCreatureStats->m_nRace;
             if (versusParentRace != RacialType::Invalid)
                 pTgtCreatureStats->m_nRace = versusParentRace;
@@ -769,7 +784,7 @@ int32_t Race::CheckItemRaceRestrictionsHook(CNWSCreature *pCreature, CNWSItem *p
         if (pItem->GetPassiveProperty(i)->m_nPropertyName == Constants::ItemProperty::UseLimitationRacialType)
         {
             auto raceToCheck = pItem->GetPassiveProperty(i)->m_nSubType;
-            if (nRace == raceToCheck || g_plugin->m_RaceParent[nRace] == raceToCheck)
+            if (nRace == raceToCheck || GetParentRaceId(nRace) == raceToCheck)
             {
                 return 1;
             }
@@ -787,10 +802,111 @@ void Race::LoadRaceInfoHook(bool before, CNWRules*)
 
     // Initialize the parent race to Invalid
     auto twoda = Globals::Rules()->m_p2DArrays->GetCached2DA("RACIALTYPES", true);
-    for (int raceId = 0; raceId < twoda->m_nNumRows; raceId++)
+    g_plugin->m_RaceParent.assign(twoda->m_nNumRows, RacialType::Invalid);
+    g_plugin->m_ChildRaces.assign(twoda->m_nNumRows, {});
+    g_plugin->m_CombatModifiersDirty = true;
+}
+
+uint16_t Race::GetParentRaceId(uint16_t raceId)
+{
+    return raceId < g_plugin->m_RaceParent.size() ? g_plugin->m_RaceParent[raceId] : (uint16_t)RacialType::Invalid;
+}
+
+const Race::CombatModifiers* Race::GetCombatModifiers(uint16_t raceId)
+{
+    if (g_plugin->m_CombatModifiersDirty)
+        CompileCombatModifiers();
+
+    return raceId < g_plugin->m_CombatModifiers.size() ? g_plugin->m_CombatModifiers[raceId].get() : nullptr;
+}
+
+void Race::CompileCombatModifiers()
+{
+    // Every race and versus race gets a slot, including any beyond racialtypes.2da.
+    size_t raceCount = g_plugin->m_RaceParent.size();
+    auto countRace = [&](uint16_t raceId) { raceCount = std::max(raceCount, size_t(raceId) + 1); };
+    for (auto &mod : g_plugin->m_RaceAB)         countRace(mod.first);
+    for (auto &mod : g_plugin->m_RaceInitiative) countRace(mod.first);
+    for (auto &mod : g_plugin->m_RaceSave)       countRace(mod.first);
+    for (auto &mod : g_plugin->m_RaceSaveVsType) countRace(mod.first);
+    for (auto &mod : g_plugin->m_RaceSkill)      countRace(mod.first);
+    for (auto &mod : g_plugin->m_RaceABVsRace)
+    {
+        countRace(mod.first);
+        for (auto &vsRace : mod.second)
+            countRace(vsRace.first);
+    }
+    for (auto &mod : g_plugin->m_RaceSaveVsRace)
+    {
+        countRace(mod.first);
+        for (auto &saveMod : mod.second)
+            for (auto &vsRace : saveMod.second)
+                countRace(vsRace.first);
+    }
+
+    auto &combatModifiers = g_plugin->m_CombatModifiers;
+    combatModifiers.clear();
+    combatModifiers.resize(raceCount);
+    auto getMods = [&](uint16_t raceId) -> CombatModifiers&
     {
-        g_plugin->m_RaceParent[raceId] = RacialType::Invalid;
+        auto &pMods = combatModifiers[raceId];
+        if (!pMods)
+        {
+            pMods = std::make_unique<CombatModifiers>();
+            pMods->m_ABVsRace.resize(raceCount);
+            for (auto &saveVsRace : pMods->m_SaveVsRace)
+                saveVsRace.resize(raceCount);
+        }
+        return *pMods;
+    };
+
+    for (auto &mod : g_plugin->m_RaceAB)
+        getMods(mod.first).m_AB = mod.second;
+    for (auto &mod : g_plugin->m_RaceInitiative)
+        getMods(mod.first).m_Initiative = mod.second;
+    for (auto &mod : g_plugin->m_RaceABVsRace)
+    {
+        for (auto &vsRace : mod.second)
+            getMods(mod.first).m_ABVsRace[vsRace.first] = vsRace.second;
+    }
+    for (auto &mod : g_plugin->m_RaceSave)
+    {
+        for (auto &saveMod : mod.second)
+        {
+            if (saveMod.first <= SavingThrow::MAX)
+                getMods(mod.first).m_Save[saveMod.first] = saveMod.second;
+        }
+    }
+    for (auto &mod : g_plugin->m_RaceSaveVsRace)
+    {
+        for (auto &saveMod : mod.second)
+        {
+            if (saveMod.first > SavingThrow::MAX)
+                continue;
+            for (auto &vsRace : saveMod.second)
+                getMods(mod.first).m_SaveVsRace[saveMod.first][vsRace.first] = vsRace.second;
+        }
     }
+    for (auto &mod : g_plugin->m_RaceSaveVsType)
+    {
+        for (auto &saveMod : mod.second)
+        {
+            if (saveMod.first > SavingThrow::MAX)
+                continue;
+            for (auto &vsType : saveMod.second)
+            {
+                if (vsType.first < 256)
+                    getMods(mod.first).m_SaveVsType[saveMod.first][vsType.first] = vsType.second;
+            }
+        }
+    }
+    for (auto &mod : g_plugin->m_RaceSkill)
+    {
+        for (auto &skillMod : mod.second)
+            getMods(mod.first).m_Skill[skillMod.first] = skillMod.second;
+    }
+
+    g_plugin->m_CombatModifiersDirty = false;
 }
 
 void Race::SetRaceModifier(int32_t raceId, RaceModifier raceMod, int32_t param1, int32_t param2, int32_t param3)
@@ -798,6 +914,7 @@ void Race::SetRaceModifier(int32_t raceId, RaceModifier raceMod, int32_t param1,
     auto raceNameText = Globals::Rules()->m_lstRaces[raceId].GetNameText();
     auto raceName = raceNameText.CStr();
     std::string sRace = std::to_string(raceId);
+    g_plugin->m_CombatModifiersDirty = true;
     switch (raceMod)
     {
         case AB:
@@ -936,6 +1053,12 @@ void Race::SetRaceModifier(int32_t raceId, RaceModifier raceMod, int32_t param1,
         }
         case RACE:
         {
+            if (raceId < 0 || raceId >= (int32_t)g_plugin->m_RaceParent.size() ||
+                param1 < 0 || param1 >= (int32_t)g_plugin->m_ChildRaces.size())
+            {
+                LOG_ERROR("%s: Parent race modifier improperly set.", raceName);
+                break;
+            }
             g_plugin->m_RaceParent[raceId] = param1;
             g_plugin->m_ChildRaces[param1].push_back(raceId);
             auto parentRaceName = Globals::Rules()->m_lstRaces[param1].GetNameText();
@@ -1065,7 +1188,7 @@ ArgumentStack Race::SetRacialModifier(ArgumentStack&& args)
 ArgumentStack Race::GetParentRace(ArgumentStack&& args)
 {
     auto raceId = Services::Events::ExtractArgument<int>(args);
-    auto parentRace = g_plugin->m_RaceParent[raceId] == RacialType::Invalid ? raceId : g_plugin->m_RaceParent[raceId];
+    auto parentRace = GetParentRaceId(raceId) == RacialType::Invalid ? raceId : GetParentRaceId(raceId);
     return Services::Events::Arguments(parentRace);
 }
 
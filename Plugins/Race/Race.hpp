@@ -1,11 +1,15 @@
 #pragma once
 
 #include "Plugin.hpp"
+#include "API/Constants.hpp"
 #include "Services/Events/Events.hpp"
 #include "Services/Hooks/Hooks.hpp"
+#include <array>
 #include <list>
 #include <map>
+#include <memory>
 #include <tuple>
+#include <vector>
 
 using namespace std;
 using namespace NWNXLib::API;
@@ -67,7 +71,6 @@ private:
     unordered_map<uint16_t, list<uint32_t>>                                           m_RaceImmunities;
     unordered_map<uint16_t, int32_t>                                                  m_RaceInitiative;
     unordered_map<uint16_t, int32_t>                                                  m_RaceMovementSpeed;
-    unordered_map<uint16_t, uint16_t>                                                 m_RaceParent;
     unordered_map<uint16_t, pair<uint8_t, uint16_t>>                                  m_RaceRegeneration;
     unordered_map<uint16_t, unordered_map<uint8_t, int32_t>>                          m_RaceSave;
     unordered_map<uint16_t, unordered_map<uint8_t, unordered_map<uint16_t, int16_t>>> m_RaceSaveVsRace;
@@ -76,7 +79,28 @@ private:
     unordered_map<uint16_t, list<uint32_t>>                                           m_RaceSpellImmunities;
     unordered_map<uint16_t, pair<uint8_t, uint8_t>>                                   m_RaceSRCharGen;
     unordered_map<uint16_t, tuple<uint8_t, uint8_t, uint8_t>>                         m_RaceSR;
-    unordered_map<uint16_t, std::vector<uint16_t>>                                    m_ChildRaces;
+
+    // By race, sized to racialtypes.2da when the rules load.
+    std::vector<uint16_t>                                                             m_RaceParent;
+    std::vector<std::vector<uint16_t>>                                                m_ChildRaces;
+
+    // The modifiers read on every attack, save, skill check and initiative roll, compiled from
+    // the tables above into flat arrays the first time they're needed after a change.
+    struct CombatModifiers
+    {
+        int32_t                                                                 m_AB = 0;
+        int32_t                                                                 m_Initiative = 0;
+        std::array<int32_t, Constants::SavingThrow::MAX + 1>                    m_Save{};
+        std::array<std::array<int16_t, 256>, Constants::SavingThrow::MAX + 1>   m_SaveVsType{};
+        std::array<int32_t, 256>                                                m_Skill{};
+        // By versus race.
+        std::vector<int32_t>                                                    m_ABVsRace;
+        std::array<std::vector<int16_t>, Constants::SavingThrow::MAX + 1>       m_SaveVsRace;
+    };
+
+    // By race, nullptr for the races without any combat modifiers.
+    std::vector<std::unique_ptr<CombatModifiers>>                                     m_CombatModifiers;
+    bool                                                                              m_CombatModifiersDirty = true;
 
     NWNXLib::Hooking::FunctionHook* m_CheckRacialResHook;
 
@@ -84,6 +108,9 @@ private:
     static void ApplyRaceEffects(CNWSCreature*);
     static void SetOrRestoreRace(bool, CNWSCreatureStats*, CNWSCreatureStats* = nullptr);
     static void SetRaceModifier(int32_t, RaceModifier, int32_t, int32_t, int32_t);
+    static uint16_t GetParentRaceId(uint16_t);
+    static const CombatModifiers* GetCombatModifiers(uint16_t);
+    static void CompileCombatModifiers();
 
     static void ResolveInitiativeHook(CNWSCreature*);
 
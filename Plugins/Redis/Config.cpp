@@ -3,6 +3,8 @@
 
 #include "Services/Config/Config.hpp"
 
+#include <algorithm>
+
 namespace Redis
 {
 
@@ -33,10 +35,19 @@ void Redis::Reconfigure()
         m_internal->m_config.m_host = GetServices()->m_config->Require<std::string>("HOST");
         m_internal->m_config.m_port = GetServices()->m_config->Get<int>("PORT", 6379);
 
+        // Pushing a metric for every command is not free, so it has to be asked for.
+        m_internal->m_config.m_query_metrics = GetServices()->m_config->Get<bool>("QUERY_METRICS", false);
+
         // Pubsub.
         m_internal->m_config.m_pubsub_script = GetServices()->m_config->Get<std::string>("PUBSUB_SCRIPT", "on_pubsub");
         m_internal->m_config.m_pubsub_channels = Utils::split(GetServices()->m_config->
                 Get<std::string>("PUBSUB_CHANNELS", ""), ',');
+        m_internal->m_config.m_pubsub_queue_size = std::max(1u,
+                GetServices()->m_config->Get<uint32_t>("PUBSUB_QUEUE_SIZE", 10000));
+        m_internal->m_config.m_pubsub_batch_size = std::max(1u,
+                GetServices()->m_config->Get<uint32_t>("PUBSUB_BATCH_SIZE", 100));
+        m_internal->m_config.m_pubsub_messages_per_tick = std::max(1u,
+                GetServices()->m_config->Get<uint32_t>("PUBSUB_MESSAGES_PER_TICK", 1000));
 
         LOG_INFO("Reconfiguring for redis at %s:%d",
                                    m_internal->m_config.m_host,
@@ -3,10 +3,12 @@
 
 #include "Services/Metrics/Metrics.hpp"
 #include "Services/Metrics/MetricData.hpp"
+#include "Services/Tasks/Tasks.hpp"
 
 #include <thread>
 #include <mutex>
 #include <chrono>
+#include <memory>
 
 namespace Redis
 {
@@ -22,6 +24,19 @@ void Redis::LogQuery(const std::vector<std::string>& v, const cpp_redis::reply&
     if (v.size() == 0)
         return;
 
+    // Formatting is left to the log macros, which skip it for suppressed levels.
+    if (r.is_error())
+    {
+        LOG_ERROR("Query failed: '%s' -> '%s'", Utils::join(v), RedisReplyAsString(r));
+    }
+    else
+    {
+        LOG_DEBUG("Query: '%s' -> '%s'", Utils::join(v), RedisReplyAsString(r));
+    }
+
+    if (!m_internal->m_config.m_query_metrics)
+        return;
+
     MetricData::Fields fields;
     std::string cmd = v[0];
     std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::toupper);
@@ -35,13 +50,6 @@ void Redis::LogQuery(const std::vector<std::string>& v, const cpp_redis::reply&
 
     fields.push_back({"reply_type", RedisReplyTypeToString(r.get_type())});
 
-    // XXX: this pushes ALL queries. Probably a bad idea.
-    // if (v.size() > 2) {
-    //     std::vector<std::string> va(&v[2], &v[v.size()-1]);
-    //     auto astr = str_implode(va);
-    //     fields.push_back({"arg", astr});
-    // }
-
     // Fields:
     // - cmd (extract cmd from query string)
     // - originator (TODO: who requested the query?)
@@ -60,18 +68,6 @@ void Redis::LogQuery(const std::vector<std::string>& v, const cpp_redis::reply&
         "Command",
         std::move(fields),
         std::move(tags));
-
-    auto qstr = Utils::join(v);
-    auto rstr = RedisReplyAsString(r);
-
-    if (r.is_error())
-    {
-        LOG_ERROR("Query failed: '%s' -> '%s'", qstr, rstr);
-    }
-    else
-    {
-        LOG_DEBUG("Query: '%s' -> '%s'", qstr, rstr);
-    }
 }
 
 template <typename Ret>
@@ -86,10 +82,13 @@ void Redis::RawAsync(const std::vector<std::string>& v,
     const auto start = steady_clock::now();
 
     m_internal->m_redis_pool.Borrow<void>([&](auto & c) {
-        c.send(v, [&](auto & r) {
+        // The reply arrives on the network thread, long after this call returned.
+        c.send(v, [this, v, start, results](auto & r) {
             const auto end = steady_clock::now();
-            const auto diff = duration_cast<nanoseconds>(end - start).count();
-            this->LogQuery(v, r, static_cast<uint64_t>(diff));
+            const auto diff = static_cast<uint64_t>(duration_cast<nanoseconds>(end - start).count());
+
+            // Metrics are not threadsafe.
+            GetServices()->m_tasks->QueueOnMainThread([this, v, r, diff] { LogQuery(v, r, diff); });
 
             results(r);
         }).commit();
@@ -99,18 +98,96 @@ void Redis::RawAsync(const std::vector<std::string>& v,
 cpp_redis::reply Redis::RawSync(const std::vector<std::string>& v)
 {
     const auto start = steady_clock::now();
+    uint64_t diff = 0;
 
-    return m_internal->m_redis_pool.Borrow<cpp_redis::reply>([&](auto & c) {
+    auto reply = m_internal->m_redis_pool.Borrow<cpp_redis::reply>([&](auto & c) {
         cpp_redis::reply rt;
         c.send(v, [&](auto & r) {
             const auto end = steady_clock::now();
-            const auto diff = duration_cast<nanoseconds>(end - start).count();
-            this->LogQuery(v, r, static_cast<uint64_t>(diff));
+            diff = static_cast<uint64_t>(duration_cast<nanoseconds>(end - start).count());
 
             rt = r;
         }).sync_commit();
         return rt;
     });
+
+    LogQuery(v, reply, diff);
+    return reply;
+}
+
+std::vector<cpp_redis::reply> Redis::RawPipelineSync(const std::vector<std::vector<std::string>>& commands)
+{
+    std::vector<cpp_redis::reply> replies(commands.size());
+    std::vector<uint64_t> durations(commands.size());
+    const auto start = steady_clock::now();
+
+    m_internal->m_redis_pool.Borrow<void>([&](auto & c) {
+        for (size_t i = 0; i < commands.size(); i++)
+        {
+            c.send(commands[i], [&, i](auto & r) {
+                const auto end = steady_clock::now();
+                durations[i] = static_cast<uint64_t>(duration_cast<nanoseconds>(end - start).count());
+
+                replies[i] = r;
+            });
+        }
+        c.sync_commit();
+    });
+
+    for (size_t i = 0; i < commands.size(); i++)
+        LogQuery(commands[i], replies[i], durations[i]);
+
+    return replies;
+}
+
+void Redis::RawPipelineAsync(std::vector<std::vector<std::string>> commands,
+                             std::function<void(std::vector<cpp_redis::reply>&)> results)
+{
+    struct PendingPipeline
+    {
+        std::vector<std::vector<std::string>> m_commands;
+        std::vector<cpp_redis::reply> m_replies;
+        std::vector<uint64_t> m_durations;
+        std::function<void(std::vector<cpp_redis::reply>&)> m_results;
+    };
+
+    auto pending = std::make_shared<PendingPipeline>();
+    pending->m_commands = std::move(commands);
+    pending->m_replies.resize(pending->m_commands.size());
+    pending->m_durations.resize(pending->m_commands.size());
+    pending->m_results = std::move(results);
+
+    auto complete = [this, pending] {
+        for (size_t i = 0; i < pending->m_commands.size(); i++)
+            LogQuery(pending->m_commands[i], pending->m_replies[i], pending->m_durations[i]);
+
+        pending->m_results(pending->m_replies);
+    };
+
+    if (pending->m_commands.empty())
+    {
+        GetServices()->m_tasks->QueueOnMainThread(std::move(complete));
+        return;
+    }
+
+    const auto start = steady_clock::now();
+
+    m_internal->m_redis_pool.Borrow<void>([&](auto & c) {
+        const size_t last = pending->m_commands.size() - 1;
+        for (size_t i = 0; i <= last; i++)
+        {
+            c.send(pending->m_commands[i], [this, complete, pending, start, last, i](auto & r) {
+                const auto end = steady_clock::now();
+                pending->m_durations[i] = static_cast<uint64_t>(duration_cast<nanoseconds>(end - start).count());
+                pending->m_replies[i] = r;
+
+                // Replies on a connection come back in the order the commands were sent.
+                if (i == last)
+                    GetServices()->m_tasks->QueueOnMainThread(complete);
+            });
+        }
+        c.commit();
+    });
 }
 
 std::string Redis::Sync(const std::vector<std::string>& v)
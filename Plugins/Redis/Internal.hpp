@@ -3,6 +3,7 @@
 #include <cpp_redis/cpp_redis>
 #include "Redis.hpp"
 #include "Pool.hpp"
+#include <deque>
 #include <mutex>
 #include <sstream>
 
@@ -19,8 +20,23 @@ struct Internal {
 
     // The pubsub connection.
     cpp_redis::redis_subscriber m_connection_pubsub;
-    std::string m_last_pubsub_channel;
-    std::string m_last_pubsub_message;
+
+    struct PubSubMessage
+    {
+        std::string m_channel;
+        std::string m_message;
+    };
+
+    // Messages waiting for the main thread, oldest first. New messages are dropped
+    // once it holds PUBSUB_QUEUE_SIZE of them.
+    std::mutex m_pubsub_mtx;
+    std::deque<PubSubMessage> m_pubsub_queue;
+    bool m_pubsub_delivery_queued = false;
+    uint64_t m_pubsub_dropped = 0;
+
+    // The batch handed to the pubsub script, only touched on the main thread.
+    std::vector<PubSubMessage> m_pubsub_batch;
+    size_t m_pubsub_batch_index = 0;
 
     // Config update mutex. Pool could run into this!
     std::mutex m_config_mtx;
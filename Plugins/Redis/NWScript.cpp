@@ -4,10 +4,16 @@
 #include "Internal.hpp"
 
 #include "Services/Events/Events.hpp"
+#include "Utils.hpp"
 
 #include "API/Functions.hpp"
 #include "API/CVirtualMachine.hpp"
 #include "API/CExoString.hpp"
+#include "API/CAppManager.hpp"
+#include "API/CServerExoApp.hpp"
+#include "API/CNWSModule.hpp"
+#include "API/Constants.hpp"
+#include "API/Globals.hpp"
 
 namespace Redis
 {
@@ -19,12 +25,30 @@ using namespace NWNXLib::API;
 // We cache all results until the end of the current script invocation.
 static std::vector<cpp_redis::reply> s_results;
 
+// Commands issued while pipelining are queued instead of sent. Their result ids are
+// handed out right away and filled in once the pipeline is committed.
+static bool s_pipelining = false;
+static std::vector<std::vector<std::string>> s_pipelineCommands;
+static std::vector<uint32_t> s_pipelineResultIds;
+
+static int32_t s_lastAsyncPipelineId = 0;
+static int32_t s_activeAsyncPipelineId = 0;
+
 void Redis::CleanState(bool before, CVirtualMachine* vm)
 {
     if (!before && vm->m_nRecursionLevel == 0)
     {
         LOG_DEBUG("Clearing all results after script exit.");
         s_results.clear();
+
+        if (s_pipelining)
+        {
+            LOG_WARNING("Discarding %u redis commands of a pipeline that was never committed.",
+                        s_pipelineCommands.size());
+            s_pipelining = false;
+            s_pipelineCommands.clear();
+            s_pipelineResultIds.clear();
+        }
     }
 }
 
@@ -46,14 +70,130 @@ void Redis::RegisterWithNWScript()
                 }
                 reverse(v.begin(), v.end());
 
-                auto ret = RawSync(v);
-
-                s_results.emplace_back(ret);
+                if (s_pipelining)
+                {
+                    s_pipelineCommands.emplace_back(std::move(v));
+                    s_pipelineResultIds.push_back(static_cast<uint32_t>(s_results.size()));
+                    s_results.emplace_back();
+                }
+                else
+                {
+                    s_results.emplace_back(RawSync(v));
+                }
 
                 // We return the assigned opaque value. Ignore that this is an array index.
                 return Events::Arguments(static_cast<int32_t>(s_results.size() - 1));
             });
 
+    // NWScript: Queue all following commands until the pipeline is committed.
+    GetServices()->m_events->RegisterEvent("BeginPipeline",
+            [&](Events::ArgumentStack &&)
+            {
+                if (s_pipelining)
+                {
+                    LOG_WARNING("A pipeline was already begun, commands keep being added to it.");
+                }
+                s_pipelining = true;
+                return Events::Arguments();
+            });
+
+    // NWScript: Send all queued commands at once and wait for their results.
+    // Returns the number of commands sent.
+    GetServices()->m_events->RegisterEvent("CommitPipeline",
+            [&](Events::ArgumentStack &&)
+            {
+                if (!s_pipelining)
+                {
+                    LOG_ERROR("No pipeline to commit. This is a error on your side.");
+                    return Events::Arguments(0);
+                }
+
+                auto commands = std::move(s_pipelineCommands);
+                auto resultIds = std::move(s_pipelineResultIds);
+                s_pipelining = false;
+                s_pipelineCommands.clear();
+                s_pipelineResultIds.clear();
+
+                auto replies = RawPipelineSync(commands);
+                for (size_t i = 0; i < replies.size(); i++)
+                {
+                    s_results[resultIds[i]] = std::move(replies[i]);
+                }
+
+                return Events::Arguments(static_cast<int32_t>(replies.size()));
+            });
+
+    // NWScript: Send all queued commands at once without waiting for them, and run
+    // a script once all results are in. Returns an id for the pipeline.
+    GetServices()->m_events->RegisterEvent("CommitPipelineAsync",
+            [&](Events::ArgumentStack && arg)
+            {
+                const auto callbackScript = Services::Events::ExtractArgument<std::string>(arg);
+                const auto callbackOwner = Services::Events::ExtractArgument<Types::ObjectID>(arg);
+
+                if (!s_pipelining)
+                {
+                    LOG_ERROR("No pipeline to commit. This is a error on your side.");
+                    return Events::Arguments(0);
+                }
+
+                auto commands = std::move(s_pipelineCommands);
+                auto resultIds = std::move(s_pipelineResultIds);
+                s_pipelining = false;
+                s_pipelineCommands.clear();
+                s_pipelineResultIds.clear();
+
+                // The results the script reads are not the ones of this invocation anymore.
+                for (auto resultId : resultIds)
+                {
+                    s_results[resultId] = cpp_redis::reply();
+                }
+
+                const auto pipelineId = ++s_lastAsyncPipelineId;
+
+                RawPipelineAsync(std::move(commands),
+                    [callbackScript, callbackOwner, resultIds, pipelineId](std::vector<cpp_redis::reply>& replies)
+                    {
+                        if (callbackScript.empty())
+                            return;
+
+                        // Only ever deliver script events when a module is running.
+                        if (Globals::AppManager()->m_pServerExoApp->GetServerMode() != 2)
+                        {
+                            LOG_DEBUG("Pipeline %d results dropped because no module is running.", pipelineId);
+                            return;
+                        }
+
+                        // The callback reads the results by the ids handed out when the commands were queued.
+                        auto previousResults = std::move(s_results);
+                        const auto previousPipelineId = s_activeAsyncPipelineId;
+                        s_results.clear();
+                        s_results.resize(resultIds.empty() ? 0 : resultIds.back() + 1);
+                        for (size_t i = 0; i < replies.size(); i++)
+                        {
+                            s_results[resultIds[i]] = std::move(replies[i]);
+                        }
+                        s_activeAsyncPipelineId = pipelineId;
+
+                        const auto owner = callbackOwner == Constants::OBJECT_INVALID
+                            ? Utils::GetModule()->m_idSelf
+                            : callbackOwner;
+                        Utils::ExecuteScript(callbackScript, owner);
+
+                        s_activeAsyncPipelineId = previousPipelineId;
+                        s_results = std::move(previousResults);
+                    });
+
+                return Events::Arguments(pipelineId);
+            });
+
+    // NWScript: Returns the id of the async pipeline whose results are being delivered.
+    GetServices()->m_events->RegisterEvent("GetAsyncPipelineId",
+            [&](Events::ArgumentStack &&)
+            {
+                return Events::Arguments(s_activeAsyncPipelineId);
+            });
+
     // NWScript: Returns the last query result type as a int.
     GetServices()->m_events->RegisterEvent("GetResultType",
             [&](Events::ArgumentStack && arg)
@@ -147,7 +287,26 @@ void Redis::RegisterWithNWScript()
     GetServices()->m_events->RegisterEvent("GetPubSubData",
             [&](Events::ArgumentStack &&)
             {
-                return Events::Arguments(m_internal->m_last_pubsub_channel, m_internal->m_last_pubsub_message);
+                const auto& batch = m_internal->m_pubsub_batch;
+                const auto index = m_internal->m_pubsub_batch_index;
+                if (index < batch.size())
+                {
+                    return Events::Arguments(batch[index].m_channel, batch[index].m_message);
+                }
+                return Events::Arguments(std::string(), std::string());
+            });
+
+    // NWScript: Move on to the next pubsub message of the batch being delivered.
+    // Returns 1 if there was one, 0 once the batch was read through.
+    GetServices()->m_events->RegisterEvent("NextPubSubMessage",
+            [&](Events::ArgumentStack &&)
+            {
+                if (m_internal->m_pubsub_batch_index + 1 < m_internal->m_pubsub_batch.size())
+                {
+                    m_internal->m_pubsub_batch_index++;
+                    return Events::Arguments(1);
+                }
+                return Events::Arguments(0);
             });
 }
 
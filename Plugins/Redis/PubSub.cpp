@@ -3,6 +3,7 @@
 
 #include "Services/Config/Config.hpp"
 #include "Services/Events/Events.hpp"
+#include "Services/Metrics/Metrics.hpp"
 #include "Services/Tasks/Tasks.hpp"
 
 #include "API/Globals.hpp"
@@ -11,7 +12,9 @@
 #include "API/CServerExoApp.hpp"
 #include "API/CVirtualMachine.hpp"
 
+#include <algorithm>
 #include <cstring>
+#include <iterator>
 
 namespace Redis
 {
@@ -25,33 +28,123 @@ void Redis::OnPubsub(const std::string& channel, const std::string& message)
 {
     LOG_DEBUG("PubSub: channel='%s' message='%s'", channel, message);
 
-    std::string scr;
+    size_t queueSize;
+    {
+        std::lock_guard<std::mutex> lock(m_internal->m_config_mtx);
+        queueSize = m_internal->m_config.m_pubsub_queue_size;
+    }
+
+    bool scheduleDelivery;
+    {
+        std::lock_guard<std::mutex> lock(m_internal->m_pubsub_mtx);
+
+        if (m_internal->m_pubsub_queue.size() >= queueSize)
+        {
+            m_internal->m_pubsub_dropped++;
+            return;
+        }
+
+        m_internal->m_pubsub_queue.push_back({channel, message});
+
+        // One delivery task drains the whole queue, however many messages come in before it runs.
+        scheduleDelivery = !m_internal->m_pubsub_delivery_queued;
+        m_internal->m_pubsub_delivery_queued = true;
+    }
+
+    if (scheduleDelivery)
+    {
+        GetServices()->m_tasks->QueueOnMainThread([this] { DeliverPubsub(); });
+    }
+}
 
+void Redis::DeliverPubsub()
+{
+    std::string script;
+    size_t queueSize, batchSize, budget;
     {
         std::lock_guard<std::mutex> lock(m_internal->m_config_mtx);
 
         ASSERT(!m_internal->m_config.m_pubsub_script.empty());
-        scr = m_internal->m_config.m_pubsub_script;
+        script = m_internal->m_config.m_pubsub_script;
+        queueSize = m_internal->m_config.m_pubsub_queue_size;
+        batchSize = m_internal->m_config.m_pubsub_batch_size;
+        budget = m_internal->m_config.m_pubsub_messages_per_tick;
     }
 
-    if (!scr.empty())
+    // Only ever deliver script events when a module is running.
+    const bool moduleRunning = Globals::AppManager()->m_pServerExoApp->GetServerMode() == 2;
+
+    auto& batch = m_internal->m_pubsub_batch;
+    uint64_t delivered = 0;
+    uint64_t discarded = 0;
+
+    while (delivered < budget)
     {
-        GetServices()->m_tasks->QueueOnMainThread([this, scr, channel, message] {
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_internal->m_pubsub_mtx);
 
-            m_internal->m_last_pubsub_channel = channel;
-            m_internal->m_last_pubsub_message = message;
+            auto& queue = m_internal->m_pubsub_queue;
+            const size_t count = std::min({batchSize, budget - delivered, queue.size()});
+            std::move(queue.begin(), queue.begin() + count, std::back_inserter(batch));
+            queue.erase(queue.begin(), queue.begin() + count);
+        }
 
-            // Only ever deliver script events when a module is running.
-            if (Globals::AppManager()->m_pServerExoApp->GetServerMode() != 2) {
-                LOG_DEBUG("Event dropped because no module is running.");
-                return;
-            }
+        if (batch.empty())
+            break;
 
-            CExoString script(scr.c_str());
-            Globals::VirtualMachine()->RunScript(&script, 0, 1);
-        });
+        if (!moduleRunning || script.empty())
+        {
+            LOG_DEBUG("%u pubsub messages dropped because no module is running.", batch.size());
+            discarded += batch.size();
+            batch.clear();
+            continue;
+        }
+
+        // The script can step through the batch itself. Whatever it leaves is handed to
+        // another run, so scripts reading only one message per run miss nothing.
+        for (size_t index = 0; index < batch.size(); index = m_internal->m_pubsub_batch_index + 1)
+        {
+            m_internal->m_pubsub_batch_index = index;
+
+            CExoString exoScript(script.c_str());
+            Globals::VirtualMachine()->RunScript(&exoScript, 0, 1);
+        }
+
+        delivered += batch.size();
+    }
+
+    size_t backlog;
+    uint64_t dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_internal->m_pubsub_mtx);
+
+        backlog = m_internal->m_pubsub_queue.size();
+        dropped = m_internal->m_pubsub_dropped;
+        m_internal->m_pubsub_dropped = 0;
+        m_internal->m_pubsub_delivery_queued = backlog > 0;
     }
 
+    // Tasks queued while the main thread works through its queue wait for the next tick.
+    if (backlog > 0)
+    {
+        GetServices()->m_tasks->QueueOnMainThread([this] { DeliverPubsub(); });
+    }
+
+    if (dropped > 0)
+    {
+        LOG_WARNING("Dropped %u pubsub messages, more than %u were waiting to be delivered.",
+                    dropped, queueSize);
+    }
+
+    GetServices()->m_metrics->Push(
+        "PubSub",
+        {
+            {"delivered", std::to_string(delivered)},
+            {"discarded", std::to_string(discarded)},
+            {"dropped", std::to_string(dropped)},
+            {"backlog", std::to_string(backlog)},
+        });
 }
 
 }
@@ -43,6 +43,15 @@ public:
         std::string m_pubsub_script;
         // PUBSUB_CHANNELS
         std::vector<std::string> m_pubsub_channels;
+        // PUBSUB_QUEUE_SIZE
+        size_t m_pubsub_queue_size;
+        // PUBSUB_BATCH_SIZE
+        size_t m_pubsub_batch_size;
+        // PUBSUB_MESSAGES_PER_TICK
+        size_t m_pubsub_messages_per_tick;
+
+        // QUERY_METRICS
+        bool m_query_metrics;
     };
 
     Redis(const Plugin::CreateParams& params);
@@ -62,9 +71,21 @@ public:
 
     // Executes a query asychronously and calls you when the result comes in.
     // Will raise a redis_cpp::redis_error if things go awry.
+    // The logging and metrics for the query happen on the main thread, the
+    // callback itself is run from the network thread.
     void RawAsync(const std::vector<std::string>&,
                   std::function<void(cpp_redis::reply&)>);
 
+    // Sends all commands over one connection without waiting for each reply,
+    // and returns the replies in the order of the commands.
+    // This call is fully threadsafe.
+    std::vector<cpp_redis::reply> RawPipelineSync(const std::vector<std::vector<std::string>>&);
+
+    // Sends all commands over one connection and returns immediately. Once all
+    // replies are in, the callback is run on the main thread with them.
+    void RawPipelineAsync(std::vector<std::vector<std::string>>,
+                          std::function<void(std::vector<cpp_redis::reply>&)>);
+
     // Some simple helpers below.
     // These will not require you to pull in cpp_redis.
     // HOWEVER, they are rather lacking in error-handling; for all but the
@@ -89,6 +110,7 @@ private:
     void RegisterWithNWScript();
     void HookSCORCO();
     void OnPubsub(const std::string& channel, const std::string& message);
+    void DeliverPubsub();
     void LogQuery(const std::vector<std::string>&, const cpp_redis::reply&,
                   const uint64_t ns);
     std::unique_ptr<cpp_redis::redis_client> PoolMakeFunc();
@@ -1,6 +1,7 @@
 #include "Regex.hpp"
 
 #include "Services/Config/Config.hpp"
+#include "Utils/Regex.hpp"
 
 #include <string>
 #include <stdio.h>
@@ -45,6 +46,7 @@ Regex::Regex(const Plugin::CreateParams& params)
 
 #undef REGISTER
 
+    Utils::SetRegexCacheSize(GetServices()->m_config->Get<uint32_t>("CACHE_SIZE", 64));
 }
 
 Regex::~Regex()
@@ -56,8 +58,8 @@ ArgumentStack Regex::Search(ArgumentStack&& args)
     const auto str = Services::Events::ExtractArgument<std::string>(args);
     const auto regex = Services::Events::ExtractArgument<std::string>(args);
 
-    std::regex rgx(regex);
-    const auto retVal = std::regex_search(str, rgx);
+    const auto rgx = Utils::GetRegex(regex);
+    const auto retVal = std::regex_search(str, *rgx);
 
     return Services::Events::Arguments(retVal);
 }
@@ -69,12 +71,12 @@ ArgumentStack Regex::Replace(ArgumentStack&& args)
     const auto rpl = Services::Events::ExtractArgument<std::string>(args);
     const auto firstOnly = Services::Events::ExtractArgument<int32_t>(args);
 
-    std::regex rgx(regex);
+    const auto rgx = Utils::GetRegex(regex);
     std::string retVal;
     if (firstOnly)
-        retVal = std::regex_replace(str, rgx, rpl, std::regex_constants::format_first_only);
+        retVal = std::regex_replace(str, *rgx, rpl, std::regex_constants::format_first_only);
     else
-        retVal = std::regex_replace(str, rgx, rpl);
+        retVal = std::regex_replace(str, *rgx, rpl);
 
     return Services::Events::Arguments(retVal);
 }
@@ -61,7 +61,7 @@ NWNX_PLUGIN_ENTRY Plugin* PluginLoad(Plugin::CreateParams params)
 namespace Rename {
 
 Rename::Rename(const Plugin::CreateParams& params)
-  : Plugin(params)
+  : Plugin(params), m_UpdateObjectHooked(false)
 {
 #define REGISTER(func)              \
     GetServices()->m_events->RegisterEvent(#func, std::bind(&Rename::func, this, std::placeholders::_1))
@@ -77,9 +77,6 @@ Rename::Rename(const Plugin::CreateParams& params)
     m_RenameAllowDM = GetServices()->m_config->Get<bool>("ALLOW_DM", false);
     m_RenameAnonymousPlayerName = GetServices()->m_config->Get<std::string>("ANONYMOUS_NAME", "Someone");
 
-    GetServices()->m_hooks->RequestSharedHook<Functions::_ZN11CNWSMessage31WriteGameObjUpdate_UpdateObjectEP10CNWSPlayerP10CNWSObjectP17CLastUpdateObjectjj,
-            int32_t, CNWSMessage *, CNWSPlayer *, CNWSObject *, CLastUpdateObject *, uint32_t, uint32_t>(
-            &WriteGameObjUpdate_UpdateObjectHook);
     GetServices()->m_hooks->RequestSharedHook<Functions::_ZN11CNWSMessage41SendServerToPlayerExamineGui_CreatureDataEP10CNWSPlayerj,
             int32_t, CNWSMessage *, CNWSPlayer *, Types::ObjectID>(&SendServerToPlayerExamineGui_CreatureDataHook);
     GetServices()->m_hooks->RequestSharedHook<Functions::_ZN11CNWSMessage28SendServerToPlayerChat_PartyEjj10CExoString,
@@ -187,57 +184,103 @@ void Rename::SetOrRestorePlayerName(bool before, CNWSPlayer *targetPlayer, CNWSP
 void Rename::SetPlayerNameAsObservedBy(CNWSCreature *targetCreature, Types::ObjectID observerOid, bool playerList)
 {
     auto targetOid = targetCreature->m_idSelf;
-    if (!g_plugin->m_RenamePlayerNames.count(targetOid))
+    bool personal;
+    auto *pOverride = g_plugin->FindNameOverride(targetOid, observerOid, &personal);
+    if (!pOverride)
         return;
-    if (g_plugin->m_RenamePlayerNames[targetOid].count(observerOid))
+
+    if (playerList)
     {
-        auto displayName = std::get<0>(g_plugin->m_RenamePlayerNames[targetOid][observerOid]);
-        auto overrideName = std::get<1>(g_plugin->m_RenamePlayerNames[targetOid][observerOid]);
-        if (playerList)
-        {
-            targetCreature->m_pStats->m_lsFirstName = g_plugin->ContainString(overrideName.CStr());
-            targetCreature->m_pStats->m_lsLastName = g_plugin->ContainString("");
-        }
-        targetCreature->m_sDisplayName = displayName;
-        LOG_DEBUG("Observer %x will see %x as %s due to personal override", observerOid, targetOid, overrideName.m_sString);
+        static const CExoLocString emptyName = g_plugin->ContainString("");
+        targetCreature->m_pStats->m_lsFirstName = pOverride->m_firstName;
+        targetCreature->m_pStats->m_lsLastName = emptyName;
     }
-    else if (g_plugin->m_RenamePlayerNames[targetOid].count(Constants::OBJECT_INVALID))
+
+    // The global display name is already on the creature.
+    if (personal)
     {
-        auto displayName = std::get<0>(g_plugin->m_RenamePlayerNames[targetOid][Constants::OBJECT_INVALID]);
-        auto overrideName = std::get<1>(g_plugin->m_RenamePlayerNames[targetOid][Constants::OBJECT_INVALID]);
-        if (playerList)
-        {
-            targetCreature->m_pStats->m_lsFirstName = g_plugin->ContainString(overrideName.CStr());
-            targetCreature->m_pStats->m_lsLastName = g_plugin->ContainString("");
-        }
-        targetCreature->m_sDisplayName = displayName;
-        LOG_DEBUG("Observer %x will see %x as %s due to global override", observerOid, targetOid, overrideName.m_sString);
+        targetCreature->m_sDisplayName = pOverride->m_displayName;
     }
+    LOG_DEBUG("Observer %x will see %x as %s due to %s override", observerOid, targetOid, pOverride->m_overrideName.m_sString,
+              personal ? "personal" : "global");
 }
 
 void Rename::RestorePlayerName(CNWSCreature *targetCreature, bool playerList)
 {
-    if (g_plugin->m_RenameOriginalNames.count(targetCreature->m_idSelf))
+    auto originalNames = g_plugin->m_RenameOriginalNames.find(targetCreature->m_idSelf);
+    if (originalNames != g_plugin->m_RenameOriginalNames.end())
     {
-        auto lsFirstName = std::get<1>(g_plugin->m_RenameOriginalNames[targetCreature->m_idSelf]);
-        auto lsLastName = std::get<2>(g_plugin->m_RenameOriginalNames[targetCreature->m_idSelf]);
         if (playerList)
         {
-            targetCreature->m_pStats->m_lsFirstName = lsFirstName;
-            targetCreature->m_pStats->m_lsLastName = lsLastName;
+            targetCreature->m_pStats->m_lsFirstName = std::get<1>(originalNames->second);
+            targetCreature->m_pStats->m_lsLastName = std::get<2>(originalNames->second);
         }
 
-        if (g_plugin->m_RenamePlayerNames[targetCreature->m_idSelf].count(Constants::OBJECT_INVALID))
-        {
-            targetCreature->m_sDisplayName = std::get<0>(g_plugin->m_RenamePlayerNames[targetCreature->m_idSelf][Constants::OBJECT_INVALID]);
-        }
-        else
-        {
-            targetCreature->m_sDisplayName = "";
-        }
+        g_plugin->ApplyGlobalDisplayName(targetCreature);
     }
 }
 
+const Rename::NameOverride* Rename::FindNameOverride(Types::ObjectID targetOid, Types::ObjectID observerOid, bool *pPersonal) const
+{
+    if (pPersonal)
+        *pPersonal = false;
+
+    auto targets = m_RenamePlayerNames.find(targetOid);
+    if (targets == m_RenamePlayerNames.end())
+        return nullptr;
+
+    auto nameOverride = targets->second.find(observerOid);
+    if (nameOverride != targets->second.end())
+    {
+        if (pPersonal)
+            *pPersonal = observerOid != Constants::OBJECT_INVALID;
+        return &nameOverride->second;
+    }
+
+    nameOverride = targets->second.find(Constants::OBJECT_INVALID);
+    return nameOverride != targets->second.end() ? &nameOverride->second : nullptr;
+}
+
+void Rename::EraseNameOverride(Types::ObjectID targetOid, Types::ObjectID observerOid)
+{
+    auto targets = m_RenamePlayerNames.find(targetOid);
+    if (targets == m_RenamePlayerNames.end())
+        return;
+
+    targets->second.erase(observerOid);
+    if (targets->second.empty())
+        m_RenamePlayerNames.erase(targets);
+}
+
+void Rename::ApplyGlobalDisplayName(CNWSCreature *targetCreature) const
+{
+    auto *pOverride = FindNameOverride(targetCreature->m_idSelf, Constants::OBJECT_INVALID);
+    const auto& displayName = pOverride ? pOverride->m_displayName : CExoString("");
+
+    if (targetCreature->m_sDisplayName != displayName)
+        targetCreature->m_sDisplayName = displayName;
+}
+
+void Rename::UpdateHooks()
+{
+    const bool active = !m_RenamePlayerNames.empty();
+    if (active == m_UpdateObjectHooked)
+        return;
+
+    if (active)
+    {
+        GetServices()->m_hooks->RequestSharedHook<Functions::_ZN11CNWSMessage31WriteGameObjUpdate_UpdateObjectEP10CNWSPlayerP10CNWSObjectP17CLastUpdateObjectjj,
+                int32_t, CNWSMessage *, CNWSPlayer *, CNWSObject *, CLastUpdateObject *, uint32_t, uint32_t>(
+                &WriteGameObjUpdate_UpdateObjectHook);
+    }
+    else
+    {
+        GetServices()->m_hooks->ClearHook(Functions::_ZN11CNWSMessage31WriteGameObjUpdate_UpdateObjectEP10CNWSPlayerP10CNWSObjectP17CLastUpdateObjectjj);
+    }
+
+    m_UpdateObjectHooked = active;
+}
+
 void Rename::WriteGameObjUpdate_UpdateObjectHook(
         bool before,
         CNWSMessage*,
@@ -247,6 +290,10 @@ void Rename::WriteGameObjUpdate_UpdateObjectHook(
         uint32_t,
         uint32_t)
 {
+    // Most updates are for objects that aren't renamed players, skip those before looking for a client.
+    if (!g_plugin->m_RenamePlayerNames.count(targetObject->m_idSelf))
+        return;
+
     auto *targetPlayer = Globals::AppManager()->m_pServerExoApp->GetClientObjectByObjectId(targetObject->m_idSelf);
     SetOrRestorePlayerName(before, targetPlayer, observerPlayer);
 }
@@ -257,6 +304,9 @@ void Rename::SendServerToPlayerExamineGui_CreatureDataHook(
         CNWSPlayer *observerPlayer,
         Types::ObjectID targetOid)
 {
+    if (!g_plugin->m_RenamePlayerNames.count(targetOid))
+        return;
+
     auto *targetPlayer = Globals::AppManager()->m_pServerExoApp->GetClientObjectByObjectId(targetOid);
     SetOrRestorePlayerName(before, targetPlayer, observerPlayer);
 }
@@ -338,6 +388,9 @@ void Rename::SendServerToPlayerChatHook(
         Types::ObjectID targetOid,
         CExoString*)
 {
+    if (!g_plugin->m_RenamePlayerNames.count(targetOid))
+        return;
+
     auto *targetPlayer = Globals::AppManager()->m_pServerExoApp->GetClientObjectByObjectId(targetOid);
     auto *observerClient = Globals::AppManager()->m_pServerExoApp->GetClientObjectByPlayerId(observerPlayerId, 0);
     auto *observerPlayer = static_cast<CNWSPlayer*>(observerClient);
@@ -405,14 +458,9 @@ int32_t Rename::SendServerToPlayerPopUpGUIPanelHook(
         auto *server = Globals::AppManager()->m_pServerExoApp;
         auto *observerCreature = server->GetCreatureByGameObjectID(observerOid);
         auto targetOid = observerCreature->m_oidInvitedToPartyBy;
-        if (g_plugin->m_RenamePlayerNames.count(targetOid) && g_plugin->m_RenamePlayerNames[targetOid].count(observerOid))
-        {
-            *p_sStringReference = std::get<0>(g_plugin->m_RenamePlayerNames[targetOid][observerOid]);
-        }
-        else if (g_plugin->m_RenamePlayerNames.count(targetOid) &&
-                 g_plugin->m_RenamePlayerNames[targetOid].count(Constants::OBJECT_INVALID))
+        if (auto *pOverride = g_plugin->FindNameOverride(targetOid, observerOid))
         {
-            *p_sStringReference = std::get<0>(g_plugin->m_RenamePlayerNames[targetOid][Constants::OBJECT_INVALID]);
+            *p_sStringReference = pOverride->m_displayName;
         }
     }
     return m_SendServerToPlayerPopUpGUIPanelHook->CallOriginal<int32_t>(pMessage, observerOid, nGuiPanel, bGUIOption1,
@@ -475,16 +523,17 @@ void Rename::GlobalNameChange(
             auto *targetPlayer = static_cast<CNWSPlayer*>(server->GetClientObjectByPlayerId(targetPid, 0));
             auto targetOid = targetPlayer->m_oidNWSObject;
             auto *targetCreature = server->GetCreatureByGameObjectID(targetOid);
-            if (targetCreature && g_plugin->m_RenamePlayerNames.count(targetOid) &&
-                g_plugin->m_RenamePlayerNames[targetOid].count(Constants::OBJECT_INVALID))
+            auto *pGlobalOverride = FindNameOverride(targetOid, Constants::OBJECT_INVALID);
+            auto originalNames = m_RenameOriginalNames.find(targetOid);
+            if (targetCreature && pGlobalOverride && originalNames != m_RenameOriginalNames.end())
             {
-                auto playerNameOverrideState = std::get<2>(g_plugin->m_RenamePlayerNames[targetOid][Constants::OBJECT_INVALID]);
+                auto playerNameOverrideState = pGlobalOverride->m_playerNameState;
                 if (playerNameOverrideState)
                 {
                     auto playerInfo = pNetLayer->GetPlayerInfo(targetPid);
                     if (!before)
                     {
-                        playerInfo->m_sPlayerName = std::get<0>(g_plugin->m_RenameOriginalNames[targetOid]);
+                        playerInfo->m_sPlayerName = std::get<0>(originalNames->second);
                     }
                     else
                     {
@@ -494,13 +543,13 @@ void Rename::GlobalNameChange(
                                 playerInfo->m_sPlayerName = CExoString(GenerateRandomPlayerName(7).c_str());
                                 break;
                             case NWNX_RENAME_PLAYERNAME_OVERRIDE:
-                                playerInfo->m_sPlayerName = std::get<1>(g_plugin->m_RenamePlayerNames[targetOid][Constants::OBJECT_INVALID]);
+                                playerInfo->m_sPlayerName = pGlobalOverride->m_overrideName;
                                 break;
                             case NWNX_RENAME_PLAYERNAME_ANONYMOUS:
                                 playerInfo->m_sPlayerName = CExoString(m_RenameAnonymousPlayerName.c_str());
                                 break;
                             default:
-                                playerInfo->m_sPlayerName = std::get<0>(g_plugin->m_RenameOriginalNames[targetOid]);
+                                playerInfo->m_sPlayerName = std::get<0>(originalNames->second);
                         }
                     }
                 }
@@ -554,16 +603,17 @@ void Rename::SendNameUpdate(CNWSCreature *targetCreature, Types::PlayerID observ
     }
 
     auto *message = static_cast<CNWSMessage*>(server->GetNWSMessage());
+    auto targets = g_plugin->m_RenamePlayerNames.find(targetCreature->m_idSelf);
     for (auto &pid : playersToNotify)
     {
         bool success = false;
         auto *observerPlayerObject = static_cast<CNWSPlayer*>(server->GetClientObjectByPlayerId(pid, 0));
         if (observerPlayerObject == nullptr)
             continue;
-        auto targets = g_plugin->m_RenamePlayerNames[targetCreature->m_idSelf];
 
         // If the update is to all clients but the observer has a personal override of the target's name then skip
-        if (observerPlayerId == Constants::PLAYERID_ALL_CLIENTS && targets.count(observerPlayerObject->m_oidNWSObject))
+        if (observerPlayerId == Constants::PLAYERID_ALL_CLIENTS && targets != g_plugin->m_RenamePlayerNames.end() &&
+            targets->second.count(observerPlayerObject->m_oidNWSObject))
             continue;
 
         if (g_plugin->m_RenameAllowDM || observerPlayerObject->m_nCharacterType != Constants::CharacterType::DM)
@@ -636,10 +686,6 @@ ArgumentStack Rename::SetPCNameOverride(ArgumentStack&& args)
         std::string fullDisplayName = sPrefix + newName + sSuffix; //put together the floaty/chat/hover name
         fullDisplayName = std::regex_replace(fullDisplayName, std::regex("^ +| +$|( ) +"), "$1"); //remove trailing and leading spaces
 
-        // Store our override values
-        m_RenamePlayerNames[targetOid][observerOid] = std::make_tuple(CExoString(fullDisplayName.c_str()),
-                                                                      CExoString(newName.c_str()), bPlayerNameState);
-
         // Store the original values
         auto *pPlayerInfo = server->GetNetLayer()->GetPlayerInfo(targetPlayer->m_nPlayerID);
         m_RenameOriginalNames[targetOid] = std::make_tuple(
@@ -647,6 +693,16 @@ ArgumentStack Rename::SetPCNameOverride(ArgumentStack&& args)
                 targetCreature->m_pStats->m_lsFirstName,
                 targetCreature->m_pStats->m_lsLastName);
 
+        // Store our override values
+        auto& nameOverride = m_RenamePlayerNames[targetOid][observerOid];
+        nameOverride.m_displayName = CExoString(fullDisplayName.c_str());
+        nameOverride.m_overrideName = CExoString(newName.c_str());
+        nameOverride.m_firstName = ContainString(newName);
+        nameOverride.m_playerNameState = bPlayerNameState;
+
+        ApplyGlobalDisplayName(targetCreature);
+        UpdateHooks();
+
         // If we've ran this before the PC has even been added to the other clients' player list then there's
         // nothing else we need to do, the hooks will take care of doing the renames. If we don't skip this
         // then the SendServerToPlayerPlayerList_All in the SendNameUpdate below runs before the server has even ran a
@@ -675,10 +731,8 @@ ArgumentStack Rename::GetPCNameOverride(ArgumentStack &&args)
             return Services::Events::Arguments();
         }
         auto observerOid = Services::Events::ExtractArgument<Types::ObjectID>(args);
-        if(m_RenamePlayerNames[targetOid].find(observerOid) != m_RenamePlayerNames[targetOid].end())
-            retVal = std::get<0>(m_RenamePlayerNames[targetOid][observerOid]).CStr();
-        else if(m_RenamePlayerNames[targetOid].find(Constants::OBJECT_INVALID) != m_RenamePlayerNames[targetOid].end())
-            retVal = std::get<0>(m_RenamePlayerNames[targetOid][Constants::OBJECT_INVALID]).CStr();
+        if (auto *pOverride = FindNameOverride(targetOid, observerOid))
+            retVal = CExoString(pOverride->m_displayName).CStr();
     }
     return Services::Events::Arguments(retVal);
 }
@@ -704,37 +758,52 @@ ArgumentStack Rename::ClearPCNameOverride(ArgumentStack &&args)
     if (observerOid == Constants::OBJECT_INVALID && !bClearAll)
     {
         auto *targetCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(playerOid);
-        m_RenamePlayerNames[playerOid].erase(Constants::OBJECT_INVALID);
-        SendNameUpdate(targetCreature, Constants::PLAYERID_ALL_CLIENTS);
+        EraseNameOverride(playerOid, Constants::OBJECT_INVALID);
+        if (targetCreature)
+        {
+            ApplyGlobalDisplayName(targetCreature);
+            SendNameUpdate(targetCreature, Constants::PLAYERID_ALL_CLIENTS);
+        }
     }
     // clears global override and all personal overrides for that target PC
     else if (observerOid == Constants::OBJECT_INVALID)
     {
         auto *targetCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(playerOid);
         m_RenamePlayerNames.erase(playerOid);
-        SendNameUpdate(targetCreature, Constants::PLAYERID_ALL_CLIENTS);
+        if (targetCreature)
+        {
+            ApplyGlobalDisplayName(targetCreature);
+            SendNameUpdate(targetCreature, Constants::PLAYERID_ALL_CLIENTS);
+        }
     }
     // clears all personal overrides for the observer for any targets
     else if (playerOid == Constants::OBJECT_INVALID)
     {
-        for (auto tgt = m_RenamePlayerNames.cbegin(), next_tgt = tgt; tgt != m_RenamePlayerNames.cend(); tgt = next_tgt)
+        std::vector<Types::ObjectID> targetOids;
+        for (auto& targets : m_RenamePlayerNames)
         {
-            ++next_tgt;
-            if (m_RenamePlayerNames[tgt->first].erase(observerOid))
-            {
-                auto *targetCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(tgt->first);
-                if (targetCreature)
-                    SendNameUpdate(targetCreature, observerPlayerId);
-            }
+            if (targets.second.count(observerOid))
+                targetOids.push_back(targets.first);
+        }
+
+        for (auto targetOid : targetOids)
+        {
+            EraseNameOverride(targetOid, observerOid);
+            auto *targetCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(targetOid);
+            if (targetCreature)
+                SendNameUpdate(targetCreature, observerPlayerId);
         }
     }
     // clears personal override for that observer for target oPC
     else
     {
         auto *targetCreature = Globals::AppManager()->m_pServerExoApp->GetCreatureByGameObjectID(playerOid);
-        m_RenamePlayerNames[playerOid].erase(observerOid);
-        SendNameUpdate(targetCreature, observerPlayerId);
+        EraseNameOverride(playerOid, observerOid);
+        if (targetCreature)
+            SendNameUpdate(targetCreature, observerPlayerId);
     }
+
+    UpdateHooks();
     return Services::Events::Arguments();
 }
 
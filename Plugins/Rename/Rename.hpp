@@ -21,13 +21,25 @@ public:
     virtual ~Rename();
 
 private:
-    std::unordered_map<Types::ObjectID, std::unordered_map<Types::ObjectID, std::tuple<CExoString, CExoString, int32_t>>> m_RenamePlayerNames;
+    // What an observer sees a renamed player as, ready to be written into messages.
+    struct NameOverride
+    {
+        CExoString m_displayName;
+        CExoString m_overrideName;
+        // m_overrideName as the first name shown in the player list.
+        CExoLocString m_firstName;
+        int32_t m_playerNameState;
+    };
+
+    // Overrides by target, then by observer. The global override is observed by OBJECT_INVALID.
+    std::unordered_map<Types::ObjectID, std::unordered_map<Types::ObjectID, NameOverride>> m_RenamePlayerNames;
     std::unordered_map<Types::ObjectID, std::tuple<CExoString, CExoLocString, CExoLocString>> m_RenameOriginalNames;
     int32_t m_RenameOnModuleCharList;
     std::unordered_set<Types::PlayerID> m_RenameAddedToPlayerList;
     bool m_RenameOnPlayerList;
     bool m_RenameAllowDM;
     std::string m_RenameAnonymousPlayerName;
+    bool m_UpdateObjectHooked;
 
     static void WriteGameObjUpdate_UpdateObjectHook(bool, CNWSMessage*, CNWSPlayer*, CNWSObject*, CLastUpdateObject*, uint32_t, uint32_t);
     static void SendServerToPlayerPlayerList_AllHook(bool, CNWSMessage*, CNWSPlayer*);
@@ -43,6 +55,14 @@ private:
     static void RestorePlayerName(CNWSCreature *targetCreature, bool playerList=false);
     void GlobalNameChange(bool, Types::PlayerID, Types::PlayerID);
 
+    // The personal override of the observer if it has one, else the global override.
+    const NameOverride* FindNameOverride(Types::ObjectID targetOid, Types::ObjectID observerOid, bool *pPersonal = nullptr) const;
+    void EraseNameOverride(Types::ObjectID targetOid, Types::ObjectID observerOid);
+    // Puts the display name everyone without a personal override sees on the creature.
+    void ApplyGlobalDisplayName(CNWSCreature *targetCreature) const;
+    // Object updates are only hooked while there are renames to apply to them.
+    void UpdateHooks();
+
     CExoLocString ContainString(const std::string& str);
     std::string GenerateRandomPlayerName(size_t length);
 
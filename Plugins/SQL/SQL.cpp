@@ -4,6 +4,7 @@
 #include "Targets/SQLite.hpp"
 #include "Services/Config/Config.hpp"
 #include "Services/Metrics/Metrics.hpp"
+#include "Services/Tasks/Tasks.hpp"
 #include "Serialize.hpp"
 #include "Utils.hpp"
 #include "Encoding.hpp"
@@ -12,11 +13,17 @@
 #include "API/CAppManager.hpp"
 #include "API/CServerExoApp.hpp"
 #include "API/CNWSItem.hpp" // Needed for static_cast from CGameObject
+#include "API/CNWSModule.hpp"
 #include <algorithm>
+#include <charconv>
 #include <chrono>
 #include <thread>
 #include <cstring>
 
+#if defined(NWNX_SQL_ZLIB_SUPPORT)
+#include <zlib.h>
+#endif
+
 using namespace NWNXLib;
 
 static SQL::SQL* g_plugin;
@@ -44,6 +51,104 @@ using namespace NWNXLib::Services;
 
 namespace SQL {
 
+// Compressed objects start with this, followed by the uncompressed size and the zlib stream.
+// Base64 never contains a null, and a GFF starts with its file type and "V3.2".
+static constexpr uint8_t COMPRESSED_OBJECT_MAGIC[4] = { 'N', 'X', 'Z', 0 };
+static constexpr size_t COMPRESSED_OBJECT_HEADER_SIZE = 8;
+
+static bool IsCompressedObject(const uint8_t* data, size_t size)
+{
+    return size >= COMPRESSED_OBJECT_HEADER_SIZE && !std::memcmp(data, COMPRESSED_OBJECT_MAGIC, sizeof(COMPRESSED_OBJECT_MAGIC));
+}
+
+static bool IsBinaryObject(const uint8_t* data, size_t size)
+{
+    return IsCompressedObject(data, size) || (size >= 8 && !std::memcmp(data + 4, "V3.2", 4));
+}
+
+static uint8_t HexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return 0;
+}
+
+// PostgreSQL returns bytea columns hex encoded as \x..., which base64 never starts with.
+static bool DecodeByteaHex(std::string_view stored, Blob& decoded)
+{
+    if (stored.size() < 2 || stored[0] != '\\' || stored[1] != 'x')
+        return false;
+
+    decoded.resize((stored.size() - 2) / 2);
+    for (size_t i = 0; i < decoded.size(); i++)
+    {
+        decoded[i] = HexValue(stored[2 + i * 2]) << 4 | HexValue(stored[3 + i * 2]);
+    }
+    return true;
+}
+
+#if defined(NWNX_SQL_ZLIB_SUPPORT)
+static constexpr uint32_t MAX_OBJECT_SIZE = 64 * 1024 * 1024;
+
+static Blob CompressObject(const Blob& serialized)
+{
+    uLongf compressedSize = compressBound(serialized.size());
+    Blob compressed(COMPRESSED_OBJECT_HEADER_SIZE + compressedSize);
+
+    std::memcpy(compressed.data(), COMPRESSED_OBJECT_MAGIC, sizeof(COMPRESSED_OBJECT_MAGIC));
+    const auto size = static_cast<uint32_t>(serialized.size());
+    for (int i = 0; i < 4; i++)
+    {
+        compressed[4 + i] = static_cast<uint8_t>(size >> (i * 8));
+    }
+
+    if (compress2(compressed.data() + COMPRESSED_OBJECT_HEADER_SIZE, &compressedSize,
+            serialized.data(), serialized.size(), Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+        LOG_WARNING("Failed to compress object, storing it uncompressed.");
+        return serialized;
+    }
+
+    compressed.resize(COMPRESSED_OBJECT_HEADER_SIZE + compressedSize);
+    return compressed;
+}
+#endif
+
+static bool DecompressObject(const uint8_t* data, size_t size, Blob& serialized)
+{
+#if defined(NWNX_SQL_ZLIB_SUPPORT)
+    uint32_t uncompressedSize = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        uncompressedSize |= static_cast<uint32_t>(data[4 + i]) << (i * 8);
+    }
+
+    if (uncompressedSize > MAX_OBJECT_SIZE)
+    {
+        LOG_ERROR("Compressed object claims to be %u bytes, refusing to decompress it.", uncompressedSize);
+        return false;
+    }
+
+    serialized.resize(uncompressedSize);
+    uLongf length = uncompressedSize;
+    if (uncompress(serialized.data(), &length, data + COMPRESSED_OBJECT_HEADER_SIZE,
+            size - COMPRESSED_OBJECT_HEADER_SIZE) != Z_OK || length != uncompressedSize)
+    {
+        LOG_ERROR("Failed to decompress object.");
+        return false;
+    }
+    return true;
+#else
+    (void)data; (void)size; (void)serialized;
+    LOG_ERROR("Can't read a compressed object, NWNX_SQL was built without zlib support.");
+    return false;
+#endif
+}
+
 SQL::SQL(const Plugin::CreateParams& params)
     : Plugin(params), m_nextQueryId(0), m_queryMetrics(false)
 {
@@ -57,6 +162,8 @@ SQL::SQL(const Plugin::CreateParams& params)
     REGISTER(ReadyToReadNextRow);
     REGISTER(ReadNextRow);
     REGISTER(ReadDataInActiveRow);
+    REGISTER(ReadIntInActiveRow);
+    REGISTER(ReadFloatInActiveRow);
     REGISTER(PreparedInt);
     REGISTER(PreparedString);
     REGISTER(PreparedFloat);
@@ -68,6 +175,13 @@ SQL::SQL(const Plugin::CreateParams& params)
     REGISTER(DestroyPreparedQuery);
     REGISTER(GetLastError);
     REGISTER(GetPreparedQueryParamCount);
+    REGISTER(ExecutePreparedQueryAsync);
+    REGISTER(ExecuteQueryAsync);
+    REGISTER(GetAsyncQueryId);
+    REGISTER(GetAsyncQuerySucceeded);
+    REGISTER(AddToBatch);
+    REGISTER(ExecutePreparedBatch);
+    REGISTER(ExecutePreparedBatchAsync);
 
 #undef REGISTER
 
@@ -77,16 +191,113 @@ SQL::SQL(const Plugin::CreateParams& params)
     {
         Resamplers::ResamplerFuncPtr sum = &Resamplers::template Sum<int64_t>;
         GetServices()->m_metrics->SetResampler("SQLQueries", sum, std::chrono::seconds(1));
+        GetServices()->m_metrics->SetResampler("SQLStatementCache", sum, std::chrono::seconds(1));
     }
 
-    auto type = GetServices()->m_config->Get<std::string>("TYPE", "MYSQL");
-    std::transform(std::begin(type), std::end(type), std::begin(type), ::toupper);
+    m_defaultConnection = CreateConnection("");
+
+    // Additional connections are configured just like the default one, with their name added
+    // to the variables: NWNX_SQL_CONNECTIONS=LOG gives NWNX_SQL_LOG_TYPE, NWNX_SQL_LOG_HOST, etc.
+    for (auto& name : Utils::split(GetServices()->m_config->Get<std::string>("CONNECTIONS", ""), ','))
+    {
+        std::transform(std::begin(name), std::end(name), std::begin(name), ::toupper);
+
+        if (name != "DEFAULT" && !m_connections.count(name))
+        {
+            m_connections.emplace(name, CreateConnection(name));
+        }
+    }
+}
+
+SQL::~SQL()
+{
+    auto stopWorkers = [](Connection& connection)
+    {
+        {
+            std::lock_guard<std::mutex> lock(connection.m_asyncLock);
+            connection.m_asyncStop = true;
+        }
+        connection.m_asyncSignal.notify_all();
+
+        // Workers drain the queue before exiting, so fire-and-forget writes queued right before
+        // shutdown still make it to the database.
+        for (auto& worker : connection.m_asyncWorkers)
+        {
+            worker.join();
+        }
+    };
+
+    stopWorkers(*m_defaultConnection);
+    for (auto& connection : m_connections)
+    {
+        stopWorkers(*connection.second);
+    }
+}
+
+std::unique_ptr<SQL::Connection> SQL::CreateConnection(const std::string& name)
+{
+    auto connection = std::make_unique<Connection>();
+    connection->m_name = name.empty() ? "DEFAULT" : name;
+
+    if (name.empty())
+    {
+        connection->m_config = GetServices()->m_config.get();
+    }
+    else
+    {
+        connection->m_ownedConfig = std::make_unique<ConfigProxy>(
+            *GetServices()->m_config->GetProxyBase(), "NWNX_SQL_" + name);
+        connection->m_config = connection->m_ownedConfig.get();
+    }
+
+    auto* config = connection->m_config;
+    connection->m_type = config->Get<std::string>("TYPE", "MYSQL");
+    std::transform(std::begin(connection->m_type), std::end(connection->m_type), std::begin(connection->m_type), ::toupper);
+
+    LOG_INFO("Connecting %s to type %s", connection->m_name, connection->m_type);
+
+    connection->m_target = CreateTarget(connection->m_type);
+
+    connection->m_utf8 = config->Get<bool>("USE_UTF8", false);
+    connection->m_binaryObjects = config->Get<bool>("BINARY_OBJECTS", false);
+    connection->m_compressObjects = config->Get<bool>("COMPRESS_OBJECTS", false);
+#if !defined(NWNX_SQL_ZLIB_SUPPORT)
+    if (connection->m_compressObjects)
+    {
+        LOG_WARNING("Object compression for %s requested, but NWNX_SQL was built without zlib support.", connection->m_name);
+        connection->m_compressObjects = false;
+    }
+#endif
+    connection->m_asyncWorkerCount = config->Get<uint32_t>("ASYNC_WORKERS", 1);
+    connection->m_keepAliveInterval = std::chrono::seconds(config->Get<uint32_t>("KEEPALIVE_INTERVAL", 0));
+
+    Reconnect(*connection, connection->m_target.get(), 19);
+    return connection;
+}
+
+SQL::Connection& SQL::GetConnection(ArgumentStack& args)
+{
+    auto name = Events::ExtractArgument<std::string>(args);
+    if (name.empty())
+        return *m_defaultConnection;
+
+    std::transform(std::begin(name), std::end(name), std::begin(name), ::toupper);
+
+    auto it = m_connections.find(name);
+    if (it == std::end(m_connections))
+    {
+        throw std::runtime_error("Unknown connection '" + name + "', add it to NWNX_SQL_CONNECTIONS.");
+    }
 
-    LOG_INFO("Connecting to type %s", type);
+    return *it->second;
+}
+
+std::unique_ptr<ITarget> SQL::CreateTarget(const std::string& type)
+{
     if (type == "MYSQL")
     {
 #if defined(NWNX_SQL_MYSQL_SUPPORT)
-        m_target = std::make_unique<MySQL>();
+        return std::make_unique<MySQL>();
 #else
         throw std::runtime_error("Targeting MySQL, but no MySQL support built in.");
 #endif
@@ -94,7 +305,7 @@ SQL::SQL(const Plugin::CreateParams& params)
     else if (type == "POSTGRESQL")
     {
 #if defined(NWNX_SQL_POSTGRESQL_SUPPORT)
-        m_target = std::make_unique<PostgreSQL>();
+        return std::make_unique<PostgreSQL>();
 #else
         throw std::runtime_error("Targeting PostgreSQL, but no PostgreSQL support built in.");
 #endif
@@ -102,34 +313,27 @@ SQL::SQL(const Plugin::CreateParams& params)
     else if (type == "SQLITE")
     {
 #if defined(NWNX_SQL_SQLITE_SUPPORT)
-        m_target = std::make_unique<SQLite>();
+        return std::make_unique<SQLite>();
 #else
         throw std::runtime_error("Targeting SQLite3, but no SQLite3 support built in.");
 #endif
     }
-    else
-    {
-        throw std::runtime_error("Invalid database type selected.");
-    }
 
-    m_utf8 = GetServices()->m_config->Get<bool>("USE_UTF8", false);
-
-    Reconnect(19);
-}
-
-SQL::~SQL()
-{
+    throw std::runtime_error("Invalid database type selected.");
 }
 
-bool SQL::Reconnect(int32_t attempts)
+// Runs on the main thread for the connection's own target, and on the async workers for theirs.
+// Nothing but the given target is changed, and the attempt count and backoff are local to the call,
+// so workers reconnecting at the same time don't affect each other.
+bool SQL::Reconnect(Connection& connection, ITarget* target, int32_t attempts)
 {
-    LOG_WARNING("Database connection lost. Reconnecting..");
+    LOG_WARNING("Database connection %s lost. Reconnecting..", connection.m_name);
 
     for (int32_t i = 0; i < attempts; i++)
     {
         try
         {
-            m_target->Connect(GetServices()->m_config.get());
+            target->Connect(connection.m_config);
             LOG_NOTICE("Reconnect successful.");
             break;
         }
@@ -138,80 +342,86 @@ bool SQL::Reconnect(int32_t attempts)
             LOG_ERROR("Reconnect attempt %d out of %d failed: %s",
                 i+1, attempts, e.what());
 
-            // NOTE: We are on the main thread and cannot sleep for to long, as
-            // it will stall the entire server. If a reconnect fails here, the
-            // user requested operation will fail as well. It is then up to the
-            // user to retry later (e.g. Use DelayCommand()), and another
-            // reconnect attempt will be triggered automatically.
+            // NOTE: On the main thread we cannot sleep for to long, as it will
+            // stall the entire server, so callers there pass few attempts. If a
+            // reconnect fails, the user requested operation will fail as well.
+            // It is then up to the user to retry later (e.g. Use DelayCommand()),
+            // and another reconnect attempt will be triggered automatically.
+            // The async workers pass more attempts and wait out the full backoff.
             if (i != attempts - 1)
                 std::this_thread::sleep_for(std::chrono::milliseconds(1 << i));
         }
     }
-    return m_target->IsConnected();
+    return target->IsConnected();
 }
 
 Events::ArgumentStack SQL::PrepareQuery(Events::ArgumentStack&& args)
 {
-    m_activeQuery = Events::ExtractArgument<std::string>(args);
+    auto query = Events::ExtractArgument<std::string>(args);
+    auto& connection = GetConnection(args);
 
-    if (m_utf8)
-    {
-        m_activeQuery = Encoding::ToUTF8(m_activeQuery);
-    }
+    connection.m_activeQuery = connection.m_utf8 ? Encoding::ToUTF8(query) : std::move(query);
+    connection.m_activeResults = ResultSet();
+    connection.m_cursorOpen = false;
+    connection.m_nextRowReady = false;
+    connection.m_activeAsyncResult = nullptr;
 
-    m_activeResults = ResultSet();
+    auto* target = connection.m_target.get();
+    const auto cacheHitsBefore = target->GetStatementCacheStats().m_hits;
+    connection.m_queryPrepared = PrepareOnTarget(connection, target, connection.m_activeQuery, 3);
 
-    if (!m_target->IsConnected() && !Reconnect(3))
+    if (m_queryMetrics)
     {
-        LOG_ERROR("Database connection lost. Aborting.");
-        return Events::Arguments(0);
+        PushStatementCacheMetrics(connection, target->GetStatementCacheStats().m_hits != cacheHitsBefore);
     }
 
-    m_queryPrepared = m_target->PrepareQuery(m_activeQuery);
-    return Events::Arguments(static_cast<int32_t>(m_queryPrepared));
+    connection.m_activeParams.assign(connection.m_queryPrepared ? target->GetPreparedQueryParamCount() : 0, QueryParam());
+    connection.m_activeBatch.clear();
+    return Events::Arguments(static_cast<int32_t>(connection.m_queryPrepared));
 }
 
-Events::ArgumentStack SQL::ExecutePreparedQuery(Events::ArgumentStack&&)
+Events::ArgumentStack SQL::ExecutePreparedQuery(Events::ArgumentStack&& args)
 {
-    if (!m_queryPrepared)
+    auto& connection = GetConnection(args);
+    auto* target = connection.m_target.get();
+
+    if (!connection.m_queryPrepared)
     {
         LOG_WARNING("Trying to execute prepared query without successful PrepareQuery() call");
         return Events::Arguments(0);
     }
 
-    // NOTE: There is a time-of-check-to-time-of-use race condition here.
-    // The target may be there at the check, but will go away afterwards.
-    // In these cases the reconnect will not be attempted, and the call will fail.
-    // It is up to the user to check the return value, and repeat the query if needed.
-    if (!m_target->IsConnected())
+    // A lost connection is noticed by the query that fails on it, which then reconnects and
+    // retries once. Only a connection already known to be gone is restored up front.
+    if (!target->IsConnected())
     {
         LOG_DEBUG("Not Connected");
-        if (!Reconnect())
+        if (!Reconnect(connection, target))
         {
             LOG_ERROR("Database connection lost. Aborting.");
             return Events::Arguments(0);
         }
-        else
-        {
-            // Prepared queries are lost on reconnect.
-            // Prepared arguments are not, however, so we can still recover
-            if (!m_target->PrepareQuery(m_activeQuery))
-            {
-                LOG_ERROR("Recovery PrepareQuery() failed: %s", m_target->GetLastError());
-                return Events::Arguments(0);
-            }
 
+        // Prepared queries are lost on reconnect, but we still know the query and its arguments.
+        if (!target->PrepareQuery(connection.m_activeQuery))
+        {
+            LOG_ERROR("Recovery PrepareQuery() failed: %s", target->GetLastError());
+            return Events::Arguments(0);
         }
+        target->BindParams(connection.m_activeParams);
     }
 
     const int32_t queryId = ++m_nextQueryId;
+    connection.m_activeResults = ResultSet();
+    connection.m_nextRowReady = false;
+    connection.m_activeAsyncResult = nullptr;
 
-    std::optional<ResultSet> query;
+    bool querySucceeded;
 
     if (m_queryMetrics)
     {
         const auto timeBefore = std::chrono::high_resolution_clock::now();
-        query = m_target->ExecuteQuery();
+        querySucceeded = ExecuteOnTarget(connection, target, connection.m_activeQuery, connection.m_activeParams, 1);
         const auto timeAfter = std::chrono::high_resolution_clock::now();
 
         using namespace std::chrono;
@@ -220,82 +430,110 @@ Events::ArgumentStack SQL::ExecutePreparedQuery(Events::ArgumentStack&&)
         GetServices()->m_metrics->Push(
             "SQLQueries",
             { { "ns", std::to_string(dur.count()) } },
-            { { "ID", std::to_string(queryId) } });
+            { { "ID", std::to_string(queryId) }, { "Connection", connection.m_name } });
     }
     else
     {
-        query = m_target->ExecuteQuery();
+        querySucceeded = ExecuteOnTarget(connection, target, connection.m_activeQuery, connection.m_activeParams, 1);
     }
 
-    const bool querySucceeded = query.has_value();
-
-    m_activeResults = query.value_or(ResultSet());
+    connection.m_cursorOpen = querySucceeded;
 
     if (querySucceeded)
     {
         // queries that execute commands return the number of affected rows.
         // queries that fetch results return a results size.
-        if (m_target->GetAffectedRows() >= 0)
+        if (target->GetAffectedRows() >= 0)
         {
             // this was not a result set type query
             LOG_INFO("Successful SQL query. Query ID: '%i', Query: '%s', Rows affected: '%u'.",
-                queryId, m_activeQuery, m_target->GetAffectedRows());
+                queryId, connection.m_activeQuery, target->GetAffectedRows());
         }
         else
         {
-            LOG_INFO("Successful SQL query. Query ID: '%i', Query: '%s', Results Count: '%u'.",
-                queryId, m_activeQuery, m_activeResults.size());
+            // Rows are streamed as they are read, so their count isn't known yet.
+            LOG_INFO("Successful SQL query. Query ID: '%i', Query: '%s'.", queryId, connection.m_activeQuery);
         }
     }
     else
     {
-        LOG_WARNING("Failed SQL query. Query ID: '%i', Query: '%s'.", queryId, m_activeQuery);
-        std::string lastError = m_target->GetLastError();
+        LOG_WARNING("Failed SQL query. Query ID: '%i', Query: '%s'.", queryId, connection.m_activeQuery);
+        std::string lastError = target->GetLastError();
         LOG_WARNING("Failure Message. Query ID: '%i', \"%s\"", queryId, lastError);
     }
 
     return Events::Arguments(querySucceeded ? queryId : 0);
 }
 
-Events::ArgumentStack SQL::ReadyToReadNextRow(Events::ArgumentStack&&)
+Events::ArgumentStack SQL::ReadyToReadNextRow(Events::ArgumentStack&& args)
 {
-    return Events::Arguments(m_activeResults.empty() ? 0 : 1);
+    auto& connection = GetConnection(args);
+
+    if (!connection.m_nextRowReady)
+    {
+        connection.m_nextRowReady = FetchNextRow(connection);
+    }
+
+    return Events::Arguments(connection.m_nextRowReady ? 1 : 0);
 }
 
-Events::ArgumentStack SQL::ReadNextRow(Events::ArgumentStack&&)
+Events::ArgumentStack SQL::ReadNextRow(Events::ArgumentStack&& args)
 {
-    if (m_activeResults.empty())
+    auto& connection = GetConnection(args);
+
+    if (!connection.m_nextRowReady && !FetchNextRow(connection))
     {
         throw std::runtime_error("No more rows to read.");
     }
 
-    m_activeRow = std::move(m_activeResults.front());
-    m_activeResults.pop();
+    // The previous row's buffer is reused for the one after.
+    std::swap(connection.m_activeRow, connection.m_nextRow);
+    connection.m_nextRowReady = false;
     return Events::Arguments();
 }
 
 Events::ArgumentStack SQL::ReadDataInActiveRow(Events::ArgumentStack&& args)
 {
     const auto column = static_cast<size_t>(Events::ExtractArgument<int32_t>(args));
+    auto& connection = GetConnection(args);
 
-    if (column >= m_activeRow.size())
-    {
-        throw std::runtime_error("Trying to access column outside of range.");
-    }
+    std::string value(GetActiveColumn(connection, column));
+    return Events::Arguments(connection.m_utf8 ? Encoding::FromUTF8(value) : value);
+}
 
-    return Events::Arguments(m_utf8 ? Encoding::FromUTF8(m_activeRow[column]) : m_activeRow[column]);
+Events::ArgumentStack SQL::ReadIntInActiveRow(Events::ArgumentStack&& args)
+{
+    const auto column = static_cast<size_t>(Events::ExtractArgument<int32_t>(args));
+    const auto value = GetActiveColumn(GetConnection(args), column);
+
+    int32_t retval = 0;
+    std::from_chars(value.data(), value.data() + value.size(), retval);
+    return Events::Arguments(retval);
+}
+
+Events::ArgumentStack SQL::ReadFloatInActiveRow(Events::ArgumentStack&& args)
+{
+    const auto column = static_cast<size_t>(Events::ExtractArgument<int32_t>(args));
+    const auto value = GetActiveColumn(GetConnection(args), column);
+
+    float retval = 0.0f;
+    std::from_chars(value.data(), value.data() + value.size(), retval);
+    return Events::Arguments(retval);
 }
+
 Events::ArgumentStack SQL::PreparedInt(Events::ArgumentStack&& args)
 {
     auto position = Events::ExtractArgument<int32_t>(args);
     auto value = Events::ExtractArgument<int32_t>(args);
-    if (position >= m_target->GetPreparedQueryParamCount())
+    auto& connection = GetConnection(args);
+    if (position >= connection.m_target->GetPreparedQueryParamCount())
     {
         LOG_WARNING("Prepared argument (pos:%d, value:0x%08x) out of bounds", position, value);
     }
     else
     {
-        m_target->PrepareInt(position, value);
+        connection.m_target->PrepareInt(position, value);
+        SetParam(connection, position, value);
     }
     return Events::Arguments();
 }
@@ -303,13 +541,16 @@ Events::ArgumentStack SQL::PreparedString(Events::ArgumentStack&& args)
 {
     auto position = Events::ExtractArgument<int32_t>(args);
     auto value = Events::ExtractArgument<std::string>(args);
-    if (position >= m_target->GetPreparedQueryParamCount())
+    auto& connection = GetConnection(args);
+    if (position >= connection.m_target->GetPreparedQueryParamCount())
     {
         LOG_WARNING("Prepared argument (pos:%d, value:'%s') out of bounds", position, value);
     }
     else
     {
-        m_target->PrepareString(position, m_utf8 ? Encoding::ToUTF8(value) : value);
+        auto converted = connection.m_utf8 ? Encoding::ToUTF8(value) : value;
+        connection.m_target->PrepareString(position, converted);
+        SetParam(connection, position, std::move(converted));
     }
     return Events::Arguments();
 }
@@ -317,13 +558,15 @@ Events::ArgumentStack SQL::PreparedFloat(Events::ArgumentStack&& args)
 {
     auto position = Events::ExtractArgument<int32_t>(args);
     auto value = Events::ExtractArgument<float>(args);
-    if (position >= m_target->GetPreparedQueryParamCount())
+    auto& connection = GetConnection(args);
+    if (position >= connection.m_target->GetPreparedQueryParamCount())
     {
         LOG_WARNING("Prepared argument (pos:%d, value:'%f') out of bounds", position, value);
     }
     else
     {
-        m_target->PrepareFloat(position, value);
+        connection.m_target->PrepareFloat(position, value);
+        SetParam(connection, position, value);
     }
     return Events::Arguments();
 }
@@ -331,15 +574,17 @@ Events::ArgumentStack SQL::PreparedObjectId(Events::ArgumentStack&& args)
 {
     auto position = Events::ExtractArgument<int32_t>(args);
     auto value = Events::ExtractArgument<API::Types::ObjectID>(args);
+    auto& connection = GetConnection(args);
     int32_t valInt;
     std::memcpy(&valInt, &value, sizeof(valInt)); static_assert(sizeof(valInt) == sizeof(value));
-    if (position >= m_target->GetPreparedQueryParamCount())
+    if (position >= connection.m_target->GetPreparedQueryParamCount())
     {
         LOG_WARNING("Prepared argument (pos:%d, value:ObjID-%08x) out of bounds", position, valInt);
     }
     else
     {
-        m_target->PrepareInt(position, valInt);
+        connection.m_target->PrepareInt(position, valInt);
+        SetParam(connection, position, valInt);
     }
     return Events::Arguments();
 }
@@ -347,15 +592,35 @@ Events::ArgumentStack SQL::PreparedObjectFull(Events::ArgumentStack&& args)
 {
     auto position = Events::ExtractArgument<int32_t>(args);
     auto value = Events::ExtractArgument<API::Types::ObjectID>(args);
+    auto& connection = GetConnection(args);
 
-    if (position >= m_target->GetPreparedQueryParamCount())
+    if (position >= connection.m_target->GetPreparedQueryParamCount())
     {
         LOG_WARNING("Prepared argument (pos:%d, value:ObjID-%08x) out of bounds", position, static_cast<int32_t>(value));
     }
     else
     {
         CGameObject *pObject = API::Globals::AppManager()->m_pServerExoApp->GetGameObject(value);
-        m_target->PrepareString(position, SerializeGameObjectB64(pObject));
+        auto serialized = SerializeGameObject(pObject);
+
+#if defined(NWNX_SQL_ZLIB_SUPPORT)
+        if (connection.m_compressObjects && !serialized.empty())
+        {
+            serialized = CompressObject(serialized);
+        }
+#endif
+
+        if (connection.m_binaryObjects)
+        {
+            connection.m_target->PrepareBlob(position, serialized);
+            SetParam(connection, position, std::move(serialized));
+        }
+        else
+        {
+            auto encoded = Encoding::ToBase64(serialized);
+            connection.m_target->PrepareString(position, encoded);
+            SetParam(connection, position, std::move(encoded));
+        }
     }
     return Events::Arguments();
 }
@@ -367,15 +632,35 @@ Events::ArgumentStack SQL::ReadFullObjectInActiveRow(Events::ArgumentStack&& arg
     const auto x = Events::ExtractArgument<float>(args);
     const auto y = Events::ExtractArgument<float>(args);
     const auto z = Events::ExtractArgument<float>(args);
+    auto& connection = GetConnection(args);
 
-    if (column >= m_activeRow.size())
+    // Objects can be stored in any of the formats, so a change of NWNX_SQL_BINARY_OBJECTS or
+    // NWNX_SQL_COMPRESS_OBJECTS doesn't make the objects that are already stored unreadable.
+    const auto stored = GetActiveColumn(connection, column);
+    const auto* data = reinterpret_cast<const uint8_t*>(stored.data());
+    size_t size = stored.size();
+
+    Blob decoded;
+    if (!IsBinaryObject(data, size))
     {
-        throw std::runtime_error("Trying to access column outside of range.");
+        if (!DecodeByteaHex(stored, decoded))
+            decoded = Encoding::FromBase64(std::string(stored));
+        data = decoded.data();
+        size = decoded.size();
+    }
+
+    Blob decompressed;
+    if (IsCompressedObject(data, size))
+    {
+        if (!DecompressObject(data, size, decompressed))
+            return Events::Arguments(API::Constants::OBJECT_INVALID);
+
+        data = decompressed.data();
+        size = decompressed.size();
     }
 
-    std::string serialized = m_activeRow[column];
     API::Types::ObjectID retval = API::Constants::OBJECT_INVALID;
-    if (CGameObject *pObject = DeserializeGameObjectB64(serialized))
+    if (CGameObject *pObject = DeserializeGameObject(data, size))
     {
         retval = static_cast<API::Types::ObjectID>(pObject->m_idSelf);
         ASSERT(API::Globals::AppManager()->m_pServerExoApp->GetGameObject(retval));
@@ -399,31 +684,455 @@ Events::ArgumentStack SQL::ReadFullObjectInActiveRow(Events::ArgumentStack&& arg
     return Events::Arguments(retval);
 }
 
-Events::ArgumentStack SQL::GetAffectedRows(Events::ArgumentStack&&)
+Events::ArgumentStack SQL::GetAffectedRows(Events::ArgumentStack&& args)
 {
-    return Events::Arguments(m_target->GetAffectedRows());
+    auto& connection = GetConnection(args);
+
+    if (connection.m_activeAsyncResult)
+        return Events::Arguments(connection.m_activeAsyncResult->m_affectedRows);
+
+    return Events::Arguments(connection.m_target->GetAffectedRows());
 }
 
-Events::ArgumentStack SQL::GetDatabaseType(Events::ArgumentStack&&)
+Events::ArgumentStack SQL::GetDatabaseType(Events::ArgumentStack&& args)
 {
-    return Events::Arguments(GetServices()->m_config->Get<std::string>("TYPE", "MYSQL"));
+    auto& connection = GetConnection(args);
+    return Events::Arguments(connection.m_config->Get<std::string>("TYPE", "MYSQL"));
 }
 
-Events::ArgumentStack SQL::DestroyPreparedQuery(Events::ArgumentStack&&)
+Events::ArgumentStack SQL::DestroyPreparedQuery(Events::ArgumentStack&& args)
 {
-    m_target->DestroyPreparedQuery();
-    m_queryPrepared = false;
+    auto& connection = GetConnection(args);
+    connection.m_target->DestroyPreparedQuery();
+    connection.m_queryPrepared = false;
+    QueryParams().swap(connection.m_activeParams);
+    std::vector<QueryParams>().swap(connection.m_activeBatch);
     return Events::Arguments();
 }
 
-Events::ArgumentStack SQL::GetLastError(Events::ArgumentStack&&)
+Events::ArgumentStack SQL::GetLastError(Events::ArgumentStack&& args)
 {
-    return Events::Arguments(m_target->GetLastError(true));
+    auto& connection = GetConnection(args);
+
+    if (connection.m_activeAsyncResult)
+        return Events::Arguments(connection.m_activeAsyncResult->m_lastError);
+
+    return Events::Arguments(connection.m_target->GetLastError(true));
 }
 
-Events::ArgumentStack SQL::GetPreparedQueryParamCount(Events::ArgumentStack&&)
+Events::ArgumentStack SQL::GetPreparedQueryParamCount(Events::ArgumentStack&& args)
 {
-    return Events::Arguments(m_queryPrepared ? m_target->GetPreparedQueryParamCount() : -1);
+    auto& connection = GetConnection(args);
+    return Events::Arguments(connection.m_queryPrepared ? connection.m_target->GetPreparedQueryParamCount() : -1);
+}
+
+Events::ArgumentStack SQL::ExecutePreparedQueryAsync(Events::ArgumentStack&& args)
+{
+    const auto callbackScript = Events::ExtractArgument<std::string>(args);
+    const auto callbackOwner = Events::ExtractArgument<API::Types::ObjectID>(args);
+    auto& connection = GetConnection(args);
+
+    if (!connection.m_queryPrepared)
+    {
+        LOG_WARNING("Trying to execute prepared query without successful PrepareQuery() call");
+        return Events::Arguments(0);
+    }
+
+    return Events::Arguments(QueueAsyncQuery(connection,
+        { 0, connection.m_activeQuery, connection.m_activeParams, {}, callbackScript, callbackOwner }));
+}
+
+Events::ArgumentStack SQL::ExecuteQueryAsync(Events::ArgumentStack&& args)
+{
+    auto query = Events::ExtractArgument<std::string>(args);
+    const auto callbackScript = Events::ExtractArgument<std::string>(args);
+    const auto callbackOwner = Events::ExtractArgument<API::Types::ObjectID>(args);
+    auto& connection = GetConnection(args);
+
+    if (connection.m_utf8)
+    {
+        query = Encoding::ToUTF8(query);
+    }
+
+    return Events::Arguments(QueueAsyncQuery(connection, { 0, std::move(query), {}, {}, callbackScript, callbackOwner }));
+}
+
+Events::ArgumentStack SQL::AddToBatch(Events::ArgumentStack&& args)
+{
+    auto& connection = GetConnection(args);
+
+    if (!connection.m_queryPrepared)
+    {
+        LOG_WARNING("Trying to add to a batch without successful PrepareQuery() call");
+        return Events::Arguments(0);
+    }
+
+    connection.m_activeBatch.push_back(connection.m_activeParams);
+    return Events::Arguments(static_cast<int32_t>(connection.m_activeBatch.size()));
+}
+
+Events::ArgumentStack SQL::ExecutePreparedBatch(Events::ArgumentStack&& args)
+{
+    auto& connection = GetConnection(args);
+    auto* target = connection.m_target.get();
+
+    if (!connection.m_queryPrepared || connection.m_activeBatch.empty())
+    {
+        LOG_WARNING("Trying to execute a batch without successful PrepareQuery() and AddToBatch() calls");
+        return Events::Arguments(0);
+    }
+
+    const int32_t queryId = ++m_nextQueryId;
+    connection.m_activeResults = ResultSet();
+    connection.m_cursorOpen = false;
+    connection.m_nextRowReady = false;
+    connection.m_activeAsyncResult = nullptr;
+
+    const auto timeBefore = std::chrono::high_resolution_clock::now();
+    const bool querySucceeded = (target->IsConnected() || Reconnect(connection, target)) &&
+        ExecuteBatchOnTarget(connection, target, connection.m_activeQuery, connection.m_activeBatch, 1);
+    const auto timeAfter = std::chrono::high_resolution_clock::now();
+
+    if (m_queryMetrics)
+    {
+        using namespace std::chrono;
+        nanoseconds dur = duration_cast<nanoseconds>(timeAfter - timeBefore);
+
+        GetServices()->m_metrics->Push(
+            "SQLQueries",
+            { { "ns", std::to_string(dur.count()) }, { "rows", std::to_string(connection.m_activeBatch.size()) } },
+            { { "ID", std::to_string(queryId) }, { "Connection", connection.m_name } });
+    }
+
+    if (querySucceeded)
+    {
+        LOG_INFO("Successful SQL batch. Query ID: '%i', Query: '%s', Rows: '%u', Rows affected: '%i'.",
+            queryId, connection.m_activeQuery, connection.m_activeBatch.size(), target->GetAffectedRows());
+    }
+    else
+    {
+        LOG_WARNING("Failed SQL batch. Query ID: '%i', Query: '%s', Rows: '%u'.",
+            queryId, connection.m_activeQuery, connection.m_activeBatch.size());
+        LOG_WARNING("Failure Message. Query ID: '%i', \"%s\"", queryId, target->GetLastError());
+    }
+
+    connection.m_activeBatch.clear();
+    return Events::Arguments(querySucceeded ? queryId : 0);
+}
+
+Events::ArgumentStack SQL::ExecutePreparedBatchAsync(Events::ArgumentStack&& args)
+{
+    const auto callbackScript = Events::ExtractArgument<std::string>(args);
+    const auto callbackOwner = Events::ExtractArgument<API::Types::ObjectID>(args);
+    auto& connection = GetConnection(args);
+
+    if (!connection.m_queryPrepared || connection.m_activeBatch.empty())
+    {
+        LOG_WARNING("Trying to execute a batch without successful PrepareQuery() and AddToBatch() calls");
+        return Events::Arguments(0);
+    }
+
+    std::vector<QueryParams> batch;
+    batch.swap(connection.m_activeBatch);
+    return Events::Arguments(QueueAsyncQuery(connection,
+        { 0, connection.m_activeQuery, {}, std::move(batch), callbackScript, callbackOwner }));
+}
+
+Events::ArgumentStack SQL::GetAsyncQueryId(Events::ArgumentStack&& args)
+{
+    auto& connection = GetConnection(args);
+    return Events::Arguments(connection.m_activeAsyncResult ? connection.m_activeAsyncResult->m_queryId : 0);
+}
+
+Events::ArgumentStack SQL::GetAsyncQuerySucceeded(Events::ArgumentStack&& args)
+{
+    auto& connection = GetConnection(args);
+    return Events::Arguments(connection.m_activeAsyncResult && connection.m_activeAsyncResult->m_succeeded ? 1 : 0);
+}
+
+bool SQL::PrepareOnTarget(Connection& connection, ITarget* target, const Query& query, int32_t attempts)
+{
+    if (!target->IsConnected() && !Reconnect(connection, target, attempts))
+    {
+        LOG_ERROR("Database connection lost. Aborting.");
+        return false;
+    }
+
+    if (target->PrepareQuery(query))
+        return true;
+
+    // Only worth another try if the failure was the connection going away.
+    return !target->IsConnected() && Reconnect(connection, target, attempts) && target->PrepareQuery(query);
+}
+
+bool SQL::ExecuteOnTarget(Connection& connection, ITarget* target, const Query& query,
+    const QueryParams& params, int32_t attempts)
+{
+    if (target->ExecuteQuery())
+        return true;
+
+    if (target->IsConnected())
+        return false;
+
+    // NOTE: A connection lost mid-query leaves it unknown whether the server ran the query,
+    // so a write can end up applied twice. Idle connections timing out, the common case,
+    // fail before the query is sent.
+    LOG_WARNING("Database connection lost during query. Retrying..");
+    if (!Reconnect(connection, target, attempts) || !target->PrepareQuery(query))
+        return false;
+
+    target->BindParams(params);
+    return target->ExecuteQuery();
+}
+
+bool SQL::ExecuteBatchOnTarget(Connection& connection, ITarget* target, const Query& query,
+    const std::vector<QueryParams>& batch, int32_t attempts)
+{
+    if (target->ExecuteBatch(batch))
+        return true;
+
+    if (target->IsConnected())
+        return false;
+
+    // The batch runs as one transaction, so none of it was applied if the connection went away.
+    LOG_WARNING("Database connection lost during batch. Retrying..");
+    if (!Reconnect(connection, target, attempts) || !target->PrepareQuery(query))
+        return false;
+
+    return target->ExecuteBatch(batch);
+}
+
+void SQL::PushStatementCacheMetrics(const Connection& connection, bool hit)
+{
+    GetServices()->m_metrics->Push(
+        "SQLStatementCache",
+        { { "hits", hit ? "1" : "0" }, { "misses", hit ? "0" : "1" } },
+        { { "Connection", connection.m_name } });
+}
+
+bool SQL::FetchNextRow(Connection& connection)
+{
+    if (connection.m_activeAsyncResult)
+    {
+        if (connection.m_activeResults.empty())
+            return false;
+
+        connection.m_nextRow = std::move(connection.m_activeResults.front());
+        connection.m_activeResults.pop();
+        return true;
+    }
+
+    if (connection.m_cursorOpen && connection.m_target->FetchRow(connection.m_nextRow))
+        return true;
+
+    connection.m_cursorOpen = false;
+    return false;
+}
+
+std::string_view SQL::GetActiveColumn(const Connection& connection, size_t column)
+{
+    if (column >= connection.m_activeRow.GetColumnCount())
+    {
+        throw std::runtime_error("Trying to access column outside of range.");
+    }
+
+    return connection.m_activeRow.GetColumn(column);
+}
+
+void SQL::SetParam(Connection& connection, int32_t position, QueryParam&& value)
+{
+    if (position >= 0 && static_cast<size_t>(position) < connection.m_activeParams.size())
+    {
+        connection.m_activeParams[position] = std::move(value);
+    }
+}
+
+int32_t SQL::QueueAsyncQuery(Connection& connection, AsyncQuery&& query)
+{
+    if (connection.m_asyncWorkerCount == 0)
+    {
+        LOG_WARNING("Async queries are disabled, set NWNX_SQL_ASYNC_WORKERS to enable them.");
+        return 0;
+    }
+
+    if (connection.m_asyncWorkers.empty())
+    {
+        StartAsyncWorkers(connection);
+    }
+
+    query.m_queryId = ++m_nextQueryId;
+    const int32_t queryId = query.m_queryId;
+
+    {
+        std::lock_guard<std::mutex> lock(connection.m_asyncLock);
+        connection.m_asyncQueue.emplace_back(std::move(query));
+    }
+    connection.m_asyncSignal.notify_one();
+
+    return queryId;
+}
+
+void SQL::StartAsyncWorkers(Connection& connection)
+{
+    LOG_INFO("Starting %u async query workers.", connection.m_asyncWorkerCount);
+
+    // The connections are made by the workers themselves, so the main thread never waits on them.
+    for (size_t i = 0; i < connection.m_asyncWorkerCount; i++)
+    {
+        connection.m_asyncTargets.emplace_back(CreateTarget(connection.m_type));
+        connection.m_asyncWorkers.emplace_back(&SQL::AsyncWorker, this, &connection, connection.m_asyncTargets.back().get());
+    }
+}
+
+void SQL::AsyncWorker(Connection* connection, ITarget* target)
+{
+    Reconnect(*connection, target, 10);
+
+    std::unique_lock<std::mutex> lock(connection->m_asyncLock);
+
+    while (true)
+    {
+        const auto hasWork = [connection]() { return connection->m_asyncStop || !connection->m_asyncQueue.empty(); };
+
+        if (connection->m_keepAliveInterval.count() == 0)
+        {
+            connection->m_asyncSignal.wait(lock, hasWork);
+        }
+        else if (!connection->m_asyncSignal.wait_for(lock, connection->m_keepAliveInterval, hasWork))
+        {
+            // Idle for a whole interval, make sure the server hasn't dropped the connection meanwhile.
+            lock.unlock();
+            if (!target->Ping())
+            {
+                Reconnect(*connection, target, 10);
+            }
+            lock.lock();
+            continue;
+        }
+
+        if (connection->m_asyncQueue.empty())
+            break;
+
+        auto query = std::make_shared<AsyncQuery>(std::move(connection->m_asyncQueue.front()));
+        connection->m_asyncQueue.pop_front();
+        lock.unlock();
+
+        auto result = std::make_shared<AsyncResult>();
+        result->m_queryId = query->m_queryId;
+        result->m_succeeded = false;
+        result->m_affectedRows = -1;
+        result->m_statementCacheHit = false;
+
+        const auto timeBefore = std::chrono::high_resolution_clock::now();
+
+        RunAsyncQuery(*connection, target, *query, *result);
+
+        result->m_duration = std::chrono::high_resolution_clock::now() - timeBefore;
+
+        GetServices()->m_tasks->QueueOnMainThread([this, connection, query, result]()
+        {
+            CompleteAsyncQuery(*connection, *query, *result);
+        });
+
+        lock.lock();
+    }
+}
+
+void SQL::RunAsyncQuery(Connection& connection, ITarget* target, const AsyncQuery& query, AsyncResult& result)
+{
+    // Off the main thread we can afford to wait out a reconnect with a full backoff.
+    const auto cacheHitsBefore = target->GetStatementCacheStats().m_hits;
+    if (!PrepareOnTarget(connection, target, query.m_query, 10))
+    {
+        result.m_lastError = target->IsConnected() ? target->GetLastError(true) : "Database connection lost.";
+        return;
+    }
+    result.m_statementCacheHit = target->GetStatementCacheStats().m_hits != cacheHitsBefore;
+
+    if (!query.m_batch.empty())
+    {
+        result.m_succeeded = ExecuteBatchOnTarget(connection, target, query.m_query, query.m_batch, 10);
+        result.m_affectedRows = target->GetAffectedRows();
+        if (!result.m_succeeded)
+        {
+            result.m_lastError = target->GetLastError(true);
+        }
+
+        target->DestroyPreparedQuery();
+        return;
+    }
+
+    target->BindParams(query.m_params);
+
+    if (ExecuteOnTarget(connection, target, query.m_query, query.m_params, 10))
+    {
+        // The rows have to be collected here, the callback runs on the main thread.
+        ResultRow row;
+        while (target->FetchRow(row))
+        {
+            result.m_results.push(std::move(row));
+        }
+
+        result.m_succeeded = true;
+        result.m_affectedRows = target->GetAffectedRows();
+    }
+    else
+    {
+        result.m_lastError = target->GetLastError(true);
+    }
+
+    target->DestroyPreparedQuery();
+}
+
+void SQL::CompleteAsyncQuery(Connection& connection, AsyncQuery& query, AsyncResult& result)
+{
+    if (m_queryMetrics)
+    {
+        PushStatementCacheMetrics(connection, result.m_statementCacheHit);
+
+        GetServices()->m_metrics->Push(
+            "SQLQueries",
+            { { "ns", std::to_string(result.m_duration.count()) } },
+            { { "ID", std::to_string(result.m_queryId) }, { "Async", "true" }, { "Connection", connection.m_name } });
+    }
+
+    if (result.m_succeeded)
+    {
+        LOG_INFO("Successful async SQL query. Query ID: '%i', Query: '%s', Rows affected: '%i', Results Count: '%u'.",
+            result.m_queryId, query.m_query, result.m_affectedRows, result.m_results.size());
+    }
+    else
+    {
+        LOG_WARNING("Failed async SQL query. Query ID: '%i', Query: '%s'.", result.m_queryId, query.m_query);
+        LOG_WARNING("Failure Message. Query ID: '%i', \"%s\"", result.m_queryId, result.m_lastError);
+    }
+
+    if (query.m_callbackScript.empty())
+        return;
+
+    // Install the results as the active ones of the connection so the callback can use the regular
+    // row reading functions, and put back whatever was active before once it is done.
+    auto* previousAsyncResult = connection.m_activeAsyncResult;
+    ResultRow previousRow = std::move(connection.m_activeRow);
+    ResultRow previousNextRow = std::move(connection.m_nextRow);
+    const bool previousNextRowReady = connection.m_nextRowReady;
+    std::swap(connection.m_activeResults, result.m_results);
+    connection.m_activeRow = ResultRow();
+    connection.m_nextRow = ResultRow();
+    connection.m_nextRowReady = false;
+    connection.m_activeAsyncResult = &result;
+
+    const auto owner = query.m_callbackOwner == API::Constants::OBJECT_INVALID
+        ? Utils::GetModule()->m_idSelf
+        : query.m_callbackOwner;
+    Utils::ExecuteScript(query.m_callbackScript, owner);
+
+    // A cursor that was open stays readable, unless the callback ran a query of its own on this connection.
+    connection.m_activeAsyncResult = previousAsyncResult;
+    std::swap(connection.m_activeResults, result.m_results);
+    connection.m_activeRow = std::move(previousRow);
+    connection.m_nextRow = std::move(previousNextRow);
+    connection.m_nextRowReady = previousNextRowReady;
 }
 
 }
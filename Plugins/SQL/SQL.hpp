@@ -4,7 +4,13 @@
 #include "Services/Events/Events.hpp"
 #include "Targets/ITarget.hpp"
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 using ArgumentStack = NWNXLib::Services::Events::ArgumentStack;
 
@@ -21,6 +27,8 @@ public:
     ArgumentStack ReadyToReadNextRow            (ArgumentStack&& args);
     ArgumentStack ReadNextRow                   (ArgumentStack&& args);
     ArgumentStack ReadDataInActiveRow           (ArgumentStack&& args);
+    ArgumentStack ReadIntInActiveRow            (ArgumentStack&& args);
+    ArgumentStack ReadFloatInActiveRow          (ArgumentStack&& args);
     ArgumentStack PreparedInt                   (ArgumentStack&& args);
     ArgumentStack PreparedString                (ArgumentStack&& args);
     ArgumentStack PreparedFloat                 (ArgumentStack&& args);
@@ -32,18 +40,100 @@ public:
     ArgumentStack DestroyPreparedQuery          (ArgumentStack&& args);
     ArgumentStack GetLastError                  (ArgumentStack&& args);
     ArgumentStack GetPreparedQueryParamCount    (ArgumentStack&& args);
+    ArgumentStack ExecutePreparedQueryAsync     (ArgumentStack&& args);
+    ArgumentStack ExecuteQueryAsync             (ArgumentStack&& args);
+    ArgumentStack GetAsyncQueryId               (ArgumentStack&& args);
+    ArgumentStack GetAsyncQuerySucceeded        (ArgumentStack&& args);
+    ArgumentStack AddToBatch                    (ArgumentStack&& args);
+    ArgumentStack ExecutePreparedBatch          (ArgumentStack&& args);
+    ArgumentStack ExecutePreparedBatchAsync     (ArgumentStack&& args);
 private:
-    bool Reconnect(int32_t attempts = 1);
+    struct AsyncQuery
+    {
+        int32_t m_queryId;
+        Query m_query;
+        QueryParams m_params;
+        std::vector<QueryParams> m_batch;
+        std::string m_callbackScript;
+        NWNXLib::API::Types::ObjectID m_callbackOwner;
+    };
+
+    struct AsyncResult
+    {
+        int32_t m_queryId;
+        bool m_succeeded;
+        ResultSet m_results;
+        int m_affectedRows;
+        std::string m_lastError;
+        std::chrono::nanoseconds m_duration;
+        bool m_statementCacheHit;
+    };
+
+    // Everything a script works with is per connection, so scripts using different connections,
+    // such as an event script running a query in the middle of another one, never see each other's state.
+    struct Connection
+    {
+        std::string m_name;
+        std::string m_type;
+        NWNXLib::Services::ConfigProxy* m_config;
+        std::unique_ptr<NWNXLib::Services::ConfigProxy> m_ownedConfig;
+        bool m_utf8;
+        bool m_binaryObjects;
+        bool m_compressObjects;
+
+        std::unique_ptr<ITarget> m_target;
+        Query m_activeQuery;
+        QueryParams m_activeParams;
+        std::vector<QueryParams> m_activeBatch;
+        ResultRow m_activeRow;
+        bool m_queryPrepared = false;
+
+        // Rows of a query on m_target are streamed from its cursor. One row is fetched ahead
+        // to answer ReadyToReadNextRow(). Async query results arrive whole, in m_activeResults.
+        bool m_cursorOpen = false;
+        ResultRow m_nextRow;
+        bool m_nextRowReady = false;
+        ResultSet m_activeResults;
+        AsyncResult* m_activeAsyncResult = nullptr;
+
+        // Async queries run on their own connections, one per worker thread, so a slow query
+        // never holds up the main thread. Completion is handed back through the main thread task queue.
+        size_t m_asyncWorkerCount;
+        std::chrono::seconds m_keepAliveInterval;
+        std::vector<std::unique_ptr<ITarget>> m_asyncTargets;
+        std::vector<std::thread> m_asyncWorkers;
+        std::deque<AsyncQuery> m_asyncQueue;
+        std::mutex m_asyncLock;
+        std::condition_variable m_asyncSignal;
+        bool m_asyncStop = false;
+    };
+
+    std::unique_ptr<Connection> CreateConnection(const std::string& name);
+    Connection& GetConnection(ArgumentStack& args);
+    std::unique_ptr<ITarget> CreateTarget(const std::string& type);
+    bool Reconnect(Connection& connection, ITarget* target, int32_t attempts = 1);
+    void PushStatementCacheMetrics(const Connection& connection, bool hit);
+    bool PrepareOnTarget(Connection& connection, ITarget* target, const Query& query, int32_t attempts);
+    bool ExecuteOnTarget(Connection& connection, ITarget* target, const Query& query,
+        const QueryParams& params, int32_t attempts);
+    bool ExecuteBatchOnTarget(Connection& connection, ITarget* target, const Query& query,
+        const std::vector<QueryParams>& batch, int32_t attempts);
+    bool FetchNextRow(Connection& connection);
+    std::string_view GetActiveColumn(const Connection& connection, size_t column);
+    void SetParam(Connection& connection, int32_t position, QueryParam&& value);
+    int32_t QueueAsyncQuery(Connection& connection, AsyncQuery&& query);
+    void StartAsyncWorkers(Connection& connection);
+    void AsyncWorker(Connection* connection, ITarget* target);
+    void RunAsyncQuery(Connection& connection, ITarget* target, const AsyncQuery& query, AsyncResult& result);
+    void CompleteAsyncQuery(Connection& connection, AsyncQuery& query, AsyncResult& result);
+
+    // The default connection is named DEFAULT and configured by the plain NWNX_SQL_* variables.
+    // Scripts reach it by passing an empty connection name.
+    std::unique_ptr<Connection> m_defaultConnection;
+    std::unordered_map<std::string, std::unique_ptr<Connection>> m_connections;
 
-    std::unique_ptr<ITarget> m_target;
-    Query m_activeQuery;
-    ResultSet m_activeResults;
-    ResultRow m_activeRow;
     int32_t m_nextQueryId;
     bool m_queryMetrics;
-    bool m_queryPrepared;
-    bool m_utf8;
 };
 
 }
-
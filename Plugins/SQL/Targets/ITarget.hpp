@@ -4,31 +4,112 @@
 
 #include <queue>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
 #include <vector>
 #include <optional>
 
 namespace SQL {
 
 using Query = std::string;
-using Result = std::string;
-using ResultRow = std::vector<Result>;
-using ResultSet = std::queue<ResultRow>; // Queue is row, vector is column
+using Blob = std::vector<uint8_t>;
+using QueryParam = std::variant<std::monostate, int32_t, float, std::string, Blob>;
+using QueryParams = std::vector<QueryParam>;
+
+// A single row of results. All columns share one buffer, which keeps its capacity when the
+// row is cleared and refilled, so reading row after row doesn't allocate once it has grown.
+class ResultRow
+{
+public:
+    void Clear()
+    {
+        m_buffer.clear();
+        m_columns.clear();
+    }
+
+    // Adds a column of the given length and returns where its data goes. The pointer is only
+    // valid until the next column is added.
+    char* AddColumn(size_t length)
+    {
+        const size_t offset = m_buffer.size();
+        m_columns.emplace_back(offset, length);
+        m_buffer.resize(offset + length);
+        return m_buffer.data() + offset;
+    }
+
+    void AddColumn(const char* data, size_t length)
+    {
+        m_columns.emplace_back(m_buffer.size(), length);
+        m_buffer.append(data, length);
+    }
+
+    size_t GetColumnCount() const { return m_columns.size(); }
+
+    // Views are valid until the row is cleared.
+    std::string_view GetColumn(size_t column) const
+    {
+        return std::string_view(m_buffer.data() + m_columns[column].first, m_columns[column].second);
+    }
+
+private:
+    std::string m_buffer;
+    std::vector<std::pair<size_t, size_t>> m_columns; // Offset and length into m_buffer
+};
+
+using ResultSet = std::queue<ResultRow>;
+
+struct StatementCacheStats
+{
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+    uint64_t m_evictions = 0;
+};
 
 struct ITarget
 {
     virtual ~ITarget() { }
     virtual void Connect(NWNXLib::Services::ConfigProxy* config) = 0;
+    // Must not talk to the server, a connection is only known to be lost once a query fails on it.
     virtual bool IsConnected() = 0;
+    virtual bool Ping() = 0;
     virtual bool PrepareQuery(const Query& query) = 0;
-    virtual std::optional<ResultSet> ExecuteQuery() = 0;
+    // Rows of a successful query are streamed from the server with FetchRow(). Preparing or
+    // executing another query discards the ones that weren't read.
+    virtual bool ExecuteQuery() = 0;
+    // Returns false once there are no more rows, or if fetching failed (see GetLastError()).
+    virtual bool FetchRow(ResultRow& row) = 0;
     virtual void PrepareInt(int32_t position, int32_t value) = 0;
     virtual void PrepareFloat(int32_t position, float value) = 0;
     virtual void PrepareString(int32_t position, const std::string& value) = 0;
+    // Bound as binary data. Binary columns (BLOB, bytea) are read back as their raw bytes.
+    virtual void PrepareBlob(int32_t position, const Blob& value) = 0;
+    // Runs the prepared query once for each row of values, as a single transaction unless one is
+    // already open. GetAffectedRows() returns the total afterwards.
+    virtual bool ExecuteBatch(const std::vector<QueryParams>& rows) = 0;
     virtual int  GetAffectedRows() = 0;
     virtual std::string GetLastError(bool bClear = false) = 0;
     virtual int32_t GetPreparedQueryParamCount() = 0;
+    // Rows of a query that are still being read stay readable until they run out.
     virtual void DestroyPreparedQuery() = 0;
+    virtual const StatementCacheStats& GetStatementCacheStats() = 0;
 
+    // Values that were never bound are left alone.
+    void BindParams(const QueryParams& params)
+    {
+        for (size_t i = 0; i < params.size(); i++)
+        {
+            const auto position = static_cast<int32_t>(i);
+            if (auto* value = std::get_if<int32_t>(&params[i]))
+                PrepareInt(position, *value);
+            else if (auto* value = std::get_if<float>(&params[i]))
+                PrepareFloat(position, *value);
+            else if (auto* value = std::get_if<std::string>(&params[i]))
+                PrepareString(position, *value);
+            else if (auto* value = std::get_if<Blob>(&params[i]))
+                PrepareBlob(position, *value);
+        }
+    }
 };
 
 }
@@ -3,25 +3,147 @@
 #include "MySQL.hpp"
 #include "Services/Config/Config.hpp"
 
+#include <algorithm>
 #include <string.h>
+#include <strings.h>
 
 namespace SQL {
 
+// MySQL allows at most 65535 placeholders per statement, this keeps the statements of a batch
+// well below max_allowed_packet as well.
+static constexpr size_t MAX_ROWS_PER_INSERT = 1000;
+
+static size_t SkipQuoted(const Query& query, size_t pos)
+{
+    const char quote = query[pos];
+    for (++pos; pos < query.size(); ++pos)
+    {
+        if (query[pos] == '\\' && quote != '`')
+            ++pos;
+        else if (query[pos] == quote)
+            return pos + 1;
+    }
+    return pos;
+}
+
+static size_t CountPlaceholders(const Query& query, size_t begin, size_t end)
+{
+    size_t count = 0;
+    for (size_t pos = begin; pos < end;)
+    {
+        const char c = query[pos];
+        if (c == '\'' || c == '"' || c == '`')
+        {
+            pos = SkipQuoted(query, pos);
+            continue;
+        }
+        if (c == '?')
+            ++count;
+        ++pos;
+    }
+    return count;
+}
+
+// Finds the value tuple of a single row "INSERT ... VALUES (...)" that holds all of its placeholders,
+// so the tuple can be repeated to insert many rows with one statement.
+static bool FindInsertValues(const Query& query, size_t paramCount, size_t& tupleBegin, size_t& tupleEnd)
+{
+    const size_t start = query.find_first_not_of(" \t\r\n");
+    if (start == Query::npos ||
+        (strncasecmp(query.c_str() + start, "INSERT", 6) && strncasecmp(query.c_str() + start, "REPLACE", 7)))
+    {
+        return false;
+    }
+
+    tupleBegin = Query::npos;
+    for (size_t pos = start; pos < query.size();)
+    {
+        const char c = query[pos];
+        if (c == '\'' || c == '"' || c == '`')
+        {
+            pos = SkipQuoted(query, pos);
+            continue;
+        }
+
+        if (!strncasecmp(query.c_str() + pos, "VALUES", 6) && (pos == 0 || !isalnum(query[pos - 1])))
+        {
+            tupleBegin = query.find_first_not_of(" \t\r\n", pos + 6);
+            break;
+        }
+        ++pos;
+    }
+
+    if (tupleBegin == Query::npos || query[tupleBegin] != '(')
+        return false;
+
+    int depth = 0;
+    for (size_t pos = tupleBegin; pos < query.size();)
+    {
+        const char c = query[pos];
+        if (c == '\'' || c == '"' || c == '`')
+        {
+            pos = SkipQuoted(query, pos);
+            continue;
+        }
+
+        ++pos;
+        if (c == '(')
+        {
+            ++depth;
+        }
+        else if (c == ')' && --depth == 0)
+        {
+            tupleEnd = pos;
+            break;
+        }
+    }
+
+    if (depth != 0)
+        return false;
+
+    // Already a multi-row insert
+    const size_t next = query.find_first_not_of(" \t\r\n", tupleEnd);
+    if (next != Query::npos && query[next] == ',')
+        return false;
+
+    return CountPlaceholders(query, tupleBegin, tupleEnd) == paramCount &&
+           CountPlaceholders(query, 0, query.size()) == paramCount;
+}
+
 MySQL::MySQL()
+    : m_statementCache([](MYSQL_STMT*& stmt) { mysql_stmt_close(stmt); })
 {
     mysql_init(&m_mysql);
     m_stmt = nullptr;
+    m_stmtCached = false;
+    m_connected = false;
+    m_cursorOpen = false;
+    m_destroyPending = false;
     m_lastError = "";
     m_paramCount = 0;
 }
 
 MySQL::~MySQL()
 {
+    FinishQuery();
+    ReleaseStatement();
+    m_statementCache.Clear();
     mysql_close(&m_mysql);
 }
 
 void MySQL::Connect(NWNXLib::Services::ConfigProxy* config)
 {
+    // Statements belong to the connection they were prepared on.
+    FinishQuery();
+    ReleaseStatement();
+    m_statementCache.Clear();
+    m_statementCache.SetCapacity(config->Get<uint32_t>("STATEMENT_CACHE_SIZE", 64));
+
+    // Start from a fresh handle, a lost connection can't be reused.
+    m_connected = false;
+    mysql_close(&m_mysql);
+    mysql_init(&m_mysql);
+
     const auto host     = config->Get<std::string>("HOST", "localhost");
     const auto port     = config->Get<int32_t>("PORT", 0);
     const auto username = config->Require<std::string>("USERNAME");
@@ -47,138 +169,356 @@ void MySQL::Connect(NWNXLib::Services::ConfigProxy* config)
         if (mysql_set_character_set(&m_mysql, charset->c_str()))
             LOG_ERROR("Unable to set the character set");
     }
+
+    m_connected = true;
 }
 
 bool MySQL::IsConnected()
 {
-    bool bConnected = mysql_query(&m_mysql, "SELECT 1") == 0;
+    return m_connected;
+}
 
-    // Need to read the result before running any other queries.
-    mysql_free_result(mysql_store_result(&m_mysql));
+bool MySQL::Ping()
+{
+    FinishQuery();
+
+    if (m_connected && mysql_ping(&m_mysql))
+    {
+        CheckConnectionError(mysql_errno(&m_mysql));
+    }
+    return m_connected;
+}
 
-    if (!bConnected)
+void MySQL::CheckConnectionError(unsigned int error)
+{
+    switch (error)
     {
-        LOG_WARNING("Disconnected state identified.");
+        case CR_SERVER_GONE_ERROR:
+        case CR_SERVER_LOST:
+        case CR_SERVER_LOST_EXTENDED:
+        case CR_CONNECTION_ERROR:
+        case CR_CONN_HOST_ERROR:
+            LOG_WARNING("Disconnected state identified.");
+            m_connected = false;
+            break;
+        default:
+            break;
     }
-    return bConnected;
 }
 
 bool MySQL::PrepareQuery(const Query& query)
 {
     LOG_DEBUG("Preparing query %s\n", query);
 
-    if (m_stmt)
-        mysql_stmt_close(m_stmt);
-
-    m_stmt = mysql_stmt_init(&m_mysql);
-    if (!m_stmt)
-    {
-        m_lastError.assign(mysql_error(&m_mysql));
-        LOG_WARNING("Failed to initialize statement: %s", m_lastError);
-        return false;
-    }
+    FinishQuery();
+    ReleaseStatement();
 
-    bool success = !mysql_stmt_prepare(m_stmt, query.c_str(), query.size());
-    if (success)
+    if (auto* cached = m_statementCache.Find(query))
     {
-        m_paramCount = mysql_stmt_param_count(m_stmt);
-        LOG_DEBUG("Detected %d parameters.", m_paramCount);
-        m_params.resize(m_paramCount);
-        m_paramValues.resize(m_paramCount);
+        m_stmt = *cached;
+        m_stmtCached = true;
     }
     else
     {
-        m_lastError.assign(mysql_stmt_error(m_stmt));
-        LOG_WARNING("Failed to prepare statement: %s", m_lastError);
-        mysql_stmt_close(m_stmt);
-        m_stmt = nullptr;
+        m_stmt = mysql_stmt_init(&m_mysql);
+        if (!m_stmt)
+        {
+            m_lastError.assign(mysql_error(&m_mysql));
+            LOG_WARNING("Failed to initialize statement: %s", m_lastError);
+            CheckConnectionError(mysql_errno(&m_mysql));
+            return false;
+        }
+
+        if (mysql_stmt_prepare(m_stmt, query.c_str(), query.size()))
+        {
+            m_lastError.assign(mysql_stmt_error(m_stmt));
+            LOG_WARNING("Failed to prepare statement: %s", m_lastError);
+            CheckConnectionError(mysql_stmt_errno(m_stmt));
+            mysql_stmt_close(m_stmt);
+            m_stmt = nullptr;
+            return false;
+        }
+
+        MYSQL_STMT* stmt = m_stmt;
+        m_stmtCached = m_statementCache.Insert(query, std::move(stmt)) != nullptr;
     }
-    return success;
+
+    m_query = query;
+    m_paramCount = mysql_stmt_param_count(m_stmt);
+    LOG_DEBUG("Detected %d parameters.", m_paramCount);
+    m_params.resize(m_paramCount);
+    m_paramValues.resize(m_paramCount);
+    return true;
 }
 
-std::optional<ResultSet> MySQL::ExecuteQuery()
+bool MySQL::ExecuteQuery()
 {
+    FinishQuery();
     affectedRows = -1;
 
+    if (!m_stmt)
+    {
+        m_lastError = "No prepared query to execute.";
+        return false;
+    }
+
     bool success = !mysql_stmt_bind_param(m_stmt, m_params.data());
     if (!success)
     {
         LOG_WARNING("Failed to bind params");
-        m_lastError.assign(mysql_error(&m_mysql));
-        return std::optional<ResultSet>(); // Failed query.
+        m_lastError.assign(mysql_stmt_error(m_stmt));
+        return false; // Failed query.
     }
 
     success = !mysql_stmt_execute(m_stmt);
 
-    if (success)
+    if (!success)
     {
-        MYSQL_RES* mysqlResult = mysql_stmt_result_metadata(m_stmt);
+        const char* error = mysql_stmt_error(m_stmt);
+        CheckConnectionError(mysql_stmt_errno(m_stmt));
 
-        if (mysqlResult)
+        if (*error == '\0')
         {
-            ResultSet results;
-            const unsigned columns = mysql_num_fields(mysqlResult);
-            mysql_stmt_store_result(m_stmt);
+            // No valid error.
+            error = "Undefined/unknown";
+        }
 
-            std::vector<char> buffer(64);
-            while (true)
-            {
-                ResultRow row;
-                row.reserve(columns);
-
-                MYSQL_BIND binds[columns];
-                memset(binds, 0, sizeof(binds));
-                unsigned long lengths[columns];
-                memset(lengths, 0, sizeof(lengths));
-                for (unsigned i = 0; i < columns; i++)
-                    binds[i].length = &lengths[i];
-                mysql_stmt_bind_result(m_stmt, binds);
-
-                int fetchResult = mysql_stmt_fetch(m_stmt);
-                if (fetchResult == MYSQL_NO_DATA) {
-                    break;
-                }
-                else if (fetchResult == 1) {
-                    LOG_WARNING("Error executing mysql_stmt_fetch - error: '%s'", mysql_error(&m_mysql));
-                    m_lastError.assign(mysql_error(&m_mysql));
-                    break;
-                }
+        LOG_WARNING("Query failed due to error '%s'", error);
+        m_lastError.assign(error);
+        return false; // Failed query.
+    }
 
-                for (unsigned i = 0; i < columns; i++)
-                {
-                    buffer.reserve(lengths[i]);
-                    binds[i].buffer = buffer.data();
-                    binds[i].buffer_length = buffer.capacity();
-                    mysql_stmt_fetch_column(m_stmt, &binds[i], i, 0);
-                    row.emplace_back(Result(buffer.data(), lengths[i]));
-                }
-                results.push(row);
-            }
-            mysql_free_result(mysqlResult);
-            mysql_stmt_free_result(m_stmt);
-            return std::make_optional<ResultSet>(std::move(results)); // Succeeded query, succeeded results.
-        }
+    MYSQL_RES* mysqlResult = mysql_stmt_result_metadata(m_stmt);
+
+    if (!mysqlResult)
+    {
         // Statement returned no rows (INSERT, UPDATE, DELETE, etc.)
         affectedRows = static_cast<int>(mysql_affected_rows(&m_mysql));
-        return std::make_optional<ResultSet>(ResultSet()); // Succeeded query, no results.
+        return true; // Succeeded query, no results.
     }
 
-    if (!success)
+    const unsigned columns = mysql_num_fields(mysqlResult);
+    mysql_free_result(mysqlResult);
+
+    // Rows are left on the server and fetched one at a time. Only the column lengths are fetched
+    // along with the row, the data then goes straight into the row buffer with mysql_stmt_fetch_column().
+    m_resultBinds.assign(columns, MYSQL_BIND());
+    m_resultLengths.assign(columns, 0);
+    for (unsigned i = 0; i < columns; i++)
+        m_resultBinds[i].length = &m_resultLengths[i];
+    mysql_stmt_bind_result(m_stmt, m_resultBinds.data());
+
+    m_cursorOpen = true;
+    return true; // Succeeded query, rows are fetched as they are read.
+}
+
+bool MySQL::FetchRow(ResultRow& row)
+{
+    if (!m_cursorOpen)
+        return false;
+
+    const int fetchResult = mysql_stmt_fetch(m_stmt);
+    if (fetchResult == MYSQL_NO_DATA || fetchResult == 1)
     {
-        const char* error = mysql_error(&m_mysql);
+        if (fetchResult == 1)
+        {
+            m_lastError.assign(mysql_stmt_error(m_stmt));
+            LOG_WARNING("Error executing mysql_stmt_fetch - error: '%s'", m_lastError);
+            CheckConnectionError(mysql_stmt_errno(m_stmt));
+        }
 
-        if (*error == '\0')
+        FinishQuery();
+        return false;
+    }
+
+    row.Clear();
+
+    for (unsigned i = 0; i < m_resultBinds.size(); i++)
+    {
+        const unsigned long length = m_resultLengths[i];
+
+        MYSQL_BIND bind = m_resultBinds[i];
+        bind.buffer = row.AddColumn(length);
+        bind.buffer_length = length;
+        if (length)
+            mysql_stmt_fetch_column(m_stmt, &bind, i, 0);
+    }
+
+    return true;
+}
+
+bool MySQL::ExecuteBatch(const std::vector<QueryParams>& rows)
+{
+    FinishQuery();
+    affectedRows = -1;
+
+    if (!m_stmt)
+    {
+        m_lastError = "No prepared query to execute.";
+        return false;
+    }
+
+    // Starting a transaction would implicitly commit the one that is already open.
+    const bool ownTransaction = !(m_mysql.server_status & SERVER_STATUS_IN_TRANS);
+    if (ownTransaction && !ExecuteStatement("START TRANSACTION"))
+        return false;
+
+    int64_t totalAffectedRows = 0;
+    size_t tupleBegin, tupleEnd;
+    bool success = m_paramCount > 0 && FindInsertValues(m_query, m_paramCount, tupleBegin, tupleEnd)
+        ? ExecuteMultiRowInsert(rows, tupleBegin, tupleEnd, totalAffectedRows)
+        : ExecuteEachRow(rows, totalAffectedRows);
+
+    if (ownTransaction)
+    {
+        if (success)
+            success = ExecuteStatement("COMMIT");
+        else
+            ExecuteStatement("ROLLBACK");
+    }
+
+    affectedRows = success ? static_cast<int>(totalAffectedRows) : -1;
+    return success;
+}
+
+bool MySQL::ExecuteEachRow(const std::vector<QueryParams>& rows, int64_t& totalAffectedRows)
+{
+    for (const auto& row : rows)
+    {
+        BindParams(row);
+
+        if (!ExecuteQuery())
+            return false;
+
+        totalAffectedRows += std::max(affectedRows, 0);
+        FinishQuery();
+    }
+    return true;
+}
+
+bool MySQL::ExecuteMultiRowInsert(const std::vector<QueryParams>& rows, size_t tupleBegin, size_t tupleEnd,
+    int64_t& totalAffectedRows)
+{
+    const size_t maxRows = std::min(MAX_ROWS_PER_INSERT, 65535 / m_paramCount);
+    const std::string_view head(m_query.data(), tupleBegin);
+    const std::string_view tuple(m_query.data() + tupleBegin, tupleEnd - tupleBegin);
+    const std::string_view tail(m_query.data() + tupleEnd, m_query.size() - tupleEnd);
+
+    MYSQL_STMT* stmt = nullptr;
+    size_t stmtRows = 0;
+    std::vector<MYSQL_BIND> binds;
+    bool success = true;
+
+    for (size_t first = 0; first < rows.size();)
+    {
+        const size_t count = std::min(maxRows, rows.size() - first);
+
+        // All chunks but the last are the same size and share a statement.
+        if (count != stmtRows)
         {
-            // No valid error.
-            error = "Undefined/unknown";
+            if (stmt)
+                mysql_stmt_close(stmt);
+
+            std::string query;
+            query.reserve(head.size() + count * (tuple.size() + 2) + tail.size());
+            query.append(head);
+            for (size_t i = 0; i < count; i++)
+            {
+                if (i)
+                    query.append(", ");
+                query.append(tuple);
+            }
+            query.append(tail);
+
+            stmt = mysql_stmt_init(&m_mysql);
+            if (!stmt)
+            {
+                m_lastError.assign(mysql_error(&m_mysql));
+                CheckConnectionError(mysql_errno(&m_mysql));
+                success = false;
+                break;
+            }
+
+            if (mysql_stmt_prepare(stmt, query.c_str(), query.size()))
+            {
+                m_lastError.assign(mysql_stmt_error(stmt));
+                CheckConnectionError(mysql_stmt_errno(stmt));
+                success = false;
+                break;
+            }
+
+            stmtRows = count;
+            binds.resize(count * m_paramCount);
         }
 
-        LOG_WARNING("Query failed due to error '%s'", error);
-        m_lastError.assign(error);
+        // The values are bound where they are, the rows outlive the statement.
+        for (size_t row = 0; row < count; row++)
+        {
+            const auto& values = rows[first + row];
+            for (size_t param = 0; param < m_paramCount; param++)
+            {
+                MYSQL_BIND& bind = binds[row * m_paramCount + param];
+                memset(&bind, 0, sizeof(bind));
+
+                const QueryParam* value = param < values.size() ? &values[param] : nullptr;
+                if (auto* n = value ? std::get_if<int32_t>(value) : nullptr)
+                {
+                    bind.buffer_type = MYSQL_TYPE_LONG;
+                    bind.buffer = const_cast<int32_t*>(n);
+                }
+                else if (auto* f = value ? std::get_if<float>(value) : nullptr)
+                {
+                    bind.buffer_type = MYSQL_TYPE_FLOAT;
+                    bind.buffer = const_cast<float*>(f);
+                }
+                else if (auto* str = value ? std::get_if<std::string>(value) : nullptr)
+                {
+                    bind.buffer_type = MYSQL_TYPE_STRING;
+                    bind.buffer = const_cast<char*>(str->data());
+                    bind.buffer_length = str->size();
+                }
+                else if (auto* blob = value ? std::get_if<Blob>(value) : nullptr)
+                {
+                    bind.buffer_type = MYSQL_TYPE_BLOB;
+                    bind.buffer = const_cast<uint8_t*>(blob->data());
+                    bind.buffer_length = blob->size();
+                }
+                else
+                {
+                    bind.buffer_type = MYSQL_TYPE_NULL;
+                }
+            }
+        }
+
+        if (mysql_stmt_bind_param(stmt, binds.data()) || mysql_stmt_execute(stmt))
+        {
+            m_lastError.assign(mysql_stmt_error(stmt));
+            LOG_WARNING("Batch insert failed due to error '%s'", m_lastError);
+            CheckConnectionError(mysql_stmt_errno(stmt));
+            success = false;
+            break;
+        }
 
+        totalAffectedRows += static_cast<int64_t>(mysql_stmt_affected_rows(stmt));
+        first += count;
     }
 
-    return std::optional<ResultSet>(); // Failed query.
+    if (stmt)
+        mysql_stmt_close(stmt);
+
+    return success;
+}
+
+bool MySQL::ExecuteStatement(const char* statement)
+{
+    if (mysql_query(&m_mysql, statement))
+    {
+        m_lastError.assign(mysql_error(&m_mysql));
+        LOG_WARNING("%s failed due to error '%s'", statement, m_lastError);
+        CheckConnectionError(mysql_errno(&m_mysql));
+        return false;
+    }
+    return true;
 }
 
 void MySQL::PrepareInt(int32_t position, int32_t value)
@@ -227,6 +567,22 @@ void MySQL::PrepareString(int32_t position, const std::string& value)
     pBind->buffer = (void*)m_paramValues[pos].s.c_str();
     pBind->buffer_length = m_paramValues[pos].s.size();
 }
+void MySQL::PrepareBlob(int32_t position, const Blob& value)
+{
+    LOG_DEBUG("Assigning position %d to %u bytes", position, value.size());
+
+    ASSERT_OR_THROW(position >= 0);
+    size_t pos = static_cast<size_t>(position);
+
+    MYSQL_BIND *pBind = &m_params[pos];
+    memset(pBind, 0, sizeof(*pBind));
+
+    m_paramValues[pos].s.assign(value.begin(), value.end());
+
+    pBind->buffer_type = MYSQL_TYPE_BLOB;
+    pBind->buffer = m_paramValues[pos].s.data();
+    pBind->buffer_length = m_paramValues[pos].s.size();
+}
 
 int MySQL::GetAffectedRows()
 {
@@ -250,10 +606,16 @@ int32_t MySQL::GetPreparedQueryParamCount()
 
 void MySQL::DestroyPreparedQuery()
 {
+    // Rows that are still being read need the statement.
+    if (m_cursorOpen)
+    {
+        m_destroyPending = true;
+        return;
+    }
+
     if (m_stmt)
     {
-        mysql_stmt_close(m_stmt);
-        m_stmt = nullptr;
+        ReleaseStatement();
 
         // Force deallocation
         std::vector<MYSQL_BIND>().swap(m_params);
@@ -262,6 +624,37 @@ void MySQL::DestroyPreparedQuery()
     }
 }
 
+const StatementCacheStats& MySQL::GetStatementCacheStats()
+{
+    return m_statementCache.GetStats();
+}
+
+void MySQL::FinishQuery()
+{
+    if (m_cursorOpen)
+    {
+        // Also discards the rows that weren't fetched from the server.
+        mysql_stmt_free_result(m_stmt);
+        m_cursorOpen = false;
+    }
+
+    if (m_destroyPending)
+    {
+        m_destroyPending = false;
+        DestroyPreparedQuery();
+    }
+}
+
+void MySQL::ReleaseStatement()
+{
+    // Cached statements are owned by the cache and stay prepared for the next use.
+    if (m_stmt && !m_stmtCached)
+        mysql_stmt_close(m_stmt);
+
+    m_stmt = nullptr;
+    m_stmtCached = false;
+}
+
 }
 
 #endif
@@ -5,6 +5,7 @@
 #include "mysql/mysql.h"
 #include "mysql/errmsg.h"
 #include "Targets/ITarget.hpp"
+#include "Targets/StatementCache.hpp"
 
 namespace SQL {
 
@@ -16,20 +17,37 @@ public:
 
     virtual void Connect(NWNXLib::Services::ConfigProxy* config) override;
     virtual bool IsConnected() override;
+    virtual bool Ping() override;
     virtual bool PrepareQuery(const Query& query) override;
-    virtual std::optional<ResultSet> ExecuteQuery() override;
+    virtual bool ExecuteQuery() override;
+    virtual bool FetchRow(ResultRow& row) override;
     virtual void PrepareInt(int32_t position, int32_t value) override;
     virtual void PrepareFloat(int32_t position, float value) override;
     virtual void PrepareString(int32_t position, const std::string& value) override;
+    virtual void PrepareBlob(int32_t position, const Blob& value) override;
+    virtual bool ExecuteBatch(const std::vector<QueryParams>& rows) override;
     virtual int  GetAffectedRows() override;
     virtual std::string GetLastError(bool bClear = false) override;
     virtual int32_t GetPreparedQueryParamCount() override;
     virtual void DestroyPreparedQuery() override;
+    virtual const StatementCacheStats& GetStatementCacheStats() override;
 
 
 private:
+    void ReleaseStatement();
+    void CheckConnectionError(unsigned int error);
+    void FinishQuery();
+    bool ExecuteEachRow(const std::vector<QueryParams>& rows, int64_t& totalAffectedRows);
+    bool ExecuteMultiRowInsert(const std::vector<QueryParams>& rows, size_t tupleBegin, size_t tupleEnd,
+        int64_t& totalAffectedRows);
+    bool ExecuteStatement(const char* statement);
+
     MYSQL m_mysql;
+    bool m_connected;
     MYSQL_STMT *m_stmt;
+    Query m_query;
+    bool m_stmtCached;
+    StatementCache<MYSQL_STMT*> m_statementCache;
     std::vector<MYSQL_BIND> m_params;
     size_t m_paramCount;
     std::string m_lastError;
@@ -40,6 +58,11 @@ private:
     };
     std::vector<Variant> m_paramValues;
     int affectedRows;
+
+    std::vector<MYSQL_BIND> m_resultBinds;
+    std::vector<unsigned long> m_resultLengths;
+    bool m_cursorOpen;
+    bool m_destroyPending;
 };
 
 }
@@ -1,5 +1,6 @@
 #if defined(NWNX_SQL_POSTGRESQL_SUPPORT)
 
+#include <algorithm>
 #include <iostream>
 #include <cstdlib>
 #include <regex>
@@ -10,17 +11,34 @@
 namespace SQL {
 
 PostgreSQL::PostgreSQL()
+    : m_statementCache([this](PreparedStatement& stmt)
+        {
+            if (m_conn)
+                PQclear(PQexec(m_conn, ("DEALLOCATE " + stmt.m_name).c_str()));
+        })
 {
-    // Not sure if we need to do anything here.
 }
 
 PostgreSQL::~PostgreSQL()
 {
+    PQclear(m_pendingRow);
     PQfinish(m_conn);
+    m_conn = nullptr;
+    m_statementCache.Clear();
 }
 
 void PostgreSQL::Connect(NWNXLib::Services::ConfigProxy* config)
 {
+    // Named statements live in the server session, so they are gone along with the old connection.
+    PQclear(m_pendingRow);
+    m_pendingRow = nullptr;
+    m_cursorOpen = false;
+    PQfinish(m_conn);
+    m_conn = nullptr;
+    m_statementCache.Clear();
+    m_statementCache.SetCapacity(config->Get<uint32_t>("STATEMENT_CACHE_SIZE", 64));
+    m_stmtName.clear();
+
     const std::string host = "host=" + config->Get<std::string>("HOST", "localhost");
     const std::string user = "user=" + config->Require<std::string>("USERNAME");
     const std::string pass = "password=" + config->Require<std::string>("PASSWORD");
@@ -57,20 +75,32 @@ void PostgreSQL::Connect(NWNXLib::Services::ConfigProxy* config)
 
 bool PostgreSQL::IsConnected()
 {
+    // libpq marks the connection as bad as soon as a query fails on a lost connection.
+    return m_conn && PQstatus(m_conn) == CONNECTION_OK;
+}
+
+bool PostgreSQL::Ping()
+{
+    if (!m_conn)
+        return false;
+
+    FinishQuery();
+
     /*
      * Executing a query between a unmamed prepare and execute apparently resets the
-     * unnamed query.  Using a named query forces you to execute a DEALLOCATE after you're
-     * done or old queries will pile up forever.
-     *
-     * PQping is simpler, but probably less robust.  It does actively ping the server, though.
+     * unnamed query, so this must only be called between queries.
      */
-    bool bConnected = true;
+    PGresult *res = PQexec(m_conn, "SELECT 1");
+    PQclear(res);
+    return CheckConnection();
+}
 
-    PGPing ping = PQping(m_connectString.c_str());
-    if (ping != PQPING_OK)
+bool PostgreSQL::CheckConnection()
+{
+    const bool bConnected = IsConnected();
+    if (!bConnected)
     {
         LOG_WARNING("Disconnected state identified.");
-        bConnected = false;
     }
     return bConnected;
 }
@@ -79,8 +109,18 @@ bool PostgreSQL::PrepareQuery(const Query& query)
 {
     LOG_DEBUG("Preparing query %s\n", query);
 
+    FinishQuery();
     m_affectedRows = -1;
 
+    if (auto* cached = m_statementCache.Find(query))
+    {
+        m_stmtName = cached->m_name;
+        m_paramCount = cached->m_paramCount;
+        m_params.resize(m_paramCount);
+        m_paramFormats.assign(m_paramCount, 0);
+        return true;
+    }
+
     /*
      * Determine the number of parameters in the query.
      *
@@ -98,9 +138,13 @@ bool PostgreSQL::PrepareQuery(const Query& query)
     LOG_DEBUG("Detected %d parameters.", m_paramCount);
 
     m_params.resize(m_paramCount);
+    m_paramFormats.assign(m_paramCount, 0);
+
+    // Cached statements need a name to outlive the next prepare, uncached ones use the unnamed statement.
+    m_stmtName = m_statementCache.GetCapacity() > 0 ? "nwnx_stmt_" + std::to_string(++m_nextStatementId) : "";
 
     PGresult *res = PQprepare(m_conn,      // connection
-                        "",                // statement name, blank in this case.
+                        m_stmtName.c_str(),// statement name, blank if not cached.
                         query.c_str(),     // query string
                         m_paramCount,      // param count
                         NULL);             // param types (can be null to infer)
@@ -108,114 +152,314 @@ bool PostgreSQL::PrepareQuery(const Query& query)
     if (res == NULL)
     {
         LOG_WARNING("Possible out of memory condition on DB server.");
+        CheckConnection();
         return false;
     }
 
     if (PQresultStatus(res) != PGRES_COMMAND_OK)
     {
+        SetLastError(res);
         PQclear(res);
-        LOG_WARNING("Query '%s' failed due to error '%s'", query, PQresultErrorMessage(res));
+        LOG_WARNING("Query '%s' failed due to error '%s'", query, m_lastError);
 
         return false;
     }
 
     PQclear(res);
+
+    if (!m_stmtName.empty())
+    {
+        m_statementCache.Insert(query, { m_stmtName, m_paramCount });
+    }
+
     return true;
 }
 
-std::optional<ResultSet> PostgreSQL::ExecuteQuery()
+bool PostgreSQL::ExecuteQuery()
 {
-
+    FinishQuery();
     m_affectedRows = -1;
 
-    char** paramValues = nullptr;
+    UpdateParamValues();
+
+    LOG_DEBUG("Executing query with %d parameters", m_paramCount);
+
+    const int sent = PQsendQueryPrepared(
+        m_conn,                                 // connection
+        m_stmtName.c_str(),                     // statement name (same as in the prepare above)
+        m_paramCount,                           // m_paramCount from previous
+        m_paramValues.data(),                   // param data (can be null)
+        m_paramLengths.data(),                  // param lengths - only used for binary data
+        m_paramFormats.data(),                  // param formats - blobs are binary, the rest text
+        0);                                     // result format, 0=text, 1=binary
+
+    if (!sent)
+    {
+        SetLastError(nullptr);
+        LOG_WARNING("Query failed due to error '%s'", m_lastError);
+        return false;
+    }
+
+    // Have libpq hand the rows over one at a time as they arrive, instead of collecting them all first.
+    PQsetSingleRowMode(m_conn);
+    m_cursorOpen = true;
 
-    // convert the m_params vector into a char ** required by Postgres.
-    if (m_paramCount > 0)
+    PGresult *res = PQgetResult(m_conn);
+
+    switch (PQresultStatus(res))
     {
-        LOG_DEBUG("Preparing query with %d parameters", m_paramCount);
-        paramValues = new char*[m_params.size()];
+        case PGRES_SINGLE_TUPLE:
+            // Rows returned - kept until they are fetched
+            m_pendingRow = res;
+            return true;
+
+        case PGRES_TUPLES_OK:
+            // Query that returns rows, but there were none.
+            PQclear(res);
+            FinishQuery();
+            return true;
+
+        case PGRES_COMMAND_OK:
+        {
+            // DML that doesn't return rows (inserts, updates, etc.)
+            // Capture the rows affected if applicable.
+            LOG_DEBUG("Fetching rows affected by command.");
+            const char *cnt = PQcmdTuples(res);
+            if (*cnt != '\0')
+            {
+                m_affectedRows = atoi(cnt);
+            }
+            PQclear(res);
+            FinishQuery();
+            return true;
+        }
 
-        const unsigned int sz = m_params.size();
-        for (unsigned int i=0; i<sz; i++)
+        default:
+            // Else.. something unexpected happened.
+            SetLastError(res);
+            LOG_WARNING("Query failed due to error '%s'", m_lastError);
+            PQclear(res);
+            FinishQuery();
+            return false;
+    }
+}
+
+bool PostgreSQL::FetchRow(ResultRow& row)
+{
+    if (!m_cursorOpen)
+        return false;
+
+    PGresult *res = m_pendingRow ? m_pendingRow : PQgetResult(m_conn);
+    m_pendingRow = nullptr;
+
+    // The rows are followed by an empty PGRES_TUPLES_OK result, unless something went wrong.
+    if (PQresultStatus(res) != PGRES_SINGLE_TUPLE)
+    {
+        if (res && PQresultStatus(res) != PGRES_TUPLES_OK)
         {
-            paramValues[i] = new char[m_params[i].size()+1];
-            strcpy(paramValues[i], m_params[i].c_str());
+            SetLastError(res);
+            LOG_WARNING("Fetching row failed due to error '%s'", m_lastError);
         }
+
+        PQclear(res);
+        FinishQuery();
+        return false;
     }
 
-    PGresult *res = PQexecPrepared(
-        m_conn,                                 // connection
-        "",                                     // statement name (same as in the prepare above)
-        m_paramCount,                           // m_paramCount from previous
-        paramValues,                            // param data (can be null)
-        NULL,                                   // param lengths - only for binary data
-        NULL,                                   // param formats - server will infer text
-        0);                                     // result format, 0=text, 1=binary
+    row.Clear();
+
+    const int cols = PQnfields(res);
+    for (int j = 0; j < cols; j++)
+    {
+        row.AddColumn(PQgetvalue(res, 0, j), PQgetlength(res, 0, j));
+    }
+
+    PQclear(res);
+    return true;
+}
+
+bool PostgreSQL::ExecuteBatch(const std::vector<QueryParams>& rows)
+{
+    FinishQuery();
+    m_affectedRows = -1;
+
+#if defined(LIBPQ_HAS_PIPELINING)
+    // The rows are sent back to back without waiting for each result, and everything up to the
+    // sync runs in one implicit transaction unless a transaction is already open.
+    if (!PQenterPipelineMode(m_conn))
+    {
+        SetLastError(nullptr);
+        LOG_WARNING("Batch failed due to error '%s'", m_lastError);
+        return false;
+    }
 
-    // done with parameters.
-    if (paramValues != nullptr)
+    bool success = true;
+    size_t queued = 0;
+    for (const auto& row : rows)
     {
-        for (unsigned i = 0; i < m_params.size(); i++)
+        BindParams(row);
+        UpdateParamValues();
+
+        if (!PQsendQueryPrepared(m_conn, m_stmtName.c_str(), m_paramCount,
+                m_paramValues.data(), m_paramLengths.data(), m_paramFormats.data(), 0))
         {
-            delete [] paramValues[i];
+            SetLastError(nullptr);
+            success = false;
+
+            // Whatever made it into the pipeline must not be committed by the sync.
+            if (PQsendQueryParams(m_conn, "ROLLBACK", 0, NULL, NULL, NULL, NULL, 0))
+                ++queued;
+            break;
         }
-        delete [] paramValues;
+        ++queued;
     }
 
-    // Rows returned - collect and pass on
-    if (PQresultStatus(res) == PGRES_TUPLES_OK)
+    if (!PQpipelineSync(m_conn) && success)
     {
-        ResultSet results;
-        const size_t rows = PQntuples(res);
-        const size_t cols = PQnfields(res);
-        LOG_DEBUG("Returning %d rows of %d columns.", rows, cols);
+        SetLastError(nullptr);
+        success = false;
+    }
 
-        for(int i=0; i<(int)rows; i++)
+    // Every query's results are terminated by a null result. Once one fails, the rest are aborted.
+    int affectedRows = 0;
+    for (size_t i = 0; i < queued; i++)
+    {
+        while (PGresult *res = PQgetResult(m_conn))
         {
-            ResultRow row;
-            row.reserve(cols);
-            for (int j=0; j<(int)cols; j++)
+            const auto status = PQresultStatus(res);
+            if (status == PGRES_COMMAND_OK)
+            {
+                const char *cnt = PQcmdTuples(res);
+                if (*cnt != '\0')
+                {
+                    affectedRows += atoi(cnt);
+                }
+            }
+            else if (status != PGRES_TUPLES_OK && success)
             {
-                row.emplace_back(Result(PQgetvalue(res, i, j), PQgetlength(res, i, j)));
+                SetLastError(res);
+                success = false;
             }
-            results.push(row);
+            PQclear(res);
         }
+    }
 
-        PQclear(res);
-        return std::make_optional<ResultSet>(std::move(results)); // Succeeded query, succeeded results.
+    PGresult *sync = PQgetResult(m_conn);
+    if (PQresultStatus(sync) != PGRES_PIPELINE_SYNC && success)
+    {
+        SetLastError(sync);
+        success = false;
+    }
+    PQclear(sync);
+
+    if (!PQexitPipelineMode(m_conn) && success)
+    {
+        SetLastError(nullptr);
+        success = false;
+    }
+
+    if (!success)
+    {
+        LOG_WARNING("Batch failed due to error '%s'", m_lastError);
     }
+#else
+    // Outside of a transaction every statement commits on its own.
+    const bool ownTransaction = PQtransactionStatus(m_conn) == PQTRANS_IDLE;
+    if (ownTransaction && !ExecuteStatement("BEGIN"))
+        return false;
 
-    // DML that doesn't return rows (inserts, updates, etc.)
-    // Capture the rows affected if applicable.
-    if (PQresultStatus(res) == PGRES_COMMAND_OK)
+    int affectedRows = 0;
+    bool success = true;
+
+    for (const auto& row : rows)
     {
-        LOG_DEBUG("Fetching rows affected by command.");
-        const char *cnt = PQcmdTuples(res);
-        if (*cnt != '\0')
+        BindParams(row);
+
+        if (!ExecuteQuery())
         {
-            m_affectedRows = atoi(cnt);
+            success = false;
+            break;
         }
+
+        affectedRows += std::max(m_affectedRows, 0);
+        FinishQuery();
+    }
+
+    if (ownTransaction)
+    {
+        if (success)
+            success = ExecuteStatement("COMMIT");
+        else
+            ExecuteStatement("ROLLBACK");
+    }
+#endif
+
+    m_affectedRows = success ? affectedRows : -1;
+    return success;
+}
+
+bool PostgreSQL::ExecuteStatement(const char* statement)
+{
+    PGresult *res = PQexec(m_conn, statement);
+    const bool success = PQresultStatus(res) == PGRES_COMMAND_OK;
+    if (!success)
+    {
+        SetLastError(res);
+        LOG_WARNING("%s failed due to error '%s'", statement, m_lastError);
+    }
+    PQclear(res);
+    return success;
+}
+
+void PostgreSQL::FinishQuery()
+{
+    if (!m_cursorOpen)
+        return;
+
+    PQclear(m_pendingRow);
+    m_pendingRow = nullptr;
+
+    // libpq won't accept another command until every result of this one has been collected.
+    while (PGresult *res = PQgetResult(m_conn))
+    {
         PQclear(res);
-        return std::make_optional<ResultSet>(ResultSet()); // Succeeded query, no results.
     }
 
-    // Else.. something unexpected happened.
+    m_cursorOpen = false;
+}
+
+void PostgreSQL::UpdateParamValues()
+{
+    // The values only need to stay alive while the query is sent, m_params owns them until then.
+    m_paramValues.resize(m_params.size());
+    m_paramLengths.resize(m_params.size());
+    for (size_t i = 0; i < m_params.size(); i++)
+    {
+        m_paramValues[i] = m_params[i].c_str();
+        m_paramLengths[i] = static_cast<int>(m_params[i].size());
+    }
+}
+
+void PostgreSQL::SetLastError(PGresult *res)
+{
+    const char* error = res ? PQresultErrorField(res, PG_DIAG_MESSAGE_PRIMARY) : nullptr;
+
+    CheckConnection();
 
-    const char* error = PQresultErrorField(res, PG_DIAG_MESSAGE_PRIMARY);
+    if (error == nullptr)
+    {
+        error = PQerrorMessage(m_conn);
+    }
 
-    if (*error == '\0')
+    if (error == nullptr || *error == '\0')
     {
         // No valid error.
         error = "Undefined/unknown";
     }
 
     // Save a copy of the error.  In PgSQL, the error comes from the result we got from the server,
-    // which we're about to clear.
+    // which is about to be cleared.
     m_lastError.assign(error);
-
-    PQclear(res);
-    return std::optional<ResultSet>();
 }
 
 // Parameters are just passed as strings.  PgSQL figures out what it's supposed to be and casts if necessary.
@@ -223,16 +467,25 @@ void PostgreSQL::PrepareInt(int32_t position, int32_t value)
 {
     LOG_DEBUG("Assigning position %d to value '%d'", position, value);
     m_params[position] = std::to_string(value);
+    m_paramFormats[position] = 0;
 }
 void PostgreSQL::PrepareFloat(int32_t position, float value)
 {
     LOG_DEBUG("Assigning position %d to value '%f'", position, value);
     m_params[position] = std::to_string(value);
+    m_paramFormats[position] = 0;
 }
 void PostgreSQL::PrepareString(int32_t position, const std::string& value)
 {
     LOG_DEBUG("Assigning position %d to value '%s'", position, value);
     m_params[position] = value;
+    m_paramFormats[position] = 0;
+}
+void PostgreSQL::PrepareBlob(int32_t position, const Blob& value)
+{
+    LOG_DEBUG("Assigning position %d to %u bytes", position, value.size());
+    m_params[position].assign(value.begin(), value.end());
+    m_paramFormats[position] = 1;
 }
 
 int PostgreSQL::GetAffectedRows()
@@ -258,11 +511,19 @@ int32_t PostgreSQL::GetPreparedQueryParamCount()
 void PostgreSQL::DestroyPreparedQuery()
 {
     // No way or need to deallocate the anonymous prepared statement in PgSQL.
+    // Named statements stay in the cache until they are evicted.
+    m_stmtName.clear();
 
     // Force deallocation
     std::vector<std::string>().swap(m_params);
+    std::vector<int>().swap(m_paramFormats);
     m_paramCount = 0;
 }
 
+const StatementCacheStats& PostgreSQL::GetStatementCacheStats()
+{
+    return m_statementCache.GetStats();
+}
+
 }
 #endif
@@ -4,6 +4,7 @@
 
 #include <libpq-fe.h>
 #include "Targets/ITarget.hpp"
+#include "Targets/StatementCache.hpp"
 
 namespace SQL {
 
@@ -15,21 +16,46 @@ public:
 
     virtual void Connect(NWNXLib::Services::ConfigProxy* config) override;
     virtual bool IsConnected() override;
+    virtual bool Ping() override;
     virtual bool PrepareQuery(const Query& query) override;
-    virtual std::optional<ResultSet> ExecuteQuery() override;
+    virtual bool ExecuteQuery() override;
+    virtual bool FetchRow(ResultRow& row) override;
     virtual void PrepareInt(int32_t position, int32_t value) override;
     virtual void PrepareFloat(int32_t position, float value) override;
     virtual void PrepareString(int32_t position, const std::string& value) override;
+    virtual void PrepareBlob(int32_t position, const Blob& value) override;
+    virtual bool ExecuteBatch(const std::vector<QueryParams>& rows) override;
     virtual int  GetAffectedRows() override;
     virtual std::string GetLastError(bool bClear = false) override;
     virtual int32_t GetPreparedQueryParamCount() override;
     virtual void DestroyPreparedQuery() override;
+    virtual const StatementCacheStats& GetStatementCacheStats() override;
 
 private:
-    PGconn *m_conn;
+    bool CheckConnection();
+    void FinishQuery();
+    void UpdateParamValues();
+    bool ExecuteStatement(const char* statement);
+    void SetLastError(PGresult *res);
+
+    struct PreparedStatement
+    {
+        std::string m_name;
+        size_t m_paramCount;
+    };
+
+    PGconn *m_conn = nullptr;
+    std::string m_stmtName;
+    uint32_t m_nextStatementId = 0;
+    StatementCache<PreparedStatement> m_statementCache;
     int m_affectedRows = -1;
     size_t m_paramCount = 0;
     std::vector<std::string> m_params;
+    std::vector<int> m_paramFormats; // 0 for text, 1 for binary
+    std::vector<const char*> m_paramValues;
+    std::vector<int> m_paramLengths;
+    PGresult *m_pendingRow = nullptr;
+    bool m_cursorOpen = false;
     std::string m_lastError;
     std::string m_connectString;
 };
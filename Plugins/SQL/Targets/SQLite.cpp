@@ -6,6 +6,7 @@
 #include "API/CExoBase.hpp"
 #include "Utils.hpp"
 
+#include <algorithm>
 #include <sqlite3.h>
 
 namespace SQL {
@@ -14,21 +15,38 @@ using namespace NWNXLib;
 using namespace NWNXLib::API;
 
 SQLite::SQLite()
+    : m_statementCache([](sqlite3_stmt*& stmt) { sqlite3_finalize(stmt); })
 {
     m_dbName = "database";
+    m_dbConn = nullptr;
     m_stmt = nullptr;
+    m_stmtCached = false;
     m_lastError = "";
     m_paramCount = 0;
+    m_affectedRows = -1;
+    m_cursorOpen = false;
+    m_rowPending = false;
+    m_destroyPending = false;
 }
 
 SQLite::~SQLite()
 {
-    sqlite3_finalize(m_stmt);
+    FinishQuery();
+    ReleaseStatement();
+    m_statementCache.Clear();
     sqlite3_close(m_dbConn);
 }
 
 void SQLite::Connect(NWNXLib::Services::ConfigProxy* config)
 {
+    // Statements belong to the connection they were prepared on.
+    FinishQuery();
+    ReleaseStatement();
+    m_statementCache.Clear();
+    m_statementCache.SetCapacity(config->Get<uint32_t>("STATEMENT_CACHE_SIZE", 64));
+    sqlite3_close(m_dbConn);
+    m_dbConn = nullptr;
+
     if (auto database = config->Get<std::string>("DATABASE"))
     {
         m_dbName = database->c_str();
@@ -37,66 +55,95 @@ void SQLite::Connect(NWNXLib::Services::ConfigProxy* config)
     }
 
     // Save the database file to UserDirectory/database
-    static std::string dbPath = Globals::ExoBase()->m_sUserDirectory.CStr() + std::string("/database/")
+    const std::string dbPath = Globals::ExoBase()->m_sUserDirectory.CStr() + std::string("/database/")
             + m_dbName + std::string(".sqlite3nwnxee");
 
     if (sqlite3_open(dbPath.c_str(), &m_dbConn))
     {
-        throw std::runtime_error(std::string(sqlite3_errmsg(m_dbConn)));
+        std::string error = sqlite3_errmsg(m_dbConn);
+        sqlite3_close(m_dbConn);
+        m_dbConn = nullptr;
+        throw std::runtime_error(error);
     }
 
+    // Async workers open their own connections to the same file, wait for their writes instead of failing with SQLITE_BUSY.
+    sqlite3_busy_timeout(m_dbConn, config->Get<int32_t>("BUSY_TIMEOUT", 1000));
 }
 
 bool SQLite::IsConnected()
 {
-    bool bConnected = sqlite3_exec(m_dbConn, "SELECT 1", nullptr, nullptr, nullptr) == SQLITE_OK;
-
-    if (!bConnected)
-    {
-        LOG_WARNING("Disconnected state identified.");
-    }
+    // The database is a local file, there is no connection that can be lost once it is open.
+    return m_dbConn != nullptr;
+}
 
-    return bConnected;
+bool SQLite::Ping()
+{
+    return IsConnected();
 }
 
 bool SQLite::PrepareQuery(const Query& query)
 {
     LOG_DEBUG("Preparing query: %s", query);
 
-    sqlite3_finalize(m_stmt);
-
-    bool success = sqlite3_prepare_v2(m_dbConn, query.c_str(), -1, &m_stmt, nullptr) == SQLITE_OK;
+    FinishQuery();
+    ReleaseStatement();
 
-    if (success)
+    if (auto* cached = m_statementCache.Find(query))
     {
-        m_paramCount = sqlite3_bind_parameter_count(m_stmt);
-        LOG_DEBUG("Detected %d parameters.", m_paramCount);
-        m_paramValues.resize(m_paramCount);
+        m_stmt = *cached;
+        m_stmtCached = true;
     }
     else
     {
-        m_lastError.assign(sqlite3_errmsg(m_dbConn));
-        LOG_WARNING("Failed to prepare statement: %s", m_lastError);
-        sqlite3_finalize(m_stmt);
-        m_stmt = nullptr;
+        if (sqlite3_prepare_v2(m_dbConn, query.c_str(), -1, &m_stmt, nullptr) != SQLITE_OK)
+        {
+            m_lastError.assign(sqlite3_errmsg(m_dbConn));
+            LOG_WARNING("Failed to prepare statement: %s", m_lastError);
+            sqlite3_finalize(m_stmt);
+            m_stmt = nullptr;
+            return false;
+        }
+
+        sqlite3_stmt* stmt = m_stmt;
+        m_stmtCached = m_statementCache.Insert(query, std::move(stmt)) != nullptr;
     }
 
-    return success;
+    m_paramCount = sqlite3_bind_parameter_count(m_stmt);
+    LOG_DEBUG("Detected %d parameters.", m_paramCount);
+    m_paramValues.resize(m_paramCount);
+    m_paramIsBlob.assign(m_paramCount, false);
+
+    return true;
 }
 
-std::optional<ResultSet> SQLite::ExecuteQuery()
+bool SQLite::ExecuteQuery()
 {
-    int stepState;
+    FinishQuery();
     m_affectedRows = -1;
 
+    if (!m_stmt)
+    {
+        m_lastError = "No prepared query to execute.";
+        return false;
+    }
+
     sqlite3_reset(m_stmt);
     sqlite3_clear_bindings(m_stmt);
 
     for (unsigned int i = 0; i < m_paramCount; i++)
     {
-        LOG_DEBUG("Binding value '%s' to param '%u'", m_paramValues[i], i);
         // Params in SQLite are 1 based
-        int bindStatus = sqlite3_bind_text(m_stmt, i + 1, m_paramValues[i].c_str(), -1, nullptr);
+        int bindStatus;
+        if (m_paramIsBlob[i])
+        {
+            LOG_DEBUG("Binding %u bytes to param '%u'", m_paramValues[i].size(), i);
+            bindStatus = sqlite3_bind_blob(m_stmt, i + 1, m_paramValues[i].data(), m_paramValues[i].size(), nullptr);
+        }
+        else
+        {
+            LOG_DEBUG("Binding value '%s' to param '%u'", m_paramValues[i], i);
+            bindStatus = sqlite3_bind_text(m_stmt, i + 1, m_paramValues[i].c_str(), -1, nullptr);
+        }
 
         if (bindStatus != SQLITE_OK)
         {
@@ -104,56 +151,127 @@ std::optional<ResultSet> SQLite::ExecuteQuery()
 
             LOG_WARNING("Failed to bind params: %s", m_lastError);
 
-            return std::optional<ResultSet>(); // Failed query, bind error.
+            return false; // Failed query, bind error.
         }
     }
 
-    int columnCount = sqlite3_column_count(m_stmt);
+    // Step to the first row right away, so errors are reported by the query instead of the first fetch.
+    const int stepState = sqlite3_step(m_stmt);
 
-    if (!columnCount)
-    {// Statement returns no rows (INSERT, UPDATE, DELETE, etc.)
-        stepState = sqlite3_step(m_stmt);
+    if (stepState == SQLITE_ROW)
+    {
+        m_cursorOpen = true;
+        m_rowPending = true;
+        return true; // Succeeded query, rows are fetched as they are read.
+    }
 
-        if (stepState == SQLITE_DONE)
-        {
+    if (stepState == SQLITE_DONE)
+    {
+        if (!sqlite3_column_count(m_stmt))
+        {// Statement returns no rows (INSERT, UPDATE, DELETE, etc.)
             m_affectedRows = sqlite3_changes(m_dbConn);
-            return std::make_optional<ResultSet>(ResultSet()); // Succeeded query, no results.
         }
+        sqlite3_reset(m_stmt);
+        return true; // Succeeded query, no results.
     }
-    else
-    {
-        ResultSet results;
 
-        stepState = sqlite3_step(m_stmt);
-        while (stepState == SQLITE_ROW)
-        {
-            ResultRow row;
+    m_lastError.assign(sqlite3_errmsg(m_dbConn));
+    LOG_WARNING("Query failed due to error '%s'", m_lastError);
+
+    // Release any locks held by the failed statement, it may be kept in the cache.
+    sqlite3_reset(m_stmt);
+
+    return false; // Failed query.
+}
 
-            row.reserve(columnCount);
+bool SQLite::FetchRow(ResultRow& row)
+{
+    if (!m_cursorOpen)
+        return false;
 
-            for (int col = 0; col < columnCount; col++)
+    if (m_rowPending)
+    {
+        m_rowPending = false;
+    }
+    else
+    {
+        const int stepState = sqlite3_step(m_stmt);
+        if (stepState != SQLITE_ROW)
+        {
+            if (stepState != SQLITE_DONE)
             {
-                const char* value = reinterpret_cast<const char*>(sqlite3_column_text(m_stmt, col));
-                LOG_DEBUG("Got value '%s' from column '%i'", value, col);
-                row.emplace_back(Result(value, sqlite3_column_bytes(m_stmt, col)));
+                m_lastError.assign(sqlite3_errmsg(m_dbConn));
+                LOG_WARNING("Fetching row failed due to error '%s'", m_lastError);
             }
 
-            results.push(row);
-
-            stepState = sqlite3_step(m_stmt);
+            FinishQuery();
+            return false;
         }
+    }
+
+    row.Clear();
+
+    const int columnCount = sqlite3_column_count(m_stmt);
+    for (int col = 0; col < columnCount; col++)
+    {
+        // Asking a blob for its text would make SQLite copy it to add a terminator.
+        const auto* value = sqlite3_column_type(m_stmt, col) == SQLITE_BLOB
+            ? static_cast<const char*>(sqlite3_column_blob(m_stmt, col))
+            : reinterpret_cast<const char*>(sqlite3_column_text(m_stmt, col));
+        const auto length = static_cast<size_t>(sqlite3_column_bytes(m_stmt, col));
+        row.AddColumn(value ? value : "", length);
+    }
+
+    return true;
+}
+
+bool SQLite::ExecuteBatch(const std::vector<QueryParams>& rows)
+{
+    FinishQuery();
+
+    // Outside of a transaction every statement commits, and syncs to disk, on its own.
+    const bool ownTransaction = sqlite3_get_autocommit(m_dbConn) != 0;
+    if (ownTransaction && !ExecuteStatement("BEGIN"))
+        return false;
 
-        if (stepState == SQLITE_DONE)
+    int affectedRows = 0;
+    bool success = true;
+
+    for (const auto& row : rows)
+    {
+        BindParams(row);
+
+        if (!ExecuteQuery())
         {
-            LOG_DEBUG("Returning Result Set");
-            return std::make_optional<ResultSet>(std::move(results)); // Succeeded query, succeeded results.
+            success = false;
+            break;
         }
+
+        affectedRows += std::max(m_affectedRows, 0);
+        FinishQuery();
     }
 
-    m_lastError.assign(sqlite3_errmsg(m_dbConn));
-    LOG_WARNING("Query failed due to error '%s'", m_lastError);
+    if (ownTransaction)
+    {
+        if (success)
+            success = ExecuteStatement("COMMIT");
+        else
+            ExecuteStatement("ROLLBACK");
+    }
+
+    m_affectedRows = success ? affectedRows : -1;
+    return success;
+}
 
-    return std::optional<ResultSet>(); // Failed query.
+bool SQLite::ExecuteStatement(const char* statement)
+{
+    if (sqlite3_exec(m_dbConn, statement, nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        m_lastError.assign(sqlite3_errmsg(m_dbConn));
+        LOG_WARNING("%s failed due to error '%s'", statement, m_lastError);
+        return false;
+    }
+    return true;
 }
 
 void SQLite::PrepareInt(int32_t position, int32_t value)
@@ -163,6 +281,7 @@ void SQLite::PrepareInt(int32_t position, int32_t value)
     ASSERT_OR_THROW(position >= 0);
 
     m_paramValues[position] = std::to_string(value);
+    m_paramIsBlob[position] = false;
 }
 
 void SQLite::PrepareFloat(int32_t position, float value)
@@ -172,6 +291,7 @@ void SQLite::PrepareFloat(int32_t position, float value)
     ASSERT_OR_THROW(position >= 0);
 
     m_paramValues[position] = std::to_string(value);
+    m_paramIsBlob[position] = false;
 }
 
 void SQLite::PrepareString(int32_t position, const std::string& value)
@@ -181,6 +301,17 @@ void SQLite::PrepareString(int32_t position, const std::string& value)
     ASSERT_OR_THROW(position >= 0);
 
     m_paramValues[position] = value;
+    m_paramIsBlob[position] = false;
+}
+
+void SQLite::PrepareBlob(int32_t position, const Blob& value)
+{
+    LOG_DEBUG("Assigning position %d to %u bytes", position, value.size());
+
+    ASSERT_OR_THROW(position >= 0);
+
+    m_paramValues[position].assign(value.begin(), value.end());
+    m_paramIsBlob[position] = true;
 }
 
 int SQLite::GetAffectedRows()
@@ -205,14 +336,52 @@ int32_t SQLite::GetPreparedQueryParamCount()
 
 void SQLite::DestroyPreparedQuery()
 {
-    sqlite3_finalize(m_stmt);
-    m_stmt = nullptr;
+    // Rows that are still being read need the statement and the values bound to it.
+    if (m_cursorOpen)
+    {
+        m_destroyPending = true;
+        return;
+    }
+
+    ReleaseStatement();
 
     // Force deallocation
     std::vector<std::string>().swap(m_paramValues);
+    std::vector<bool>().swap(m_paramIsBlob);
     m_paramCount = 0;
 }
 
+const StatementCacheStats& SQLite::GetStatementCacheStats()
+{
+    return m_statementCache.GetStats();
+}
+
+void SQLite::FinishQuery()
+{
+    if (m_cursorOpen)
+    {
+        sqlite3_reset(m_stmt);
+        m_cursorOpen = false;
+        m_rowPending = false;
+    }
+
+    if (m_destroyPending)
+    {
+        m_destroyPending = false;
+        DestroyPreparedQuery();
+    }
+}
+
+void SQLite::ReleaseStatement()
+{
+    // Cached statements are owned by the cache and stay prepared for the next use.
+    if (!m_stmtCached)
+        sqlite3_finalize(m_stmt);
+
+    m_stmt = nullptr;
+    m_stmtCached = false;
+}
+
 }
 
 #endif
@@ -4,6 +4,7 @@
 
 #include <sqlite3.h>
 #include "Targets/ITarget.hpp"
+#include "Targets/StatementCache.hpp"
 
 namespace SQL {
 
@@ -15,25 +16,40 @@ public:
 
     virtual void Connect(NWNXLib::Services::ConfigProxy* config) override;
     virtual bool IsConnected() override;
+    virtual bool Ping() override;
     virtual bool PrepareQuery(const Query& query) override;
-    virtual std::optional<ResultSet> ExecuteQuery() override;
+    virtual bool ExecuteQuery() override;
+    virtual bool FetchRow(ResultRow& row) override;
     virtual void PrepareInt(int32_t position, int32_t value) override;
     virtual void PrepareFloat(int32_t position, float value) override;
     virtual void PrepareString(int32_t position, const std::string& value) override;
+    virtual void PrepareBlob(int32_t position, const Blob& value) override;
+    virtual bool ExecuteBatch(const std::vector<QueryParams>& rows) override;
     virtual int  GetAffectedRows() override;
     virtual std::string GetLastError(bool bClear = false) override;
     virtual int32_t GetPreparedQueryParamCount() override;
     virtual void DestroyPreparedQuery() override;
+    virtual const StatementCacheStats& GetStatementCacheStats() override;
 
 
 private:
+    void ReleaseStatement();
+    void FinishQuery();
+    bool ExecuteStatement(const char* statement);
+
     sqlite3 *m_dbConn;
     sqlite3_stmt *m_stmt;
+    bool m_stmtCached;
+    StatementCache<sqlite3_stmt*> m_statementCache;
     std::string m_dbName;
     size_t m_paramCount;
     std::string m_lastError;
     std::vector<std::string> m_paramValues;
+    std::vector<bool> m_paramIsBlob;
     int m_affectedRows;
+    bool m_cursorOpen;
+    bool m_rowPending;
+    bool m_destroyPending;
 };
 
 }
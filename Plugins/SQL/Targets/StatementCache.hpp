@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Targets/ITarget.hpp"
+
+#include <functional>
+#include <list>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace SQL {
+
+// Keeps the most recently used prepared statements of a connection around, keyed by query text,
+// so a query that is prepared again only needs its parameters rebound. Statements pushed out of
+// the cache, or dropped when it is cleared, are handed to the finalizer.
+template <typename Statement>
+class StatementCache
+{
+public:
+    using Finalizer = std::function<void(Statement&)>;
+
+    explicit StatementCache(Finalizer&& finalizer)
+        : m_finalizer(std::move(finalizer)), m_capacity(0) { }
+
+    ~StatementCache() { Clear(); }
+
+    void SetCapacity(size_t capacity)
+    {
+        m_capacity = capacity;
+        while (m_entries.size() > m_capacity)
+        {
+            Evict();
+        }
+    }
+
+    size_t GetCapacity() const { return m_capacity; }
+    size_t GetSize() const { return m_entries.size(); }
+    const StatementCacheStats& GetStats() const { return m_stats; }
+
+    // Returns the cached statement for the query and marks it as the most recently used, or nullptr.
+    Statement* Find(const Query& query)
+    {
+        auto it = m_index.find(query);
+        if (it == std::end(m_index))
+        {
+            ++m_stats.m_misses;
+            return nullptr;
+        }
+
+        ++m_stats.m_hits;
+        m_entries.splice(std::begin(m_entries), m_entries, it->second);
+        return &it->second->second;
+    }
+
+    // Takes ownership of the statement. Returns nullptr if the cache is disabled, in which case
+    // the caller keeps ownership.
+    Statement* Insert(const Query& query, Statement&& statement)
+    {
+        if (m_capacity == 0)
+            return nullptr;
+
+        if (m_entries.size() >= m_capacity)
+        {
+            Evict();
+        }
+
+        m_entries.emplace_front(query, std::move(statement));
+        m_index.emplace(m_entries.front().first, std::begin(m_entries));
+        return &m_entries.front().second;
+    }
+
+    void Clear()
+    {
+        m_index.clear();
+        for (auto& entry : m_entries)
+        {
+            m_finalizer(entry.second);
+        }
+        m_entries.clear();
+    }
+
+private:
+    using Entry = std::pair<Query, Statement>;
+
+    void Evict()
+    {
+        auto& oldest = m_entries.back();
+        m_index.erase(oldest.first);
+        m_finalizer(oldest.second);
+        m_entries.pop_back();
+        ++m_stats.m_evictions;
+    }
+
+    Finalizer m_finalizer;
+    size_t m_capacity;
+    StatementCacheStats m_stats;
+
+    // Most recently used first. The index keys are views into the list's query strings.
+    std::list<Entry> m_entries;
+    std::unordered_map<std::string_view, typename std::list<Entry>::iterator> m_index;
+};
+
+}
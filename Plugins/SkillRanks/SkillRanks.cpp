@@ -4,6 +4,7 @@
 #include "API/CNWSArea.hpp"
 #include "API/CNWSCreature.hpp"
 #include "API/CNWSCreatureStats.hpp"
+#include "API/CNWSEffectListHandler.hpp"
 #include "API/CNWSkill.hpp"
 #include "API/CAppManager.hpp"
 #include "API/CServerExoApp.hpp"
@@ -14,7 +15,6 @@
 #include "Services/Events/Events.hpp"
 #include "Services/Messaging/Messaging.hpp"
 #include <cmath>
-#include <list>
 #include <numeric>
 
 using namespace NWNXLib;
@@ -78,6 +78,19 @@ SkillRanks::SkillRanks(const Plugin::CreateParams& params)
     GetServices()->m_hooks->RequestSharedHook<Functions::_ZN8CNWRules13LoadSkillInfoEv, void, CNWRules*>(&LoadSkillInfoHook);
     GetServices()->m_hooks->RequestExclusiveHook<Functions::_ZN17CNWSCreatureStats12GetSkillRankEhP10CNWSObjecti,
         int32_t, CNWSCreatureStats*, uint8_t, CNWSObject*, int32_t>(&GetSkillRankHook);
+    GetServices()->m_hooks->RequestSharedHook<Functions::_ZN17CNWSCreatureStats7AddFeatEt,
+        void, CNWSCreatureStats*, uint16_t>(&AddOrRemoveFeatHook);
+    GetServices()->m_hooks->RequestSharedHook<Functions::_ZN17CNWSCreatureStats10RemoveFeatEt,
+        void, CNWSCreatureStats*, uint16_t>(&AddOrRemoveFeatHook);
+    GetServices()->m_hooks->RequestSharedHook<Functions::_ZN17CNWSCreatureStats10ClearFeatsEv,
+        void, CNWSCreatureStats*>(&ClearFeatsHook);
+    GetServices()->m_hooks->RequestSharedHook<Functions::_ZN21CNWSEffectListHandler16OnApplyBonusFeatEP10CNWSObjectP11CGameEffecti,
+        int32_t, CNWSEffectListHandler*, CNWSObject*, CGameEffect*, int32_t>(&ApplyBonusFeatHook);
+    GetServices()->m_hooks->RequestSharedHook<Functions::_ZN21CNWSEffectListHandler17OnRemoveBonusFeatEP10CNWSObjectP11CGameEffect,
+        int32_t, CNWSEffectListHandler*, CNWSObject*, CGameEffect*>(&RemoveBonusFeatHook);
+
+    m_creatureSkillFeats.Initialize(*GetServices()->m_perObjectStorage, "SKILL_FEATS");
+    m_areaSkillModifiers.Initialize(*GetServices()->m_perObjectStorage, "SKILL_MODIFIERS", nullptr, &LoadAreaSkillModifiers);
 }
 
 SkillRanks::~SkillRanks()
@@ -91,6 +104,7 @@ void SkillRanks::LoadSkillInfoHook(bool before, CNWRules* pRules)
         return;
 
     g_plugin->m_blindnessMod = pRules->GetRulesetIntEntry("BLIND_PENALTY_TO_SKILL_CHECK", 4);
+    g_plugin->m_skillFeatsDirty = true;
 
     g_plugin->GetServices()->m_messaging->SubscribeMessage("NWNX_SKILLRANK_SIGNAL",
                                                            [](const std::vector<std::string> message)
@@ -98,7 +112,14 @@ void SkillRanks::LoadSkillInfoHook(bool before, CNWRules* pRules)
                                                                auto nSkill = std::stoi(message[0]);
                                                                auto nRace = std::stoi(message[1]);
                                                                auto nMod = std::stoi(message[2]);
-                                                               g_plugin->m_skillRaceMod[nSkill][nRace] = nMod;
+                                                               if (nSkill < 0 || nSkill > 255 || nRace < 0)
+                                                                   return;
+                                                               auto &skillRaceMod = g_plugin->m_skillRaceMod;
+                                                               if (size_t(nSkill) >= skillRaceMod.size())
+                                                                   skillRaceMod.resize(nSkill + 1);
+                                                               if (size_t(nRace) >= skillRaceMod[nSkill].size())
+                                                                   skillRaceMod[nSkill].resize(nRace + 1);
+                                                               skillRaceMod[nSkill][nRace] = nMod;
                                                            });
 
     for (int featId = 0; featId < pRules->m_nNumFeats; featId++)
@@ -559,6 +580,108 @@ void SkillRanks::LoadSkillInfoHook(bool before, CNWRules* pRules)
     }
 }
 
+void SkillRanks::CompileSkillFeats()
+{
+    m_skillFeats.clear();
+    m_skillFeats.resize(Globals::Rules()->m_nNumSkills);
+
+    for (auto &skill : m_skillFeatMap)
+    {
+        if (skill.first >= m_skillFeats.size())
+            continue;
+
+        auto &skillFeats = m_skillFeats[skill.first];
+        skillFeats.reserve(skill.second.size());
+        for (auto &feat : skill.second)
+            skillFeats.push_back({feat.first, feat.second});
+    }
+
+    m_skillFeatsGeneration++;
+    m_skillFeatsDirty = false;
+}
+
+void SkillRanks::FeatsChanged(CNWSCreature *pCreature)
+{
+    if (!pCreature)
+        return;
+
+    if (auto *pSkillFeats = g_plugin->m_creatureSkillFeats.Get(pCreature))
+        pSkillFeats->bFeatsChanged = true;
+}
+
+void SkillRanks::AddOrRemoveFeatHook(bool before, CNWSCreatureStats *pStats, uint16_t)
+{
+    if (!before)
+        FeatsChanged(pStats->m_pBaseCreature);
+}
+
+void SkillRanks::ClearFeatsHook(bool before, CNWSCreatureStats *pStats)
+{
+    if (!before)
+        FeatsChanged(pStats->m_pBaseCreature);
+}
+
+void SkillRanks::ApplyBonusFeatHook(bool before, CNWSEffectListHandler*, CNWSObject *pObject, CGameEffect*, int32_t)
+{
+    if (!before)
+        FeatsChanged(Utils::AsNWSCreature(pObject));
+}
+
+void SkillRanks::RemoveBonusFeatHook(bool before, CNWSEffectListHandler*, CNWSObject *pObject, CGameEffect*)
+{
+    if (!before)
+        FeatsChanged(Utils::AsNWSCreature(pObject));
+}
+
+const SkillRanks::CreatureSkillFeats& SkillRanks::GetCreatureSkillFeats(CNWSCreatureStats *pStats)
+{
+    if (m_skillFeatsDirty)
+        CompileSkillFeats();
+
+    auto *pSkillFeats = m_creatureSkillFeats.GetOrCreate(pStats->m_pBaseCreature);
+
+    if (pSkillFeats->nGeneration == m_skillFeatsGeneration && !pSkillFeats->bFeatsChanged &&
+        pSkillFeats->nFeats == pStats->m_lstFeats.num && pSkillFeats->nBonusFeats == pStats->m_lstBonusFeats.num)
+    {
+        return *pSkillFeats;
+    }
+
+    pSkillFeats->nGeneration = m_skillFeatsGeneration;
+    pSkillFeats->bFeatsChanged = false;
+    pSkillFeats->nFeats = pStats->m_lstFeats.num;
+    pSkillFeats->nBonusFeats = pStats->m_lstBonusFeats.num;
+    pSkillFeats->nSkillOffsets.clear();
+    pSkillFeats->nFeatIndexes.clear();
+    for (auto &skillFeats : m_skillFeats)
+    {
+        pSkillFeats->nSkillOffsets.push_back(pSkillFeats->nFeatIndexes.size());
+        for (size_t i = 0; i < skillFeats.size(); i++)
+        {
+            if (pStats->HasFeat(skillFeats[i].nFeat))
+                pSkillFeats->nFeatIndexes.push_back(i);
+        }
+    }
+    pSkillFeats->nSkillOffsets.push_back(pSkillFeats->nFeatIndexes.size());
+
+    return *pSkillFeats;
+}
+
+bool SkillRanks::LoadAreaSkillModifiers(CGameObject *pArea, AreaSkillModifiers &modifiers)
+{
+    // The modifiers stay in the area's storage so they are saved with it, read them in once
+    auto *pPOS = g_plugin->GetServices()->m_perObjectStorage.get();
+    modifiers.nModifiers.resize(Globals::Rules()->m_nNumSkills);
+    for (size_t skillId = 0; skillId < modifiers.nModifiers.size(); skillId++)
+        modifiers.nModifiers[skillId] = pPOS->Get<int>(pArea, areaModPOSKey + std::to_string(skillId)).value_or(0);
+    return true;
+}
+
+int32_t SkillRanks::GetAreaSkillModifier(CNWSArea *pArea, uint8_t nSkill)
+{
+    auto &nModifiers = m_areaSkillModifiers.GetOrCreate(pArea)->nModifiers;
+    return nSkill < nModifiers.size() ? nModifiers[nSkill] : 0;
+}
+
 int32_t SkillRanks::GetSkillRankHook(
         CNWSCreatureStats* thisPtr,
         uint8_t nSkill,
@@ -581,109 +704,113 @@ int32_t SkillRanks::GetSkillRankHook(
     int32_t retVal = baseRank + thisPtr->m_pBaseCreature->GetTotalEffectBonus(5, pVersus, 0, 0, 0, 0, nSkill, -1, 0);
 
     // Add any racial modifiers broadcasted from the Race plugin
-    retVal += g_plugin->m_skillRaceMod[nSkill][thisPtr->m_nRace];
+    if (nSkill < g_plugin->m_skillRaceMod.size() && thisPtr->m_nRace < g_plugin->m_skillRaceMod[nSkill].size())
+        retVal += g_plugin->m_skillRaceMod[nSkill][thisPtr->m_nRace];
 
     auto *pArea = Globals::AppManager()->m_pServerExoApp->GetAreaByGameObjectID(thisPtr->m_pBaseCreature->m_oidArea);
 
     // Now check if the creature has any skill impacting feats
     bool bHasOverrideKeyAbilityFeat = false;
     bool bHasBypassArmorCheckPenaltyFeat = false;
-    for (auto it: g_plugin->m_skillFeatMap[nSkill])
+    const auto &creatureSkillFeats = g_plugin->GetCreatureSkillFeats(thisPtr);
+    const auto &skillFeats = g_plugin->m_skillFeats[nSkill];
+    for (auto feat = creatureSkillFeats.nSkillOffsets[nSkill]; feat < creatureSkillFeats.nSkillOffsets[nSkill + 1]; feat++)
     {
-        uint32_t featId = it.first;
-        if (thisPtr->HasFeat(featId))
-        {
-            auto skillFeat = it.second;
+        const auto &skillFeat = skillFeats[creatureSkillFeats.nFeatIndexes[feat]].skillFeats;
 
-            if (skillFeat.bBypassArmorCheckPenalty)
-                bHasBypassArmorCheckPenaltyFeat = true;
+        if (skillFeat.bBypassArmorCheckPenalty)
+            bHasBypassArmorCheckPenaltyFeat = true;
 
-            if (skillFeat.nKeyAbilityMask)
+        if (skillFeat.nKeyAbilityMask)
+        {
+            bHasOverrideKeyAbilityFeat = true;
+            int32_t mods[6];
+            int32_t numMods = 0;
+            if ((skillFeat.nKeyAbilityMask & strMask) == strMask)
+                mods[numMods++] = thisPtr->m_nStrengthModifier;
+            if ((skillFeat.nKeyAbilityMask & conMask) == conMask)
+                mods[numMods++] = thisPtr->m_nConstitutionModifier;
+            if ((skillFeat.nKeyAbilityMask & dexMask) == dexMask)
+            {
+                int8_t dexMod = thisPtr->GetDEXMod(0);
+                if (thisPtr->m_pBaseCreature->GetBlind())
+                    dexMod -= g_plugin->m_blindnessMod;
+                mods[numMods++] = dexMod;
+            }
+            if ((skillFeat.nKeyAbilityMask & intMask) == intMask)
+                mods[numMods++] = thisPtr->m_nIntelligenceModifier;
+            if ((skillFeat.nKeyAbilityMask & wisMask) == wisMask)
+                mods[numMods++] = thisPtr->m_nWisdomModifier;
+            if ((skillFeat.nKeyAbilityMask & chaMask) == chaMask)
+                mods[numMods++] = thisPtr->m_nCharismaModifier;
+
+            if (numMods)
             {
-                bHasOverrideKeyAbilityFeat = true;
-                std::list<uint8_t> mods = {};
-                if ((skillFeat.nKeyAbilityMask & strMask) == strMask)
-                    mods.push_front(thisPtr->m_nStrengthModifier);
-                if ((skillFeat.nKeyAbilityMask & conMask) == conMask)
-                    mods.push_front(thisPtr->m_nConstitutionModifier);
-                if ((skillFeat.nKeyAbilityMask & dexMask) == dexMask)
-                {
-                    int8_t dexMod = thisPtr->GetDEXMod(0);
-                    if (thisPtr->m_pBaseCreature->GetBlind())
-                        dexMod -= g_plugin->m_blindnessMod;
-                    mods.push_front(dexMod);
-                }
-                if ((skillFeat.nKeyAbilityMask & intMask) == intMask)
-                    mods.push_front(thisPtr->m_nIntelligenceModifier);
-                if ((skillFeat.nKeyAbilityMask & wisMask) == wisMask)
-                    mods.push_front(thisPtr->m_nWisdomModifier);
-                if ((skillFeat.nKeyAbilityMask & chaMask) == chaMask)
-                    mods.push_front(thisPtr->m_nCharismaModifier);
                 if ((skillFeat.nKeyAbilityMask & minMask) == minMask)
                 {
-                    retVal += *std::min_element(mods.begin(), mods.end());
+                    retVal += *std::min_element(mods, mods + numMods);
                 }
                 else if ((skillFeat.nKeyAbilityMask & maxMask) == maxMask)
                 {
-                    retVal += *std::max_element(mods.begin(), mods.end());
+                    retVal += *std::max_element(mods, mods + numMods);
                 }
                 else if ((skillFeat.nKeyAbilityMask & avgMask) == avgMask)
                 {
-                    retVal += std::floor(std::accumulate(mods.begin(), mods.end(), 0.0) / mods.size());
+                    retVal += std::floor(std::accumulate(mods, mods + numMods, 0.0) / numMods);
                 }
                 else if ((skillFeat.nKeyAbilityMask & sumMask) == sumMask)
                 {
-                    retVal += std::accumulate(mods.begin(), mods.end(), 0);
+                    retVal += std::accumulate(mods, mods + numMods, 0);
                 }
             }
+        }
 
-            bool bAreaCheckRequired = false;
-            bool bAreaCheckPassed = false;
-            bool bDayNightCheckRequired = false;
-            bool bDayNightCheckPassed = false;
+        bool bAreaCheckRequired = false;
+        bool bAreaCheckPassed = false;
+        bool bDayNightCheckRequired = false;
+        bool bDayNightCheckPassed = false;
 
-            if (skillFeat.nAreaFlagsRequired || skillFeat.nAreaFlagsForbidden)
-            {
-                bAreaCheckRequired = true;
-                if (pArea &&
-                    (!skillFeat.nAreaFlagsRequired ||
-                     (skillFeat.nAreaFlagsRequired &&
-                     (pArea->m_nFlags & skillFeat.nAreaFlagsRequired) == skillFeat.nAreaFlagsRequired)) &&
-                    (!skillFeat.nAreaFlagsForbidden ||
-                     (skillFeat.nAreaFlagsForbidden && !(pArea->m_nFlags & skillFeat.nAreaFlagsForbidden))))
+        if (skillFeat.nAreaFlagsRequired || skillFeat.nAreaFlagsForbidden)
+        {
+            bAreaCheckRequired = true;
+            if (pArea &&
+                (!skillFeat.nAreaFlagsRequired ||
+                 (skillFeat.nAreaFlagsRequired &&
+                 (pArea->m_nFlags & skillFeat.nAreaFlagsRequired) == skillFeat.nAreaFlagsRequired)) &&
+                (!skillFeat.nAreaFlagsForbidden ||
+                 (skillFeat.nAreaFlagsForbidden && !(pArea->m_nFlags & skillFeat.nAreaFlagsForbidden))))
 
-                {
-                    bAreaCheckPassed = true;
-                }
+            {
+                bAreaCheckPassed = true;
             }
-            if (pArea && skillFeat.nDayOrNight > 0)
+        }
+        if (pArea && skillFeat.nDayOrNight > 0)
+        {
+            bDayNightCheckRequired = true;
+            auto currentHour = Utils::GetModule()->m_nCurrentHour;
+            auto isDay = currentHour >= Utils::GetModule()->m_nDawnHour && currentHour <= Utils::GetModule()->m_nDuskHour;
+            if ((skillFeat.nDayOrNight == 1 && !pArea->GetIsNight() && isDay) ||
+                (skillFeat.nDayOrNight == 2 && (pArea->GetIsNight() || !isDay)))
             {
-                bDayNightCheckRequired = true;
-                auto currentHour = Utils::GetModule()->m_nCurrentHour;
-                auto isDay = currentHour >= Utils::GetModule()->m_nDawnHour && currentHour <= Utils::GetModule()->m_nDuskHour;
-                if ((skillFeat.nDayOrNight == 1 && !pArea->GetIsNight() && isDay) ||
-                    (skillFeat.nDayOrNight == 2 && (pArea->GetIsNight() || !isDay)))
-                {
-                    bDayNightCheckPassed = true;
-                }
+                bDayNightCheckPassed = true;
             }
+        }
 
-            if ((!bAreaCheckRequired || (bAreaCheckRequired && bAreaCheckPassed)) &&
-                (!bDayNightCheckRequired || (bDayNightCheckRequired && bDayNightCheckPassed)))
-            {
-                // All feat checks have passed, add our modifier
-                retVal += skillFeat.nModifier;
+        if ((!bAreaCheckRequired || (bAreaCheckRequired && bAreaCheckPassed)) &&
+            (!bDayNightCheckRequired || (bDayNightCheckRequired && bDayNightCheckPassed)))
+        {
+            // All feat checks have passed, add our modifier
+            retVal += skillFeat.nModifier;
 
-                // Add any class level modifiers too
-                if (skillFeat.bitsetClasses.any())
+            // Add any class level modifiers too
+            if (skillFeat.bitsetClasses.any())
+            {
+                for (auto i : {0, 1, 2})
                 {
-                    for (auto i : {0, 1, 2})
+                    uint8_t playerClass = thisPtr->GetClass(i);
+                    if (playerClass != Constants::ClassType::Invalid && skillFeat.bitsetClasses.test(playerClass))
                     {
-                        uint8_t playerClass = thisPtr->GetClass(i);
-                        if (playerClass != Constants::ClassType::Invalid && skillFeat.bitsetClasses.test(playerClass))
-                        {
-                            retVal += int32_t(thisPtr->GetClassLevel(i, false) * skillFeat.fClassLevelMod);
-                        }
+                        retVal += int32_t(thisPtr->GetClassLevel(i, false) * skillFeat.fClassLevelMod);
                     }
                 }
             }
@@ -693,8 +820,7 @@ int32_t SkillRanks::GetSkillRankHook(
     // Area set skill rank modifiers
     if (pArea)
     {
-        auto *pPOS = g_plugin->GetServices()->m_perObjectStorage.get();
-        retVal += *pPOS->Get<int>(pArea->m_idSelf, areaModPOSKey + std::to_string(nSkill));
+        retVal += g_plugin->GetAreaSkillModifier(pArea, nSkill);
     }
 
     if (!bHasOverrideKeyAbilityFeat)
@@ -868,6 +994,7 @@ ArgumentStack SkillRanks::SetSkillFeat(ArgumentStack&& args)
     else
     {
         g_plugin->m_skillFeatMap[skillId][featId] = skillFeats;
+        g_plugin->m_skillFeatsDirty = true;
     }
 
     return Services::Events::Arguments();
@@ -888,6 +1015,7 @@ ArgumentStack SkillRanks::SetSkillFeatFocusModifier(ArgumentStack&& args)
             {
                 skillFeat.nModifier = mod;
                 g_plugin->m_skillFeatMap[nSkill][featId] = skillFeat;
+                g_plugin->m_skillFeatsDirty = true;
             }
         }
     }
@@ -933,6 +1061,10 @@ ArgumentStack SkillRanks::SetAreaModifier(ArgumentStack&& args)
     auto *pPOS = g_plugin->GetServices()->m_perObjectStorage.get();
     pPOS->Set(areaOid, areaModPOSKey + std::to_string(skillId), modifier, true);
 
+    auto *pModifiers = g_plugin->m_areaSkillModifiers.Get(pArea);
+    if (pModifiers && size_t(skillId) < pModifiers->nModifiers.size())
+        pModifiers->nModifiers[skillId] = modifier;
+
     return Services::Events::Arguments();
 }
 
@@ -3,8 +3,11 @@
 #include "Plugin.hpp"
 #include "Services/Events/Events.hpp"
 #include "Services/Hooks/Hooks.hpp"
+#include "Services/PerObjectStorage/ObjectStore.hpp"
 #include <bitset>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 using ArgumentStack = NWNXLib::Services::Events::ArgumentStack;
 
@@ -44,8 +47,49 @@ private:
         uint16_t nKeyAbilityMask;
     };
 
+    struct SkillFeat {
+        uint16_t nFeat;
+        SkillFeats skillFeats;
+    };
+
+    // The skill feats a creature has, so skill checks don't go through HasFeat for every skill feat.
+    // Rebuilt when the skill feats change or the creature gains or loses a feat.
+    struct CreatureSkillFeats {
+        uint32_t nGeneration = 0;
+        bool bFeatsChanged = false;
+        // The sizes of the creature's feat lists, for feats added without going through the hooks.
+        int32_t nFeats = -1;
+        int32_t nBonusFeats = -1;
+        // Indexes into m_skillFeats[nSkill] from nSkillOffsets[nSkill] to nSkillOffsets[nSkill + 1].
+        std::vector<uint16_t> nSkillOffsets;
+        std::vector<uint16_t> nFeatIndexes;
+    };
+
+    // An area's modifiers by skill, so skill checks don't build a storage key for every check.
+    struct AreaSkillModifiers {
+        std::vector<int32_t> nModifiers;
+    };
+
+    const CreatureSkillFeats& GetCreatureSkillFeats(CNWSCreatureStats*);
+    int32_t GetAreaSkillModifier(CNWSArea*, uint8_t);
+    void CompileSkillFeats();
+    static void FeatsChanged(CNWSCreature*);
+    static void AddOrRemoveFeatHook(bool, CNWSCreatureStats*, uint16_t);
+    static void ClearFeatsHook(bool, CNWSCreatureStats*);
+    static void ApplyBonusFeatHook(bool, CNWSEffectListHandler*, CNWSObject*, CGameEffect*, int32_t);
+    static void RemoveBonusFeatHook(bool, CNWSEffectListHandler*, CNWSObject*, CGameEffect*);
+    static bool LoadAreaSkillModifiers(CGameObject*, AreaSkillModifiers&);
+
     std::unordered_map<uint8_t, std::unordered_map<uint16_t, SkillFeats>> m_skillFeatMap;
-    std::unordered_map<uint16_t, std::unordered_map<uint8_t, int32_t>> m_skillRaceMod;
+    // m_skillFeatMap flattened per skill, compiled the first time it's needed after a change.
+    std::vector<std::vector<SkillFeat>> m_skillFeats;
+    bool m_skillFeatsDirty = true;
+    uint32_t m_skillFeatsGeneration = 0;
+    // By skill, then race.
+    std::vector<std::vector<int32_t>> m_skillRaceMod;
+
+    NWNXLib::Services::ObjectStore<CreatureSkillFeats> m_creatureSkillFeats;
+    NWNXLib::Services::ObjectStore<AreaSkillModifiers> m_areaSkillModifiers;
 };
 
 }
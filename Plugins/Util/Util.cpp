@@ -19,6 +19,7 @@
 #include "API/CExoFile.hpp"
 #include "API/Functions.hpp"
 #include "Utils.hpp"
+#include "Utils/Regex.hpp"
 #include "Services/Config/Config.hpp"
 #include "Services/Commands/Commands.hpp"
 
@@ -312,11 +313,11 @@ ArgumentStack Util::GetFirstResRef(ArgumentStack&& args)
 
     if (pList)
     {
-        std::regex rgx(regexFilter);
+        const auto rgx = regexFilter.empty() ? nullptr : Utils::GetRegex(regexFilter);
 
         for (int i = 0; i < pList->m_nCount; i++)
         {
-            if (regexFilter.empty() || std::regex_match(pList->m_pStrings[i]->CStr(), rgx))
+            if (regexFilter.empty() || std::regex_match(pList->m_pStrings[i]->CStr(), *rgx))
             {
                 m_listResRefs.emplace_back(pList->m_pStrings[i]->CStr());
             }
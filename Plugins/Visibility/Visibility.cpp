@@ -8,6 +8,7 @@
 #include "API/CNWSObject.hpp"
 #include "API/CNWSCreature.hpp"
 #include "API/CNWSCreatureStats.hpp"
+#include "API/CGameObject.hpp"
 #include "Services/Events/Events.hpp"
 #include "Services/PerObjectStorage/PerObjectStorage.hpp"
 
@@ -40,7 +41,7 @@ NWNX_PLUGIN_ENTRY Plugin* PluginLoad(Plugin::CreateParams params)
 namespace Visibility {
 
 Visibility::Visibility(const Plugin::CreateParams& params)
-    : Plugin(params)
+    : Plugin(params), m_overrideCount(0)
 {
 #define REGISTER(func) \
     GetServices()->m_events->RegisterEvent(#func, \
@@ -53,6 +54,8 @@ Visibility::Visibility(const Plugin::CreateParams& params)
 
     GetServices()->m_hooks->RequestExclusiveHook<API::Functions::_ZN11CNWSMessage17TestObjectVisibleEP10CNWSObjectS1_>(&Visibility::TestObjectVisibleHook);
     m_TestObjectVisibilityHook = GetServices()->m_hooks->FindHookByAddress(API::Functions::_ZN11CNWSMessage17TestObjectVisibleEP10CNWSObjectS1_);
+
+    m_objectOverrides.Initialize(*GetServices()->m_perObjectStorage, "OVERRIDES", &ReleaseObjectOverrides);
 }
 
 Visibility::~Visibility()
@@ -64,14 +67,27 @@ int32_t Visibility::TestObjectVisibleHook(
     CNWSObject *pAreaObject,
     CNWSObject *pPlayerGameObject)
 {
-    if (pAreaObject->m_idSelf == pPlayerGameObject->m_idSelf)
+    if (!g_plugin->m_overrideCount || pAreaObject->m_idSelf == pPlayerGameObject->m_idSelf)
     {
         return g_plugin->m_TestObjectVisibilityHook->CallOriginal<int32_t>(pThis, pAreaObject, pPlayerGameObject);
     }
 
     bool bInvisible = false;
-    int32_t personalOverride = GetPersonalOverride(pPlayerGameObject->m_idSelf, pAreaObject->m_idSelf);
-    int32_t globalOverride = GetGlobalOverride(pAreaObject->m_idSelf);
+    int32_t personalOverride = -1;
+    int32_t globalOverride = -1;
+
+    if (auto *pPlayerOverrides = g_plugin->m_objectOverrides.Get(pPlayerGameObject))
+    {
+        auto personal = pPlayerOverrides->m_personalOverrides.find(pAreaObject->m_idSelf);
+        if (personal != std::end(pPlayerOverrides->m_personalOverrides))
+            personalOverride = personal->second;
+    }
+
+    if (personalOverride == -1)
+    {
+        if (auto *pTargetOverrides = g_plugin->m_objectOverrides.Get(pAreaObject))
+            globalOverride = pTargetOverrides->m_globalOverride;
+    }
 
     if (personalOverride != -1)
     {
@@ -85,13 +101,20 @@ int32_t Visibility::TestObjectVisibleHook(
     return bInvisible ? false : g_plugin->m_TestObjectVisibilityHook->CallOriginal<int32_t>(pThis, pAreaObject, pPlayerGameObject);
 }
 
+void Visibility::ReleaseObjectOverrides(ObjectOverrides& overrides)
+{
+    g_plugin->m_overrideCount -= static_cast<uint32_t>(overrides.m_personalOverrides.size());
+    if (overrides.m_globalOverride != -1)
+        g_plugin->m_overrideCount--;
+}
+
 int32_t Visibility::GetGlobalOverride(Types::ObjectID targetId)
 {
     int32_t retVal = -1;
 
-    if (auto globalOverride = g_plugin->GetServices()->m_perObjectStorage->Get<int>(targetId, "GLOBAL_VISIBILITY_OVERRIDE"))
+    if (auto *pOverrides = g_plugin->m_objectOverrides.Get(targetId))
     {
-        retVal = *globalOverride;
+        retVal = pOverrides->m_globalOverride;
     }
 
     return retVal;
@@ -101,9 +124,11 @@ int32_t Visibility::GetPersonalOverride(Types::ObjectID playerId, Types::ObjectI
 {
     int32_t retVal = -1;
 
-    if (auto personalOverride = g_plugin->GetServices()->m_perObjectStorage->Get<int>(playerId, Utils::ObjectIDToString(targetId)))
+    if (auto *pOverrides = g_plugin->m_objectOverrides.Get(playerId))
     {
-        retVal = !!*personalOverride;
+        auto personal = pOverrides->m_personalOverrides.find(targetId);
+        if (personal != std::end(pOverrides->m_personalOverrides))
+            retVal = personal->second;
     }
 
     return retVal;
@@ -122,24 +147,34 @@ ArgumentStack Visibility::GetVisibilityOverride(ArgumentStack&& args)
 
 ArgumentStack Visibility::SetVisibilityOverride(ArgumentStack&& args)
 {
-    auto playerId = Services::Events::ExtractArgument<Types::ObjectID>(args);
+    const auto playerId = Services::Events::ExtractArgument<Types::ObjectID>(args);
     const auto targetId = Services::Events::ExtractArgument<Types::ObjectID>(args);
     const auto override = Services::Events::ExtractArgument<int32_t>(args);
-    std::string varName = Utils::ObjectIDToString(targetId);
+    const auto ownerId = (playerId == Constants::OBJECT_INVALID) ? targetId : playerId;
 
-    if (playerId == Constants::OBJECT_INVALID)
+    auto *pOverrides = (override == -1) ? m_objectOverrides.Get(ownerId) : m_objectOverrides.GetOrCreate(ownerId);
+    if (!pOverrides)
     {
-        varName = "GLOBAL_VISIBILITY_OVERRIDE";
-        playerId = targetId;
+        return Services::Events::Arguments();
     }
 
-    if (override == -1)
+    if (playerId == Constants::OBJECT_INVALID)
+    {
+        if (pOverrides->m_globalOverride != -1)
+            m_overrideCount--;
+
+        pOverrides->m_globalOverride = static_cast<int8_t>(override);
+
+        if (pOverrides->m_globalOverride != -1)
+            m_overrideCount++;
+    }
+    else if (override == -1)
     {
-        g_plugin->GetServices()->m_perObjectStorage->Remove(playerId, varName);
+        m_overrideCount -= static_cast<uint32_t>(pOverrides->m_personalOverrides.erase(targetId));
     }
-    else
+    else if (pOverrides->m_personalOverrides.insert_or_assign(targetId, !!override).second)
     {
-        g_plugin->GetServices()->m_perObjectStorage->Set(playerId, varName, override);
+        m_overrideCount++;
     }
 
     return Services::Events::Arguments();
@@ -3,6 +3,8 @@
 #include "Plugin.hpp"
 #include "Services/Events/Events.hpp"
 #include "Services/Hooks/Hooks.hpp"
+#include "Services/PerObjectStorage/ObjectStore.hpp"
+#include <unordered_map>
 
 using ArgumentStack = NWNXLib::Services::Events::ArgumentStack;
 
@@ -15,6 +17,12 @@ public:
     virtual ~Visibility();
 
 private:
+    // The overrides of one object, both as a player and as a target.
+    struct ObjectOverrides
+    {
+        int8_t m_globalOverride = -1;
+        std::unordered_map<NWNXLib::API::Types::ObjectID, bool> m_personalOverrides;
+    };
 
     static int32_t TestObjectVisibleHook(CNWSMessage *pThis, CNWSObject *pAreaObject, CNWSObject *pPlayerGameObject);
     NWNXLib::Hooking::FunctionHook* m_TestObjectVisibilityHook;
@@ -22,6 +30,12 @@ private:
     static int32_t GetGlobalOverride(NWNXLib::API::Types::ObjectID targetId);
     static int32_t GetPersonalOverride(NWNXLib::API::Types::ObjectID playerId, NWNXLib::API::Types::ObjectID targetId);
 
+    static void ReleaseObjectOverrides(ObjectOverrides& overrides);
+
+    NWNXLib::Services::ObjectStore<ObjectOverrides> m_objectOverrides;
+    // All global and personal overrides set, visibility tests skip everything else while there are none.
+    uint32_t m_overrideCount;
+
     ArgumentStack GetVisibilityOverride (ArgumentStack&& args);
     ArgumentStack SetVisibilityOverride (ArgumentStack&& args);
 };
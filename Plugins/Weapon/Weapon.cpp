@@ -136,6 +136,7 @@ ArgumentStack Weapon::SetWeaponFocusFeat(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_WeaponFocusMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Weapon Focus Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -158,6 +159,7 @@ ArgumentStack Weapon::SetGreaterWeaponFocusFeat(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_GreaterWeaponFocusMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Greater Weapon Focus Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -180,6 +182,7 @@ ArgumentStack Weapon::SetEpicWeaponFocusFeat(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_EpicWeaponFocusMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Epic Weapon Focus Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -200,6 +203,7 @@ ArgumentStack Weapon::SetWeaponFinesseSize(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_WeaponFinesseSizeMap.insert({w_bitem, size});
+    m_WeaponFeatsDirty = true;
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Weapon Finesse Size %d added for Base Item Type %d [%s]", size, w_bitem, baseItemName);
 
@@ -231,6 +235,7 @@ ArgumentStack Weapon::SetWeaponUnarmed(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_WeaponUnarmedSet.insert(w_bitem);
+    m_WeaponFeatsDirty = true;
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Base Item Type %d [%s] set as unarmed weapon", w_bitem, baseItemName);
 
@@ -249,6 +254,7 @@ ArgumentStack Weapon::SetWeaponIsMonkWeapon(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_MonkWeaponSet.insert(w_bitem);
+    m_WeaponFeatsDirty = true;
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Base Item Type %d [%s] set as monk weapon", w_bitem, baseItemName);
 
@@ -280,6 +286,7 @@ ArgumentStack Weapon::SetWeaponImprovedCriticalFeat(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_WeaponImprovedCriticalMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Improved Critical Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -302,6 +309,7 @@ ArgumentStack Weapon::SetWeaponSpecializationFeat(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_WeaponSpecializationMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Weapon Specialization Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -324,6 +332,7 @@ ArgumentStack Weapon::SetGreaterWeaponSpecializationFeat(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_GreaterWeaponSpecializationMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Greater Weapon Specialization Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -346,6 +355,7 @@ ArgumentStack Weapon::SetEpicWeaponSpecializationFeat(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_EpicWeaponSpecializationMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Epic Weapon Specialization Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -368,6 +378,7 @@ ArgumentStack Weapon::SetEpicWeaponOverwhelmingCriticalFeat(ArgumentStack&& args
       ASSERT_OR_THROW(pBaseItem);
 
     m_EpicWeaponOverwhelmingCriticalMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Overwhelming Critical Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -390,6 +401,7 @@ ArgumentStack Weapon::SetEpicWeaponDevastatingCriticalFeat(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_EpicWeaponDevastatingCriticalMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Devastating Critical Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -412,6 +424,7 @@ ArgumentStack Weapon::SetWeaponOfChoiceFeat(ArgumentStack&& args)
       ASSERT_OR_THROW(pBaseItem);
 
     m_WeaponOfChoiceMap.insert({w_bitem, feat});
+    m_WeaponFeatsDirty = true;
     auto featName = pFeat->GetNameText();
     auto baseItemName = pBaseItem->GetNameText();
     LOG_INFO("Weapon of Choice Feat %d [%s] added for Base Item Type %d [%s]", feat, featName, w_bitem, baseItemName);
@@ -477,19 +490,9 @@ ArgumentStack Weapon::SetEventData(ArgumentStack&& args)
 
 int32_t Weapon::GetWeaponFocus(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
 {
-    int32_t feat = -1;
     Weapon& plugin = *g_plugin;
 
-    if (pWeapon == nullptr)
-    {
-        auto w = plugin.m_WeaponFocusMap.find(Constants::BaseItem::Gloves);
-        feat = (w == plugin.m_WeaponFocusMap.end()) ? -1 : w->second;
-    }
-    else
-    {
-        auto w = plugin.m_WeaponFocusMap.find(pWeapon->m_nBaseItem);
-        feat = (w == plugin.m_WeaponFocusMap.end()) ? -1 : w->second;
-    }
+    int32_t feat = plugin.GetWeaponFeats(pWeapon).nWeaponFocus;
 
     if (feat == Constants::Feat::WeaponFocus_Creature &&
        pStats->HasFeat(Constants::Feat::WeaponFocus_UnarmedStrike))
@@ -501,19 +504,9 @@ int32_t Weapon::GetWeaponFocus(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
 
 int32_t Weapon::GetEpicWeaponFocus(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
 {
-    int32_t feat = -1;
     Weapon& plugin = *g_plugin;
 
-    if (pWeapon == nullptr)
-    {
-        auto w = plugin.m_EpicWeaponFocusMap.find(Constants::BaseItem::Gloves);
-        feat = (w == plugin.m_EpicWeaponFocusMap.end()) ? -1 : w->second;
-    }
-    else
-    {
-        auto w = plugin.m_EpicWeaponFocusMap.find(pWeapon->m_nBaseItem);
-        feat = (w == plugin.m_EpicWeaponFocusMap.end()) ? -1 : w->second;
-    }
+    int32_t feat = plugin.GetWeaponFeats(pWeapon).nEpicWeaponFocus;
 
     if (feat == Constants::Feat::EpicWeaponFocus_Creature &&
        pStats->HasFeat(Constants::Feat::EpicWeaponFocus_Unarmed))
@@ -535,96 +528,46 @@ int32_t Weapon::GetWeaponFinesse(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
 
 int32_t Weapon::GetWeaponImprovedCritical(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
 {
-    int32_t feat = -1;
     Weapon& plugin = *g_plugin;
 
-    if (pWeapon == nullptr)
-    {
-        auto w = plugin.m_WeaponImprovedCriticalMap.find(Constants::BaseItem::Gloves);
-        feat = (w == plugin.m_WeaponImprovedCriticalMap.end()) ? -1 : w->second;
-    }
-    else
-    {
-        auto w = plugin.m_WeaponImprovedCriticalMap.find(pWeapon->m_nBaseItem);
-        feat = (w == plugin.m_WeaponImprovedCriticalMap.end()) ? -1 : w->second;
-    }
+    int32_t feat = plugin.GetWeaponFeats(pWeapon).nWeaponImprovedCritical;
 
     return (feat > -1 ? pStats->HasFeat(feat) : plugin.m_GetWeaponImprovedCriticalHook->CallOriginal<int32_t>(pStats, pWeapon));
 }
 
 int32_t Weapon::GetWeaponSpecialization(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
 {
-    int32_t feat = -1;
     Weapon& plugin = *g_plugin;
 
-    if (pWeapon == nullptr)
-    {
-        auto w = plugin.m_WeaponSpecializationMap.find(Constants::BaseItem::Gloves);
-        feat = (w == plugin.m_WeaponSpecializationMap.end()) ? -1 : w->second;
-    }
-    else
-    {
-        auto w = plugin.m_WeaponSpecializationMap.find(pWeapon->m_nBaseItem);
-        feat = (w == plugin.m_WeaponSpecializationMap.end()) ? -1 : w->second;
-    }
+    int32_t feat = plugin.GetWeaponFeats(pWeapon).nWeaponSpecialization;
 
     return (feat > -1 ? pStats->HasFeat(feat) : plugin.m_GetWeaponSpecializationHook->CallOriginal<int32_t>(pStats, pWeapon));
 }
 
 int32_t Weapon::GetEpicWeaponSpecialization(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
 {
-    int32_t feat = -1;
     Weapon& plugin = *g_plugin;
 
-    if (pWeapon == nullptr)
-    {
-        auto w = plugin.m_EpicWeaponSpecializationMap.find(Constants::BaseItem::Gloves);
-        feat = (w == plugin.m_EpicWeaponSpecializationMap.end()) ? -1 : w->second;
-    }
-    else
-    {
-        auto w = plugin.m_EpicWeaponSpecializationMap.find(pWeapon->m_nBaseItem);
-        feat = (w == plugin.m_EpicWeaponSpecializationMap.end()) ? -1 : w->second;
-    }
+    int32_t feat = plugin.GetWeaponFeats(pWeapon).nEpicWeaponSpecialization;
 
     return (feat > -1 ? pStats->HasFeat(feat) : plugin.m_GetEpicWeaponSpecializationHook->CallOriginal<int32_t>(pStats, pWeapon));
 }
 
 int32_t Weapon::GetEpicWeaponOverwhelmingCritical(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
 {
-    int32_t feat = -1;
     Weapon& plugin = *g_plugin;
 
-    if (pWeapon == nullptr)
-    {
-        auto w = plugin.m_EpicWeaponOverwhelmingCriticalMap.find(Constants::BaseItem::Gloves);
-        feat = (w == plugin.m_EpicWeaponOverwhelmingCriticalMap.end()) ? -1 : w->second;
-    }
-    else
-    {
-        auto w = plugin.m_EpicWeaponOverwhelmingCriticalMap.find(pWeapon->m_nBaseItem);
-        feat = (w == plugin.m_EpicWeaponOverwhelmingCriticalMap.end()) ? -1 : w->second;
-    }
+    int32_t feat = plugin.GetWeaponFeats(pWeapon).nEpicWeaponOverwhelmingCritical;
 
     return (feat > -1 ? pStats->HasFeat(feat) : plugin.m_GetEpicWeaponOverwhelmingCriticalHook->CallOriginal<int32_t>(pStats, pWeapon));
 }
 
 int32_t Weapon::GetEpicWeaponDevastatingCritical(CNWSCreatureStats* pStats, CNWSItem* pWeapon)
 {
-    int32_t feat = -1;
     Weapon& plugin = *g_plugin;
     bool bFlag = false;
 
-    if (pWeapon == nullptr)
-    {
-        auto w = plugin.m_EpicWeaponDevastatingCriticalMap.find(Constants::BaseItem::Gloves);
-        feat = (w == plugin.m_EpicWeaponDevastatingCriticalMap.end()) ? -1 : w->second;
-    }
-    else
-    {
-        auto w = plugin.m_EpicWeaponDevastatingCriticalMap.find(pWeapon->m_nBaseItem);
-        feat = (w == plugin.m_EpicWeaponDevastatingCriticalMap.end()) ? -1 : w->second;
-    }
+    int32_t feat = plugin.GetWeaponFeats(pWeapon).nEpicWeaponDevastatingCritical;
     bFlag = feat > -1 ? pStats->HasFeat(feat) : plugin.m_GetEpicWeaponDevastatingCriticalHook->CallOriginal<int32_t>(pStats, pWeapon);
 
     if (bFlag && !plugin.m_DCScript.empty())
@@ -652,11 +595,9 @@ int32_t Weapon::GetEpicWeaponDevastatingCritical(CNWSCreatureStats* pStats, CNWS
 
 int32_t Weapon::GetIsWeaponOfChoice(CNWSCreatureStats* pStats, uint32_t nBaseItem)
 {
-    int32_t feat = -1;
     Weapon& plugin = *g_plugin;
 
-    auto w = plugin.m_WeaponOfChoiceMap.find(nBaseItem);
-    feat = (w == plugin.m_WeaponOfChoiceMap.end()) ? -1 : w->second;
+    int32_t feat = plugin.GetWeaponFeats(nBaseItem).nWeaponOfChoice;
 
     return (feat > -1) ? pStats->HasFeat(feat) : plugin.m_GetIsWeaponOfChoiceHook->CallOriginal<int32_t>(pStats, nBaseItem);
 }
@@ -692,8 +633,7 @@ int32_t Weapon::GetMeleeDamageBonus(CNWSCreatureStats* pStats, int32_t bOffHand,
         nBaseItem = pWeapon->m_nBaseItem;
     }
 
-    auto w = plugin.m_GreaterWeaponSpecializationMap.find(nBaseItem);
-    feat = (w == plugin.m_GreaterWeaponSpecializationMap.end()) ? -1 : w->second;
+    feat = plugin.GetWeaponFeats(nBaseItem).nGreaterWeaponSpecialization;
 
     if (feat > -1 && pStats->HasFeat(feat))
     {
@@ -730,8 +670,7 @@ int32_t Weapon::GetDamageBonus(CNWSCreatureStats* pStats, CNWSCreature *pCreatur
         nBaseItem = pWeapon->m_nBaseItem;
     }
 
-    auto w = plugin.m_GreaterWeaponSpecializationMap.find(nBaseItem);
-    feat = (w == plugin.m_GreaterWeaponSpecializationMap.end()) ? -1 : w->second;
+    feat = plugin.GetWeaponFeats(nBaseItem).nGreaterWeaponSpecialization;
 
     if (feat > -1 && pStats->HasFeat(feat))
     {
@@ -762,8 +701,7 @@ int32_t Weapon::GetRangedDamageBonus(CNWSCreatureStats* pStats)
         nBaseItem = pWeapon->m_nBaseItem;
     }
 
-    auto w = plugin.m_GreaterWeaponSpecializationMap.find(nBaseItem);
-    feat = (w == plugin.m_GreaterWeaponSpecializationMap.end()) ? -1 : w->second;
+    feat = plugin.GetWeaponFeats(nBaseItem).nGreaterWeaponSpecialization;
 
     if (feat > -1 && pStats->HasFeat(feat))
     {
@@ -799,8 +737,7 @@ int32_t Weapon::GetAttackModifierVersus(CNWSCreatureStats* pStats, CNWSCreature*
         nBaseItem = pWeapon->m_nBaseItem;
     }
 
-    auto w = plugin.m_GreaterWeaponFocusMap.find(nBaseItem);
-    feat = (w == plugin.m_GreaterWeaponFocusMap.end()) ? -1 : w->second;
+    feat = plugin.GetWeaponFeats(nBaseItem).nGreaterWeaponFocus;
 
     if (feat > -1 && pStats->HasFeat(feat))
     {
@@ -843,8 +780,7 @@ int32_t Weapon::GetMeleeAttackBonus(CNWSCreatureStats* pStats, int32_t bOffHand,
         nBaseItem = pWeapon->m_nBaseItem;
     }
 
-    auto w = plugin.m_GreaterWeaponFocusMap.find(nBaseItem);
-    feat = (w == plugin.m_GreaterWeaponFocusMap.end()) ? -1 : w->second;
+    feat = plugin.GetWeaponFeats(nBaseItem).nGreaterWeaponFocus;
 
     if (feat > -1 && pStats->HasFeat(feat))
     {
@@ -878,8 +814,7 @@ int32_t Weapon::GetRangedAttackBonus(CNWSCreatureStats* pStats, int32_t bInclude
 
     nBaseItem = pWeapon->m_nBaseItem;
 
-    auto w = plugin.m_GreaterWeaponFocusMap.find(nBaseItem);
-    feat = (w == plugin.m_GreaterWeaponFocusMap.end()) ? -1 : w->second;
+    feat = plugin.GetWeaponFeats(nBaseItem).nGreaterWeaponFocus;
 
     if (feat > -1 && pStats->HasFeat(feat))
     {
@@ -924,8 +859,7 @@ int32_t Weapon::GetUseMonkAttackTables(CNWSCreatureStats* pStats, int32_t bForce
         return 0;
     }
 
-    auto w = plugin.m_MonkWeaponSet.find(pWeapon->m_nBaseItem);
-    if (w == plugin.m_MonkWeaponSet.end() && pWeapon->m_nBaseItem!=Constants::BaseItem::Kama)
+    if (!plugin.GetWeaponFeats(pWeapon->m_nBaseItem).bMonkWeapon && pWeapon->m_nBaseItem!=Constants::BaseItem::Kama)
     {
         return 0;
     }
@@ -937,8 +871,7 @@ int32_t Weapon::GetUseMonkAttackTables(CNWSCreatureStats* pStats, int32_t bForce
         return 1;
     }
 
-    w = plugin.m_MonkWeaponSet.find(pWeapon->m_nBaseItem);
-    if (w == plugin.m_MonkWeaponSet.end() &&
+    if (!plugin.GetWeaponFeats(pWeapon->m_nBaseItem).bMonkWeapon &&
         pWeapon->m_nBaseItem != Constants::BaseItem::Kama &&
         pWeapon->m_nBaseItem != Constants::BaseItem::Torch)
     {
@@ -967,8 +900,7 @@ bool Weapon::GetIsWeaponLight(CNWSCreatureStats* pStats, CNWSItem* pWeapon, bool
 
     if (bFinesse)
     {
-        auto w = plugin.m_WeaponFinesseSizeMap.find(pWeapon->m_nBaseItem);
-        int iSize =  (w == plugin.m_WeaponFinesseSizeMap.end()) ? Constants::CreatureSize::Huge + 1 : w->second;
+        int iSize = plugin.GetWeaponFeats(pWeapon->m_nBaseItem).nFinesseSize;
 
         if (pStats->m_pBaseCreature->m_nCreatureSize >= iSize)
         {
@@ -1007,8 +939,70 @@ bool Weapon::GetIsUnarmedWeapon(CNWSItem* pWeapon)
     }
 
     // Check if weapon should be considered unarmed
-    auto w = plugin.m_WeaponUnarmedSet.find(pWeapon->m_nBaseItem);
-    return (w == plugin.m_WeaponUnarmedSet.end()) ? false : true;
+    return plugin.GetWeaponFeats(pWeapon->m_nBaseItem).bUnarmed;
+}
+
+const Weapon::WeaponFeats& Weapon::GetWeaponFeats(uint32_t nBaseItem)
+{
+    if (m_WeaponFeatsDirty)
+    {
+        CompileWeaponFeats();
+    }
+
+    return nBaseItem < m_WeaponFeats.size() ? m_WeaponFeats[nBaseItem] : m_DefaultWeaponFeats;
+}
+
+// Unarmed attacks use the gloves' entry.
+const Weapon::WeaponFeats& Weapon::GetWeaponFeats(CNWSItem* pWeapon)
+{
+    return GetWeaponFeats(pWeapon == nullptr ? (uint32_t) Constants::BaseItem::Gloves : pWeapon->m_nBaseItem);
+}
+
+void Weapon::CompileWeaponFeats()
+{
+    const std::pair<const std::map<std::uint32_t, std::uint32_t>*, int32_t WeaponFeats::*> featMaps[] =
+    {
+        { &m_WeaponFocusMap,                    &WeaponFeats::nWeaponFocus },
+        { &m_EpicWeaponFocusMap,                &WeaponFeats::nEpicWeaponFocus },
+        { &m_WeaponImprovedCriticalMap,         &WeaponFeats::nWeaponImprovedCritical },
+        { &m_WeaponSpecializationMap,           &WeaponFeats::nWeaponSpecialization },
+        { &m_EpicWeaponSpecializationMap,       &WeaponFeats::nEpicWeaponSpecialization },
+        { &m_EpicWeaponOverwhelmingCriticalMap, &WeaponFeats::nEpicWeaponOverwhelmingCritical },
+        { &m_EpicWeaponDevastatingCriticalMap,  &WeaponFeats::nEpicWeaponDevastatingCritical },
+        { &m_WeaponOfChoiceMap,                 &WeaponFeats::nWeaponOfChoice },
+        { &m_GreaterWeaponSpecializationMap,    &WeaponFeats::nGreaterWeaponSpecialization },
+        { &m_GreaterWeaponFocusMap,             &WeaponFeats::nGreaterWeaponFocus },
+    };
+
+    // All tables are ordered, so the last key of each is the highest base item it needs.
+    uint32_t nSize = 0;
+    for (auto& featMap : featMaps)
+    {
+        if (!featMap.first->empty())
+            nSize = std::max(nSize, featMap.first->rbegin()->first + 1);
+    }
+    if (!m_WeaponFinesseSizeMap.empty())
+        nSize = std::max(nSize, m_WeaponFinesseSizeMap.rbegin()->first + 1);
+    if (!m_WeaponUnarmedSet.empty())
+        nSize = std::max(nSize, *m_WeaponUnarmedSet.rbegin() + 1);
+    if (!m_MonkWeaponSet.empty())
+        nSize = std::max(nSize, *m_MonkWeaponSet.rbegin() + 1);
+
+    m_WeaponFeats.assign(nSize, WeaponFeats());
+
+    for (auto& featMap : featMaps)
+    {
+        for (auto& feat : *featMap.first)
+            m_WeaponFeats[feat.first].*featMap.second = feat.second;
+    }
+    for (auto& size : m_WeaponFinesseSizeMap)
+        m_WeaponFeats[size.first].nFinesseSize = size.second;
+    for (auto baseItem : m_WeaponUnarmedSet)
+        m_WeaponFeats[baseItem].bUnarmed = true;
+    for (auto baseItem : m_MonkWeaponSet)
+        m_WeaponFeats[baseItem].bMonkWeapon = true;
+
+    m_WeaponFeatsDirty = false;
 }
 
 int Weapon::GetLevelByClass(CNWSCreatureStats *pStats, uint32_t nClassType)
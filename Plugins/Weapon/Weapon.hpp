@@ -2,10 +2,12 @@
 
 #include <map>
 #include <set>
+#include <vector>
 #include "Plugin.hpp"
 #include "Services/Events/Events.hpp"
 #include "Services/Hooks/Hooks.hpp"
 #include "API/Types.hpp"
+#include "API/Constants.hpp"
 #include "API/CNWSCreature.hpp"
 #include "API/CNWSCreatureStats.hpp"
 #include "API/CNWSItem.hpp"
@@ -104,6 +106,33 @@ private:
     std::set<std::uint32_t>  m_WeaponUnarmedSet;
     std::set<std::uint32_t>  m_MonkWeaponSet;
 
+    // Everything the hooks look up for a base item, -1 where no feat is set.
+    struct WeaponFeats
+    {
+        int32_t nWeaponFocus                   = -1;
+        int32_t nEpicWeaponFocus               = -1;
+        int32_t nWeaponImprovedCritical        = -1;
+        int32_t nWeaponSpecialization          = -1;
+        int32_t nEpicWeaponSpecialization      = -1;
+        int32_t nEpicWeaponOverwhelmingCritical = -1;
+        int32_t nEpicWeaponDevastatingCritical = -1;
+        int32_t nWeaponOfChoice                = -1;
+        int32_t nGreaterWeaponSpecialization   = -1;
+        int32_t nGreaterWeaponFocus            = -1;
+        int32_t nFinesseSize                   = NWNXLib::API::Constants::CreatureSize::Huge + 1;
+        bool    bUnarmed                       = false;
+        bool    bMonkWeapon                    = false;
+    };
+
+    // The maps and sets above by base item, compiled the first time a hook needs them after a change.
+    std::vector<WeaponFeats> m_WeaponFeats;
+    WeaponFeats              m_DefaultWeaponFeats;
+    bool                     m_WeaponFeatsDirty = true;
+
+    const WeaponFeats& GetWeaponFeats(uint32_t nBaseItem);
+    const WeaponFeats& GetWeaponFeats(CNWSItem* pWeapon);
+    void CompileWeaponFeats();
+
     bool GetIsWeaponLight  (CNWSCreatureStats* pInfo, CNWSItem* pWeapon, bool bFinesse);
     bool GetIsUnarmedWeapon(CNWSItem* pWeapon);
     int  GetLevelByClass   (CNWSCreatureStats* pStats, uint32_t nClassType);
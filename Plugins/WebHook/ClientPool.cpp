@@ -0,0 +1,329 @@
+#include "ClientPool.hpp"
+#include "Log.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace WebHook {
+
+using namespace NWNXLib;
+using namespace std::chrono;
+
+// Rate limits asking to wait longer than this are assumed to be bogus.
+static constexpr double MAX_RATE_LIMIT_WAIT = 3600.0;
+
+// Messages rate limited more often than this are given up on.
+static constexpr uint32_t MAX_RATE_LIMITED = 5;
+
+static std::string BuildBody(const std::vector<ClientPool::Message>& messages)
+{
+    const auto& first = messages.front();
+    if (!first.m_isText)
+        return first.m_message;
+
+    // If it's just a simple text string, construct the JSON
+    std::string body = R"({"text": ")" + first.m_message;
+    for (size_t i = 1; i < messages.size(); i++)
+    {
+        body += "\\n";
+        body += messages[i].m_message;
+    }
+    body += "\"";
+
+    if (!first.m_username.empty())
+        body += R"(, "username": ")" + first.m_username + "\"";
+    if (!first.m_mrkdwn)
+        body += R"(, "mrkdwn": false)";
+    body += "}";
+
+    return body;
+}
+
+static double ParseSeconds(const std::string& value)
+{
+    return std::strtod(value.c_str(), nullptr);
+}
+
+ClientPool::ClientPool(const Settings& settings, ResultCallback callback)
+    : m_settings(settings), m_callback(std::move(callback)), m_stop(false)
+{
+    for (uint32_t i = 0; i < std::max(m_settings.m_workerThreads, 1u); i++)
+    {
+        m_workers.emplace_back(&ClientPool::Worker, this);
+    }
+}
+
+ClientPool::~ClientPool()
+{
+    size_t unsent = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+
+        for (auto& route : m_routes)
+            unsent += route.second.m_queue.size();
+    }
+
+    m_signal.notify_all();
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+
+    if (unsent)
+    {
+        LOG_WARNING("%u queued webhooks were not sent.", unsent);
+    }
+}
+
+void ClientPool::Queue(Message&& message)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_routes[{message.m_host, message.m_path}].m_queue.push_back(std::move(message));
+    }
+
+    m_signal.notify_one();
+}
+
+ClientPool::Result ClientPool::Send(Message&& message)
+{
+    std::vector<Message> messages;
+    messages.push_back(std::move(message));
+    const auto hostName = messages.front().m_host;
+
+    std::unique_ptr<Connection> connection;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        connection = TakeConnection(m_hosts[hostName], hostName);
+    }
+
+    auto result = Post(*connection, messages);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ReturnConnection(m_hosts[hostName], std::move(connection));
+    }
+
+    return result;
+}
+
+void ClientPool::Worker()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (!m_stop)
+    {
+        auto wakeAt = steady_clock::time_point::max();
+        auto* route = FindReadyRoute(steady_clock::now(), wakeAt);
+
+        if (!route)
+        {
+            if (wakeAt == steady_clock::time_point::max())
+                m_signal.wait(lock);
+            else
+                m_signal.wait_until(lock, wakeAt);
+            continue;
+        }
+
+        auto messages = TakeMessages(*route);
+        const auto hostName = messages.front().m_host;
+        auto& host = m_hosts[hostName];
+
+        route->m_inFlight = true;
+        host.m_active++;
+        auto connection = TakeConnection(host, hostName);
+
+        lock.unlock();
+        auto result = Post(*connection, messages);
+        lock.lock();
+
+        if (result.m_response)
+        {
+            UpdateRateLimit(*route, host, *result.m_response);
+
+            if (result.m_response->status == 429)
+                result.m_requeued = Requeue(*route, messages);
+        }
+
+        route->m_inFlight = false;
+        host.m_active--;
+        ReturnConnection(host, std::move(connection));
+        result.m_queueDepth = route->m_queue.size();
+
+        // The route, and a connection to its host, are free for the next message.
+        m_signal.notify_all();
+
+        lock.unlock();
+        m_callback(std::move(result));
+        lock.lock();
+    }
+}
+
+ClientPool::Route* ClientPool::FindReadyRoute(steady_clock::time_point now, steady_clock::time_point& wakeAt)
+{
+    for (auto& [key, route] : m_routes)
+    {
+        if (route.m_inFlight || route.m_queue.empty())
+            continue;
+
+        // Waits for a request to this host to finish, which signals.
+        const auto& host = m_hosts[key.first];
+        if (host.m_active >= m_settings.m_connectionsPerHost)
+            continue;
+
+        const auto blockedUntil = std::max(route.m_blockedUntil, host.m_blockedUntil);
+        if (blockedUntil > now)
+        {
+            wakeAt = std::min(wakeAt, blockedUntil);
+            continue;
+        }
+
+        return &route;
+    }
+
+    return nullptr;
+}
+
+std::vector<ClientPool::Message> ClientPool::TakeMessages(Route& route)
+{
+    std::vector<Message> messages;
+    messages.push_back(std::move(route.m_queue.front()));
+    route.m_queue.pop_front();
+
+    const auto& first = messages.front();
+    if (!m_settings.m_coalesce || !first.m_isText)
+        return messages;
+
+    // Plain text messages posted the same way are joined line by line into one post.
+    size_t length = first.m_message.size();
+    while (!route.m_queue.empty())
+    {
+        auto& next = route.m_queue.front();
+        if (!next.m_isText ||
+            next.m_username != first.m_username ||
+            next.m_mrkdwn != first.m_mrkdwn ||
+            length + 1 + next.m_message.size() > m_settings.m_coalesceMaxLength)
+        {
+            break;
+        }
+
+        length += 1 + next.m_message.size();
+        messages.push_back(std::move(next));
+        route.m_queue.pop_front();
+    }
+
+    return messages;
+}
+
+std::unique_ptr<Connection> ClientPool::TakeConnection(Host& host, const std::string& hostName)
+{
+    const auto now = steady_clock::now();
+    const auto idleTimeout = seconds(m_settings.m_idleTimeout);
+
+    host.m_idle.erase(std::remove_if(host.m_idle.begin(), host.m_idle.end(),
+        [&](const auto& connection) { return now - connection->GetLastUsed() > idleTimeout; }),
+        host.m_idle.end());
+
+    // The most recently used connection is the least likely to have been closed by the server.
+    if (!host.m_idle.empty())
+    {
+        auto connection = std::move(host.m_idle.back());
+        host.m_idle.pop_back();
+        return connection;
+    }
+
+    LOG_DEBUG("Creating new SSL client for host %s.", hostName);
+    return std::make_unique<Connection>(hostName, 443, m_settings.m_timeout);
+}
+
+void ClientPool::ReturnConnection(Host& host, std::unique_ptr<Connection>&& connection)
+{
+    if (connection->IsOpen())
+    {
+        host.m_idle.push_back(std::move(connection));
+    }
+}
+
+ClientPool::Result ClientPool::Post(Connection& connection, std::vector<Message>& messages)
+{
+    Result result;
+    result.m_host = messages.front().m_host;
+    result.m_path = messages.front().m_path;
+    result.m_body = BuildBody(messages);
+    result.m_messageCount = static_cast<uint32_t>(messages.size());
+    result.m_queueDepth = 0;
+    result.m_requeued = false;
+
+    const auto start = steady_clock::now();
+    result.m_queueTime = start - messages.front().m_queued;
+
+    // For Discord, will wait for a response
+    auto res = std::make_shared<httplib::Response>();
+    if (connection.Post(result.m_path + "?wait=true", result.m_body, "application/json", *res))
+    {
+        result.m_response = std::move(res);
+    }
+
+    result.m_requestTime = steady_clock::now() - start;
+    return result;
+}
+
+void ClientPool::UpdateRateLimit(Route& route, Host& host, const httplib::Response& res)
+{
+    const auto remaining = res.get_header_value("X-RateLimit-Remaining");
+    const bool exhausted = !remaining.empty() && std::strtol(remaining.c_str(), nullptr, 10) <= 0;
+
+    if (res.status != 429 && !exhausted)
+        return;
+
+    // Discord tells when the limit resets, Slack only how long to wait after being limited.
+    double wait = 1.0;
+    if (res.has_header("X-RateLimit-Reset-After"))
+    {
+        wait = ParseSeconds(res.get_header_value("X-RateLimit-Reset-After"));
+    }
+    else if (res.has_header("X-RateLimit-Reset"))
+    {
+        const auto epoch = duration_cast<duration<double>>(system_clock::now().time_since_epoch()).count();
+        wait = ParseSeconds(res.get_header_value("X-RateLimit-Reset")) - epoch;
+    }
+    else if (res.has_header("Retry-After"))
+    {
+        wait = ParseSeconds(res.get_header_value("Retry-After"));
+    }
+    wait = std::clamp(wait, 0.0, MAX_RATE_LIMIT_WAIT);
+
+    const auto until = steady_clock::now() + duration_cast<steady_clock::duration>(duration<double>(wait));
+
+    if (res.status == 429 && res.has_header("X-RateLimit-Global"))
+    {
+        LOG_DEBUG("Global rate limit reached, holding back all webhooks to this host for %f seconds.", wait);
+        host.m_blockedUntil = until;
+    }
+    else
+    {
+        LOG_DEBUG("Rate limit reached, holding back webhooks to this path for %f seconds.", wait);
+        route.m_blockedUntil = until;
+    }
+}
+
+bool ClientPool::Requeue(Route& route, std::vector<Message>& messages)
+{
+    for (auto& message : messages)
+    {
+        if (message.m_rateLimited >= MAX_RATE_LIMITED)
+            return false;
+    }
+
+    // In front of the queue, so they still go out before anything queued after them.
+    for (auto message = messages.rbegin(); message != messages.rend(); ++message)
+    {
+        message->m_rateLimited++;
+        route.m_queue.push_front(std::move(*message));
+    }
+
+    return true;
+}
+
+}
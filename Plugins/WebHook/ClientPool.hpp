@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Connection.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace WebHook {
+
+// Posts webhooks from its own worker threads over kept alive connections.
+// Messages to the same path are posted one at a time in the order they were queued,
+// and held back while the rate limit the server reported for it is used up. Messages
+// of a rate limited post are queued again in front of the others.
+class ClientPool
+{
+public:
+    struct Settings
+    {
+        uint32_t m_workerThreads;
+        uint32_t m_connectionsPerHost;
+        uint32_t m_timeout;
+        uint32_t m_idleTimeout;
+        bool m_coalesce;
+        uint32_t m_coalesceMaxLength;
+    };
+
+    struct Message
+    {
+        std::string m_host;
+        std::string m_path;
+        // Either plain text, or the complete JSON body if m_isText is false.
+        std::string m_message;
+        std::string m_username;
+        bool m_mrkdwn;
+        bool m_isText;
+        std::chrono::steady_clock::time_point m_queued;
+        // How often the message was rate limited and queued again.
+        uint32_t m_rateLimited = 0;
+    };
+
+    struct Result
+    {
+        std::string m_host;
+        std::string m_path;
+        std::string m_body;
+        // Null if no response was received.
+        std::shared_ptr<httplib::Response> m_response;
+        uint32_t m_messageCount;
+        std::chrono::nanoseconds m_queueTime;
+        std::chrono::nanoseconds m_requestTime;
+        // Messages still waiting for the same path.
+        size_t m_queueDepth;
+        // The post was rate limited and its messages are sent again once the limit resets.
+        bool m_requeued;
+    };
+
+    // Called from the worker threads.
+    using ResultCallback = std::function<void(Result&&)>;
+
+    ClientPool(const Settings& settings, ResultCallback callback);
+    ~ClientPool();
+
+    void Queue(Message&& message);
+
+    // Posts the message from the calling thread right away.
+    Result Send(Message&& message);
+
+private:
+    struct Route
+    {
+        std::deque<Message> m_queue;
+        bool m_inFlight = false;
+        std::chrono::steady_clock::time_point m_blockedUntil;
+    };
+
+    struct Host
+    {
+        std::vector<std::unique_ptr<Connection>> m_idle;
+        uint32_t m_active = 0;
+        std::chrono::steady_clock::time_point m_blockedUntil;
+    };
+
+    void Worker();
+    Route* FindReadyRoute(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point& wakeAt);
+    std::vector<Message> TakeMessages(Route& route);
+    std::unique_ptr<Connection> TakeConnection(Host& host, const std::string& hostName);
+    void ReturnConnection(Host& host, std::unique_ptr<Connection>&& connection);
+    Result Post(Connection& connection, std::vector<Message>& messages);
+    void UpdateRateLimit(Route& route, Host& host, const httplib::Response& res);
+    bool Requeue(Route& route, std::vector<Message>& messages);
+
+    Settings m_settings;
+    ResultCallback m_callback;
+
+    std::mutex m_mutex;
+    std::condition_variable m_signal;
+    bool m_stop;
+    std::map<std::pair<std::string, std::string>, Route> m_routes;
+    std::unordered_map<std::string, Host> m_hosts;
+    std::vector<std::thread> m_workers;
+};
+
+}
@@ -0,0 +1,260 @@
+#include "Connection.hpp"
+#include "Log.hpp"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+namespace WebHook {
+
+using namespace NWNXLib;
+using namespace std::chrono;
+
+Connection::Connection(const std::string& host, int port, uint32_t timeoutSeconds)
+    : m_host(host), m_port(port), m_timeout(timeoutSeconds), m_ssl(nullptr), m_sock(-1)
+{
+    m_ctx = SSL_CTX_new(SSLv23_client_method());
+}
+
+Connection::~Connection()
+{
+    Close();
+
+    if (m_ctx)
+        SSL_CTX_free(m_ctx);
+}
+
+bool Connection::Post(const std::string& path, const std::string& body, const char* contentType, httplib::Response& res)
+{
+    // Servers close connections that idle for too long. Reopen those instead of
+    // finding out by a failing request.
+    if (IsOpen() && IsClosedByServer())
+    {
+        LOG_DEBUG("Connection to %s was closed by the server, reconnecting.", m_host);
+        Close();
+    }
+
+    const bool reused = IsOpen();
+    if (!reused && !Open())
+        return false;
+
+    bool answered = false;
+    if (Request(path, body, contentType, res, answered))
+        return true;
+
+    // The server may close the connection just as it is reused, before the check above
+    // sees it. Nothing was answered, so the post is safe to send again.
+    if (!reused || answered || !Open())
+        return false;
+
+    LOG_DEBUG("Post to %s failed on a reused connection, retrying on a new one.", m_host);
+    return Request(path, body, contentType, res, answered);
+}
+
+bool Connection::Request(const std::string& path, const std::string& body, const char* contentType, httplib::Response& res, bool& answered)
+{
+    httplib::SSLSocketStream strm(m_sock, m_ssl);
+
+    strm.write_format("POST %s HTTP/1.1\r\n", httplib::detail::encode_url(path).c_str());
+    strm.write_format("Host: %s\r\n", m_host.c_str());
+    strm.write("Accept: */*\r\n");
+    strm.write("User-Agent: cpp-httplib/0.2\r\n");
+    strm.write("Connection: keep-alive\r\n");
+    strm.write_format("Content-Type: %s\r\n", contentType);
+    strm.write_format("Content-Length: %zu\r\n\r\n", body.size());
+
+    if (strm.write(body.c_str(), body.size()) != static_cast<int>(body.size()))
+    {
+        Close();
+        return false;
+    }
+
+    bool keepAlive = true;
+    if (!ReadResponse(strm, res, keepAlive, answered))
+    {
+        Close();
+        return false;
+    }
+
+    m_lastUsed = steady_clock::now();
+
+    if (!keepAlive)
+        Close();
+
+    return true;
+}
+
+bool Connection::IsOpen() const
+{
+    return m_ssl != nullptr;
+}
+
+steady_clock::time_point Connection::GetLastUsed() const
+{
+    return m_lastUsed;
+}
+
+bool Connection::Open()
+{
+    if (!m_ctx)
+        return false;
+
+    const size_t timeout = m_timeout;
+    m_sock = httplib::detail::create_socket(m_host.c_str(), m_port,
+        [timeout](socket_t sock, struct addrinfo& ai) -> bool {
+            httplib::detail::set_nonblocking(sock, true);
+
+            auto ret = connect(sock, ai.ai_addr, ai.ai_addrlen);
+            if (ret < 0) {
+                if (httplib::detail::is_connection_error() ||
+                    !httplib::detail::wait_until_socket_is_ready(sock, timeout, 0)) {
+                    httplib::detail::close_socket(sock);
+                    return false;
+                }
+            }
+
+            httplib::detail::set_nonblocking(sock, false);
+            return true;
+        });
+
+    if (m_sock == -1)
+    {
+        LOG_WARNING("Failed to connect to %s:%d.", m_host, m_port);
+        return false;
+    }
+
+    // Keep a stalled server from blocking the thread forever.
+    timeval tv = { static_cast<time_t>(m_timeout), 0 };
+    setsockopt(m_sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(m_sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    m_ssl = SSL_new(m_ctx);
+    if (!m_ssl)
+    {
+        Close();
+        return false;
+    }
+
+    auto bio = BIO_new_socket(m_sock, BIO_NOCLOSE);
+    SSL_set_bio(m_ssl, bio, bio);
+    SSL_set_tlsext_host_name(m_ssl, m_host.c_str());
+
+    if (SSL_connect(m_ssl) != 1)
+    {
+        LOG_WARNING("TLS handshake with %s:%d failed.", m_host, m_port);
+        Close();
+        return false;
+    }
+
+    LOG_DEBUG("Opened connection to %s:%d.", m_host, m_port);
+    m_lastUsed = steady_clock::now();
+    return true;
+}
+
+void Connection::Close()
+{
+    if (m_ssl)
+    {
+        SSL_shutdown(m_ssl);
+        SSL_free(m_ssl);
+        m_ssl = nullptr;
+    }
+
+    if (m_sock != -1)
+    {
+        httplib::detail::close_socket(m_sock);
+        m_sock = -1;
+    }
+}
+
+bool Connection::IsClosedByServer()
+{
+    // Nothing is expected between responses, anything readable is the server closing the connection.
+    return SSL_pending(m_ssl) > 0 || httplib::detail::select_read(m_sock, 0, 0) != 0;
+}
+
+bool Connection::ReadResponse(httplib::Stream& strm, httplib::Response& res, bool& keepAlive, bool& answered)
+{
+    static const std::regex statusLine("HTTP/1\\.([01]) (\\d+)[^\r\n]*\r\n");
+
+    const auto bufsiz = 2048;
+    char buf[bufsiz];
+    httplib::detail::stream_line_reader reader(strm, buf, bufsiz);
+
+    if (!reader.getline())
+        return false;
+
+    answered = true;
+
+    std::cmatch m;
+    if (!std::regex_match(reader.ptr(), m, statusLine))
+        return false;
+
+    res.status = std::stoi(std::string(m[2]));
+    keepAlive = m[1] == "1";
+
+    if (!httplib::detail::read_headers(strm, res.headers))
+        return false;
+
+    if (res.get_header_value("Connection") == "close")
+        keepAlive = false;
+
+    // These never have a body, whatever their headers say.
+    if (res.status == 204 || res.status == 304 || res.status / 100 == 1)
+        return true;
+
+    if (res.has_header("Content-Length"))
+    {
+        const auto length = std::strtoul(res.get_header_value("Content-Length").c_str(), nullptr, 10);
+        return length == 0 || httplib::detail::read_content_with_length(strm, res, length, httplib::Progress());
+    }
+
+    if (res.get_header_value("Transfer-Encoding") == "chunked")
+        return ReadChunkedBody(strm, res);
+
+    // The body ends with the connection.
+    keepAlive = false;
+    return httplib::detail::read_content_without_length(strm, res);
+}
+
+bool Connection::ReadChunkedBody(httplib::Stream& strm, httplib::Response& res)
+{
+    const auto bufsiz = 64;
+    char buf[bufsiz];
+    httplib::detail::stream_line_reader reader(strm, buf, bufsiz);
+
+    for (;;)
+    {
+        if (!reader.getline())
+            return false;
+
+        const auto length = std::strtoul(reader.ptr(), nullptr, 16);
+        if (length == 0)
+            break;
+
+        const auto offset = res.body.size();
+        res.body.resize(offset + length);
+        for (size_t read = 0; read < length;)
+        {
+            const auto n = strm.read(&res.body[offset + read], length - read);
+            if (n <= 0)
+                return false;
+            read += n;
+        }
+
+        // The line break ending the chunk.
+        if (!reader.getline())
+            return false;
+    }
+
+    // Skip the trailers, up to the empty line ending the response.
+    do
+    {
+        if (!reader.getline())
+            return false;
+    }
+    while (std::strcmp(reader.ptr(), "\r\n") != 0);
+
+    return true;
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "External/httplib.h"
+
+#include <chrono>
+#include <string>
+
+namespace WebHook {
+
+// A HTTPS connection to one host that is kept open between requests.
+// Not threadsafe, a connection is only ever used by one thread at a time.
+class Connection
+{
+public:
+    Connection(const std::string& host, int port, uint32_t timeoutSeconds);
+    ~Connection();
+
+    // Posts the body and reads the response. Returns false if no response was read,
+    // the connection is closed then and reopened by the next post. A post that got no
+    // answer at all on a reused connection is sent once more on a new one.
+    bool Post(const std::string& path, const std::string& body, const char* contentType, httplib::Response& res);
+
+    bool IsOpen() const;
+    std::chrono::steady_clock::time_point GetLastUsed() const;
+
+private:
+    bool Open();
+    void Close();
+    bool IsClosedByServer();
+    bool Request(const std::string& path, const std::string& body, const char* contentType, httplib::Response& res, bool& answered);
+    bool ReadResponse(httplib::Stream& strm, httplib::Response& res, bool& keepAlive, bool& answered);
+    bool ReadChunkedBody(httplib::Stream& strm, httplib::Response& res);
+
+    std::string m_host;
+    int m_port;
+    uint32_t m_timeout;
+
+    SSL_CTX* m_ctx;
+    SSL* m_ssl;
+    socket_t m_sock;
+    std::chrono::steady_clock::time_point m_lastUsed;
+};
+
+}
@@ -1,6 +1,8 @@
 #include "WebHook.hpp"
 #include "API/CNWSModule.hpp"
 #include "External/httplib.h"
+#include "Services/Config/Config.hpp"
+#include "Services/Metrics/Metrics.hpp"
 #include "Services/Tasks/Tasks.hpp"
 #include "Services/Messaging/Messaging.hpp"
 #include "Encoding.hpp"
@@ -43,10 +45,29 @@ WebHook::WebHook(const Plugin::CreateParams& params)
     : Plugin(params)
 {
     GetServices()->m_events->RegisterEvent("SendWebHookHTTPS", &SendWebHookHTTPS);
+
+    ClientPool::Settings settings;
+    settings.m_workerThreads = GetServices()->m_config->Get<uint32_t>("WORKER_THREADS", 4);
+    settings.m_connectionsPerHost = std::max(GetServices()->m_config->Get<uint32_t>("CONNECTIONS_PER_HOST", 2), 1u);
+    settings.m_timeout = GetServices()->m_config->Get<uint32_t>("TIMEOUT", 30);
+    settings.m_idleTimeout = GetServices()->m_config->Get<uint32_t>("IDLE_TIMEOUT", 30);
+    settings.m_coalesce = GetServices()->m_config->Get<bool>("COALESCE", false);
+    settings.m_coalesceMaxLength = GetServices()->m_config->Get<uint32_t>("COALESCE_MAX_LENGTH", 2000);
+
+    m_pool = std::make_unique<ClientPool>(settings, [this](ClientPool::Result&& result)
+    {
+        GetServices()->m_tasks->QueueOnMainThread([this, result = std::move(result)]()
+        {
+            OnResult(result);
+        });
+    });
 }
 
 WebHook::~WebHook()
-{ }
+{
+    // Joins the worker threads, which queue their results with the tasks service.
+    m_pool.reset();
+}
 
 std::string escape_json(const std::string &s) {
     std::ostringstream o;
@@ -69,109 +90,113 @@ ArgumentStack WebHook::SendWebHookHTTPS(ArgumentStack&& args)
     auto username = Services::Events::ExtractArgument<std::string>(args);
     auto mrkdwn = Services::Events::ExtractArgument<int32_t>(args);
 
-    // If it's just a simple text string, construct the JSON
-    if (message.find("\"text\":") == std::string::npos)
-    {
-        message = R"({"text": ")" + message + "\"";
-        if (!username.empty())
-            message = message + R"(, "username": ")" + username + "\"";
-        if (!mrkdwn)
-            message = message +  R"(, "mrkdwn": false)";
-        message = message + "}";
-    }
-
-    // For Discord, will wait for a response
-    auto path = origPath + "?wait=true";
-
-    message = Encoding::ToUTF8(message);
-    escape_json(message);
-
-    static std::unordered_map<std::string, std::unique_ptr<httplib::SSLClient>> s_ClientCache;
-    auto cli = s_ClientCache.find(host);
-
-    if (cli == std::end(s_ClientCache))
-    {
-        LOG_DEBUG("Creating new SSL client for host %s.", host);
-        cli = s_ClientCache.insert(std::make_pair(host, std::make_unique<httplib::SSLClient>(host.c_str(), 443))).first;
-    }
+    ClientPool::Message msg;
+    msg.m_host = host;
+    msg.m_path = origPath;
+    msg.m_message = Encoding::ToUTF8(message);
+    msg.m_username = Encoding::ToUTF8(username);
+    msg.m_mrkdwn = mrkdwn;
+    // If it's just a simple text string, the JSON is constructed when it's posted.
+    msg.m_isText = message.find("\"text\":") == std::string::npos;
+    msg.m_queued = std::chrono::steady_clock::now();
 
     if (Core::g_CoreShuttingDown)
     {
-        auto res = cli->second->post(path.c_str(), message, "application/json");
+        auto result = g_plugin->m_pool->Send(std::move(msg));
+        auto& res = result.m_response;
 
-        if (res->status == 200)
+        if (res && res->status == 200)
         {
-            LOG_INFO("Sent webhook '%s' to '%s%s'.", message, host, path);
+            LOG_INFO("Sent webhook '%s' to '%s%s'.", result.m_body, host, origPath);
         }
         else
         {
             LOG_WARNING("Failed to send WebHook (HTTPS) message '%s' to '%s%s', status code '%d'.",
-                        message.c_str(), host.c_str(), path.c_str(), res->status);
+                        result.m_body, host, origPath, res ? res->status : -1);
         }
     }
     else
     {
-        g_plugin->GetServices()->m_tasks->QueueOnAsyncThread([cli, message, host, path, origPath]()
+        g_plugin->m_pool->Queue(std::move(msg));
+    }
+    return Services::Events::Arguments();
+}
+
+void WebHook::OnResult(const ClientPool::Result& result)
+{
+    auto messaging = GetServices()->m_messaging.get();
+    auto moduleOid = NWNXLib::Utils::ObjectIDToString(Utils::GetModule()->m_idSelf);
+    const auto& res = result.m_response;
+    const auto& message = result.m_body;
+    const auto& host = result.m_host;
+    const auto& origPath = result.m_path;
+    const auto path = origPath + "?wait=true";
+
+    GetServices()->m_metrics->Push(
+        "WebHook",
+        {
+            { "messages", std::to_string(result.m_messageCount) },
+            { "queue_depth", std::to_string(result.m_queueDepth) },
+            { "queue_ns", std::to_string(result.m_queueTime.count()) },
+            { "request_ns", std::to_string(result.m_requestTime.count()) },
+        },
+        { { "host", host }, { "status", std::to_string(res ? res->status : -1) } });
+
+    if (result.m_requeued)
+    {
+        LOG_DEBUG("Webhook to '%s%s' was rate limited, sending it again once the limit resets.", host, path);
+        return;
+    }
+
+    if (res)
+    {
+        messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"STATUS", std::to_string(res->status)});
+        messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"MESSAGE", message});
+        messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"HOST", host});
+        messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"PATH", origPath});
+        if (res->status == 200 || res->status == 201 || res->status == 204 || res->status == 429)
         {
-            auto res = cli->second->post(path.c_str(), message, "application/json");
-            g_plugin->GetServices()->m_tasks->QueueOnMainThread([message, host, path, origPath, res]()
+            // Discord sends your rate limit information even on success so you can stagger calls if you want
+            // This header also lets us know it's Discord not Slack, important because Discord sends RETRY_AFTER
+            // in milliseconds and Slack sends it as seconds.
+            if (!res->get_header_value("X-RateLimit-Limit").empty())
             {
-                auto messaging = g_plugin->GetServices()->m_messaging.get();
-                auto moduleOid = NWNXLib::Utils::ObjectIDToString(Utils::GetModule()->m_idSelf);
-
-                if (res)
-                {
-                    messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"STATUS", std::to_string(res->status)});
-                    messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"MESSAGE", message});
-                    messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"HOST", host});
-                    messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"PATH", origPath});
-                    if (res->status == 200 || res->status == 201 || res->status == 204 || res->status == 429)
-                    {
-                        // Discord sends your rate limit information even on success so you can stagger calls if you want
-                        // This header also lets us know it's Discord not Slack, important because Discord sends RETRY_AFTER
-                        // in milliseconds and Slack sends it as seconds.
-                        if (!res->get_header_value("X-RateLimit-Limit").empty())
-                        {
-                            messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RATELIMIT_LIMIT", res->get_header_value("X-RateLimit-Limit")});
-                            messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RATELIMIT_REMAINING", res->get_header_value("X-RateLimit-Remaining")});
-                            messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RATELIMIT_RESET", res->get_header_value("X-RateLimit-Reset")});
-                            if (!res->get_header_value("Retry-After").empty())
-                                messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RETRY_AFTER", res->get_header_value("Retry-After")});
-                        }
-                            // Slack rate limited
-                        else if (!res->get_header_value("Retry-After").empty())
-                        {
-                            float fSlackRetry = stof(res->get_header_value("Retry-After")) * 1000.0f;
-                            messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RETRY_AFTER", std::to_string(fSlackRetry)});
-                        }
-                        if (res->status != 429)
-                        {
-                            messaging->BroadcastMessage("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_WEBHOOK_SUCCESS", moduleOid});
-                            LOG_INFO("Sent webhook '%s' to '%s%s'.", message, host, path);
-                        }
-                        else
-                        {
-                            messaging->BroadcastMessage("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_WEBHOOK_FAILED", moduleOid});
-                            LOG_WARNING("Failed to send WebHook (HTTPS) message '%s' to '%s%s'. Rate Limited.", message, host, path);
-                        }
-                    }
-                    else
-                    {
-                        messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"FAIL_INFO", res->body});
-                        messaging->BroadcastMessage("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_WEBHOOK_FAILED", moduleOid});
-                        LOG_WARNING("Failed to send WebHook (HTTPS) message '%s' to '%s%s', status code '%d'.", message, host, path, res->status);
-                    }
-                }
-                else
-                {
-                    messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"FAIL_INFO", "Failed to post to server. Is the url correct?"});
-                    messaging->BroadcastMessage("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_WEBHOOK_FAILED", moduleOid});
-                    LOG_WARNING("Failed to send WebHook (HTTPS) to '%s%s'.", host, path);
-                }
-            });
-        });
+                messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RATELIMIT_LIMIT", res->get_header_value("X-RateLimit-Limit")});
+                messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RATELIMIT_REMAINING", res->get_header_value("X-RateLimit-Remaining")});
+                messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RATELIMIT_RESET", res->get_header_value("X-RateLimit-Reset")});
+                if (!res->get_header_value("Retry-After").empty())
+                    messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RETRY_AFTER", res->get_header_value("Retry-After")});
+            }
+                // Slack rate limited
+            else if (!res->get_header_value("Retry-After").empty())
+            {
+                float fSlackRetry = stof(res->get_header_value("Retry-After")) * 1000.0f;
+                messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"RETRY_AFTER", std::to_string(fSlackRetry)});
+            }
+            if (res->status != 429)
+            {
+                messaging->BroadcastMessage("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_WEBHOOK_SUCCESS", moduleOid});
+                LOG_INFO("Sent webhook '%s' to '%s%s'.", message, host, path);
+            }
+            else
+            {
+                messaging->BroadcastMessage("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_WEBHOOK_FAILED", moduleOid});
+                LOG_WARNING("Failed to send WebHook (HTTPS) message '%s' to '%s%s'. Rate Limited.", message, host, path);
+            }
+        }
+        else
+        {
+            messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"FAIL_INFO", res->body});
+            messaging->BroadcastMessage("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_WEBHOOK_FAILED", moduleOid});
+            LOG_WARNING("Failed to send WebHook (HTTPS) message '%s' to '%s%s', status code '%d'.", message, host, path, res->status);
+        }
+    }
+    else
+    {
+        messaging->BroadcastMessage("NWNX_EVENT_PUSH_EVENT_DATA", {"FAIL_INFO", "Failed to post to server. Is the url correct?"});
+        messaging->BroadcastMessage("NWNX_EVENT_SIGNAL_EVENT", {"NWNX_ON_WEBHOOK_FAILED", moduleOid});
+        LOG_WARNING("Failed to send WebHook (HTTPS) to '%s%s'.", host, path);
     }
-    return Services::Events::Arguments();
 }
 
 }
@@ -3,6 +3,9 @@
 #include "Plugin.hpp"
 #include "Services/Events/Events.hpp"
 #include "API/Types.hpp"
+#include "ClientPool.hpp"
+
+#include <memory>
 
 using ArgumentStack = NWNXLib::Services::Events::ArgumentStack;
 
@@ -14,6 +17,11 @@ public:
     WebHook(const Plugin::CreateParams& params);
     virtual ~WebHook();
     static ArgumentStack SendWebHookHTTPS(NWNXLib::Services::Events::ArgumentStack&&);
+
+private:
+    void OnResult(const ClientPool::Result& result);
+
+    std::unique_ptr<ClientPool> m_pool;
 };
 
 }